@@ -10,7 +10,6 @@ char *cpu_copyright="vasm KutaragiV1 cpu backend 0.1 (c) 2020 Samy Meguenoun";
 char *cpuname="KutaragiV1";
 int bitsperbyte=8;
 int bytespertaddr=4;
-int k1ext = 0x0;
 
 
 mnemonic mnemonics[]={
@@ -259,388 +258,120 @@ int parse_operand(char *p,int len,operand *op,int requires)
 }
 
 
-/* Convert an instruction into a DATA atom including relocations,
-   if necessary. */
-dblock *eval_instruction(instruction *p,section *sec,taddr pc)
+/* place value in the bits of field */
+static unsigned int encode_field(const k1_field *field,int value)
 {
-    
-    dblock *db=new_dblock();
-
-
-    unsigned char *d;
-    int opcode = (mnemonics[p->code].ext.opcode);
-    int val,val2,ret,byte = 0,plus = 0,type;
-    operand operand1,operand2,operand3;
-
-    //printf("%d\n",pc);
+    if(field->bits == 0)
+        return 0;
 
+    return ((unsigned int)(value-field->bias) & ((1u<<field->bits)-1)) << field->shift;
+}
 
-    int k1ext = 0x02;
-    int inst = opcode&0x3;
+/* the value of the qualifier of an instruction, or its default */
+static int eval_qualifier(instruction *p,int kind)
+{
+    static const char *sizes[] = {"b","w","l","q"};
+    static const char *lanes[] = {"x","xy","xyz","xyzw"};
+    static const char *bytes[] = {"32","64"};
+    static const char *end[] = {"","e"};
 
+    const char **names = NULL;
+    int count = 0,value = 0,i;
 
-    if(p->qualifiers[0] != 0)
+    switch(kind)
     {
-        char *ext = p->qualifiers[0];
-        int i = 0,n;
-
-        while(p->qualifiers[0][i]) i++;
-        n = i;
-
-        if(ext[0] == 'a') k1ext = 0;
-        if(ext[0] == '1') k1ext = 1;
-        if(ext[0] == '2') k1ext = 2;
-        if(ext[0] == '3') k1ext = 3;
-
-        if(ext[0] == 'b') k1ext = 0;
-        if(ext[0] == 'w') k1ext = 1;
-        if(ext[0] == 'l') k1ext = 2;
-        if(ext[0] == 'q') k1ext = 3;
-        
-        if(ext[0] == 'x') k1ext = 0;
-        if( (n == 2) && (ext[1] == 'y') ) k1ext = 1;
-        if( (n == 3) && (ext[2] == 'z') ) k1ext = 2;
-        if( (n == 4) && (ext[3] == 'w') ) k1ext = 3;
-
+        case K1_QUALIFIER_SIZE:  names = sizes; count = 4; value = 2; break;
+        case K1_QUALIFIER_LANES: names = lanes; count = 4; value = 3; break;
+        case K1_QUALIFIER_BYTES: names = bytes; count = 2; value = 0; break;
+        case K1_QUALIFIER_END:   names = end;   count = 2; value = 0; break;
     }
-    
-    if(p->op[0] != NULL)
-        operand1 = *(p->op[0]);
-    else
-        operand1.type = OP_VOID;
 
-    if(p->op[1] != NULL)
-        operand2 = *(p->op[1]);
-    else
-        operand2.type = OP_VOID;
-        
-    if(p->op[2] != NULL)
-        operand3 = *(p->op[2]);
-    else
-        operand3.type = OP_VOID;
-
-    if(operand1.type&0x100) plus |= 1;
-    if(operand2.type&0x100) plus |= 1;
-
-    operand1.type &= 0xFF;
-    operand2.type &= 0xFF;
-
-
-    //IMR1,IMR2 AGU
-    if(operand1.type == OP_IMR && operand2.type == OP_IMR && operand3.type == OP_VOID)
-    {
-        eval_expr(operand1.value,&val,sec,pc);
-        operand1.val = val&0xFFF;
-
-        eval_expr(operand2.value,&val,sec,pc);
-        operand2.val = val&0xFFF;
+    if(p->qualifiers[0] == NULL)
+        return value;
 
-        if(inst == 0x00)
-        {
-            operand1.reg -= 58;
-            operand2.reg -= 60;
-            operand1.reg &= 1;
-            operand2.reg &= 3;
-        }
-
-        opcode |= (operand1.val<<20) + (operand2.val<<8) + (operand1.reg<<5) + (operand2.reg<<7) + ( (k1ext&1) << 4);
-    }
-
-    //REG,IMR (LSU)
-    if(operand1.type == OP_REG && operand2.type == OP_IMR && operand3.type == OP_VOID)
+    for(i = 0; i < count; i++)
     {
-        eval_expr(operand2.value,&val,sec,pc);
-        operand2.val = val&0xFFFF;
-
-        type = (opcode>>2)&0x3;
-
-        if(inst == 1) //LSU
-        {
-        	if(type == 0) //LDM/STM
-	        {
-	            operand2.val &= 0xFFF;
-	            opcode |= (plus<<4) + ( (k1ext&3)<<6);
-	            opcode |= (operand1.reg<<26) + (operand2.reg<<20) + (operand2.val<<8);
-	        }else
-	        {
-	            if(type == 1)
-	            {
-	                type = (opcode>>4)&0x3;
-
-	                if(type == 0) //LDMX/STMX
-	                {
-	                    operand2.val &= 0xFFFF;
-	                    operand2.reg -= 62;
-	                    operand2.reg &= 1;
-	                    opcode |= ( (k1ext&3)<<7);
-	                    opcode |= (operand1.reg<<26) + (operand2.val<<9);
-	                }
-
-	            }else
-	            {
-	                if(type == 2)//LDC/STC
-	                {
-	                    operand2.val &= 0xFFF;
-	                    opcode |= (plus<<4) + ( (k1ext&3)<<6);
-	                    opcode |= (operand1.reg<<26) + (operand2.reg<<20) + (operand2.val<<8);
-	                }else //LDMF/STMF ,LDCD/STCD
-	                {
-
-	                }
-	            }
-	        }
-
-        }
-
-
-        
+        if(!stricmp(p->qualifiers[0],names[i]))
+            return i;
     }
 
-    //VF,IMR
-    if(operand1.type == OP_VF && operand2.type == OP_IMR && operand3.type == OP_VOID)
-    {
-        eval_expr(operand2.value,&val,sec,pc);
-        operand2.val = val&0xFFFF;
-
-        type = (opcode>>2)&0xF;
-
-        if(type == 0)
-        {
-            //operand2.reg -= 58;
-            //operand2.reg &= 1;
+    cpu_error(1,p->qualifiers[0]);  /* illegal qualifier */
+    return value;
+}
 
-            opcode |= (operand1.val<<8) + (operand2.reg<<15) + (operand2.val<<16) + (k1ext&3);
-        }else
-        {
-            operand2.val = val&0x7FF;
-            opcode |= (operand1.val<<25) + (operand2.reg<<19) + (operand2.val<<8) + (k1ext&3) + (plus<<7);
-        }
-    }
+/* Convert an instruction into a DATA atom including relocations,
+   if necessary. */
+dblock *eval_instruction(instruction *p,section *sec,taddr pc)
+{
+    dblock *db=new_dblock();
+    const mnemonic_extension *ext = &mnemonics[p->code].ext;
+    unsigned char *d;
+    unsigned int opcode = ext->opcode;
+    int i,val;
 
-    //REG,REG (CMP)
-    if(operand1.type == OP_REG && operand2.type == OP_REG && operand3.type == OP_VOID)
-    {
-    	opcode |= (operand1.reg<<26) + (operand2.reg<<20) + ( (k1ext&3)<<8);
-    }
+    if(p->qualifiers[1] != NULL)
+        cpu_error(1,p->qualifiers[1]);  /* illegal qualifier */
 
-    //REG,REG,REG (ALU)
-    if(operand1.type == OP_REG && operand2.type == OP_REG && operand3.type == OP_REG)
-    {
-        opcode |= (operand1.reg<<26) + (operand2.reg<<20) + (operand3.reg<<14) + ( (k1ext&3)<<12);
-    }
+    opcode |= encode_field(&ext->qualifier_field,eval_qualifier(p,ext->qualifier));
 
-    //REG,REG,IMM (ALU)
-    if(operand1.type == OP_REG && operand2.type == OP_REG && operand3.type == OP_IMM)
+    for(i = 0; i < MAX_OPERANDS; i++)
     {
-    	eval_expr(operand3.value,&val,sec,pc);
-        operand3.val = val&0xFFFF;
+        operand *op = p->op[i];
 
-        if(inst == 2)
-        {
-        	type = (opcode>>2)&0xF;
-	        if(type > 9)
-	        	operand3.val = val&0x3F;
+        if(op == NULL)
+            continue;
 
-	        opcode |= (operand1.reg<<26) + (operand2.reg<<20) + (operand3.val<<10) + ( (k1ext&3)<<8);
-        }else
+        switch(op->type&0xFF)
         {
-        	if(inst == 0)
-        	{
-        		type = (opcode>>4)&0xF;
-
-        		 operand3.val = val&0xFFF;
-        	    opcode |= (operand1.reg<<26) + (operand2.reg<<20) + (operand3.val<<8);
-
-        	}
+            case OP_REG:
+                val = op->reg;
+                break;
+
+            case OP_VF:
+            case OP_VD:
+            case OP_VT:
+                val = op->val;
+                break;
+
+            default: /* OP_IMM, OP_IMR */
+                eval_expr(op->value,&val,sec,pc);
+
+                /* addresses are in bytes, targets in units of K1_TARGET_BYTES */
+                if(ext->target != K1_TARGET_NONE)
+                {
+                    if(ext->target == K1_TARGET_RELATIVE)
+                        val -= pc;
+
+                    if(val%K1_TARGET_BYTES)
+                        cpu_error(0);  /* illegal operand */
+
+                    val /= K1_TARGET_BYTES;
+                }
+                break;
         }
-        
-    }
 
-    //IMM,REG (IN/OUT)
-    if(operand1.type == OP_IMM && operand2.type == OP_REG && operand3.type == OP_VOID)
-    {
-        eval_expr(operand1.value,&val,sec,pc);
+        opcode |= encode_field(&ext->values[i],val);
 
-        type = (opcode>>2)&0xF;
-        if(type == 5)
+        if((op->type&0xFF) == OP_IMR)
         {
-            operand1.val = val&0xFF;
-            opcode |= ( (k1ext&3)<<7);
-            opcode |= (operand1.val<<16) + (operand2.reg<<26);
-        }
-
-    }
-
-    //IMM,IMM (INI/OUTI)
-    if(operand1.type == OP_IMM && operand2.type == OP_IMM && operand3.type == OP_VOID)
-    {
-        eval_expr(operand1.value,&val,sec,pc);
-        operand1.val = val&0xFFFF;
-
-        eval_expr(operand2.value,&val,sec,pc);
-        operand2.val = val&0xFF;
+            opcode |= encode_field(&ext->bases[i],op->reg);
 
-        type = (opcode>>2)&0xF;
-        if(type == 9)
-        {
-            opcode |= ( (k1ext&1)<<7);
-            opcode |= (operand1.val<<24) + (operand2.val<<8);
-        }
-
-    }
-
-    //REG,IMM
-    if(operand1.type == OP_REG && operand2.type == OP_IMM && operand3.type == OP_VOID)
-    {
-        eval_expr(operand2.value,&val,sec,pc);
-        if(inst == 2) //ALU
-        {
-            type = (opcode>>2)&0x3;
-            if(type == 2)
-            {
-                operand2.val = val&0xFFFF;
-                type = (opcode>>2)&0xF;
-                if(type > 9)
-        			operand2.val = val&0x3F;
-                
-        		opcode |= (operand1.reg<<26) + (operand2.val<<10) + ( (k1ext&3)<<8);
-            }else
+            if(op->type&0x100)
             {
-            	if(type == 3) //move
-            	{
-        			operand2.val = val&0x3FFFFF;
-                	opcode |= (operand1.reg<<26) + (operand2.val<<4);
-            	}
-                
-            } 
-        }
-
-        if(inst == 0) //BRU
-        {
-
-            operand2.val = val&0xFFFFF;
-            opcode |= (operand1.reg<<26) + (operand2.val<<6)+ ( (k1ext&3)<<4);
-
-        }
-    }
-
-    //VF,IMM
-    if(operand1.type == OP_VF && operand2.type == OP_IMM && operand3.type == OP_VOID)
-    {
-        float fval;
-        eval_expr(operand2.value,&val,sec,pc);
+                if(ext->increment.bits == 0)
+                    cpu_error(0);  /* illegal operand */
 
-        
-        printf("%f\n",operand2.fval);
-        if(inst == 0) //VF
-        {
-            
-        }
-
-        if(inst == 3) //BRU
-        {
-
-            operand2.val = val&0xFFFF;
-            opcode |= (operand1.val<<25) + (operand2.val<<9) + (k1ext&3);
-
-        }
-    }
-
-
-    //VT,VT,VT
-    if(operand1.type == OP_VT && operand2.type == OP_VT && operand3.type == OP_VT)
-    {
-        opcode |= (operand1.val<<25) + (operand2.val<<19) + (k1ext&3);
-    }
-
-    //VF,VF
-    if(operand1.type == OP_VF && operand2.type == OP_VF && operand3.type == OP_VOID)
-    {
-        opcode |= (operand1.val<<25) + (operand2.val<<19) + (k1ext&3);
-    }
-
-    //REG
-    if(operand1.type == OP_REG && operand2.type == OP_VOID && operand3.type == OP_VOID)
-    {
-        opcode |= (operand1.val<<26);
-    }
-    //IMM
-    if(operand1.type == OP_IMM && operand2.type == OP_VOID && operand3.type == OP_VOID)
-    {
-        eval_expr(operand1.value,&val,sec,pc);
-
-        type = opcode>>6;
-        if(type == 0) //Bcc
-        {
-        	val = (val-pc-4-1)>>3;
-	        operand1.val = val&0x3FFF;
-
-	        opcode |= (operand1.val<<12);
-        }else //jump/call
-        {
-	        operand1.val = val&0x3FFF;
-	        opcode |= (operand1.val<<12);
+                opcode |= encode_field(&ext->increment,1);
+            }
         }
-        
-    }
-/*
-    //REG,REG,IMM
-    if(operand1.type == OP_REG && operand2.type == OP_REG && operand3.type == OP_IMM)
-    {
-        eval_expr(operand3.value,&val,sec,pc);
-
-        type = (opcode>>4)&0x01;
-
-        operand3.val = val&0xFFFF;
-        opcode |= (operand1.val<<26) + (operand2.val<<5) + (k1ext&3);
-    }
-*/
-
-//printf("%d\n",k1ext&3);
-
-char *outbin(unsigned int n)
-{
-    static char buffer [1+sizeof (unsigned int)*8] = { 0 };
-    unsigned int bit = 0 ;
-    int i;
-    for (i = 0 ; i < sizeof (unsigned int)*8; i++)
-    {
-        bit = n&1;
-        buffer[i] = bit+'0';
-        n = n>>1;
     }
-    buffer[i] = '\0';
 
-    return buffer;
-}
-
-void printbin(unsigned int n)
-{
-    unsigned int bit = 0 ;
-    for (int i = 0 ; i < sizeof(unsigned int)*8 ; i++)
-    {
-        bit = n&1;
-        printf("%d", bit) ;
-        if(((i+1)&7) == 0) printf(" ") ;
-        n = n>>1;
-    }
-    printf("\n");
-}
-    printbin(opcode);
-
-    //printf("%s\n",outbin(opcode));
-    
-
-    val = opcode;
     db->size = 4;
-    
-
-	d = db->data = mymalloc(db->size);
-	*d++ = (val)&0xFF;
-	*d++ = (val>>8)&0xFF;
-	*d++ = (val>>16)&0xFF;
-    *d++ = (val>>24)&0xFF;
-
+    d = db->data = mymalloc(db->size);
+    *d++ = (opcode)&0xFF;
+    *d++ = (opcode>>8)&0xFF;
+    *d++ = (opcode>>16)&0xFF;
+    *d++ = (opcode>>24)&0xFF;
 
     return db;
 }
@@ -675,8 +406,7 @@ dblock *eval_data(operand *op,taddr bitsize,section *sec,taddr pc)
    to the data created by eval_instruction. */
 taddr instruction_size(instruction *p,section *sec,taddr pc)
 {
-    //printf("ok\n",len);
-    return 1;
+    return 4;
 }
 
 operand *new_operand()
@@ -63,8 +63,32 @@ typedef struct {
 
 
 
+/* where a value goes in the op-code: (value-bias) on bits bits from shift, none when bits is 0 */
+typedef struct {
+  unsigned char shift,bits,bias;
+} k1_field;
+
+/* the qualifier of a mnemonic, written in its qualifier field */
+#define K1_QUALIFIER_NONE  0
+#define K1_QUALIFIER_SIZE  1 /* b,w,l,q */
+#define K1_QUALIFIER_LANES 2 /* x,xy,xyz,xyzw */
+#define K1_QUALIFIER_BYTES 3 /* 32,64 */
+#define K1_QUALIFIER_END   4 /* e */
+
+/* immediates which are branch targets, byte addresses encoded in units of K1_TARGET_BYTES (opcodes.h) */
+#define K1_TARGET_NONE     0
+#define K1_TARGET_RELATIVE 1
+#define K1_TARGET_ABSOLUTE 2
+
+/* generated with opcodes.h from ISA/K1.isa */
 typedef struct {
   unsigned int cpu;
   unsigned int opcode;
+  unsigned char qualifier;
+  k1_field qualifier_field;
+  k1_field values[MAX_OPERANDS]; /* register or immediate of each operand */
+  k1_field bases[MAX_OPERANDS];  /* base register of OP_IMR operands */
+  k1_field increment;            /* the + of OP_IMR operands */
+  unsigned char target;
 } mnemonic_extension;
 
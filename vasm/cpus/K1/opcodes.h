@@ -1,200 +1,144 @@
+  /* generated by altair_isa_generator from K1.isa, do not edit */
 
-  //AGU
-  "lddma",   {OP_IMR,OP_IMR,      },{K1,(0x0)+(0x00<<2)},
-  "stdma",   {OP_IMR,OP_IMR,      },{K1,(0x0)+(0x02<<2)},
-
-
-  "lddmar",  {OP_REG,OP_REG,OP_IMM},{K1,(0x0)+(0x01<<2)},
-  "stdmar",  {OP_REG,OP_REG,OP_IMM},{K1,(0x0)+(0x03<<2)},
-
-  "dmair",   {OP_REG,OP_REG,OP_IMM},{K1,(0x4)+(0x01<<4)},
-
-  "lddmal",  {OP_REG,OP_IMM,      },{K1,(0x4)+(0x02<<4)},
-  "stdmal",  {OP_REG,OP_IMM,      },{K1,(0x4)+(0x03<<4)},
-
-  "prefetch",{OP_IMR,             },{K1,(0x4)+(0x04<<4)},
-  "clearc",  {                    },{K1,(0x4)+(0x05<<4)},
-
-  "wait",    {                    },{K1,(0x4)+(0x0F<<4)},
+#define K1_TARGET_BYTES 8 /* the unit of the branch target fields */
 
+  //AGU
+  "lddma",     {OP_IMR,OP_IMR,      },{K1,0x0000,K1_QUALIFIER_BYTES,{4,1,0},{{20,12,0},{8,12,0},{0,0,0}},{{7,1,58},{5,2,60},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "stdma",     {OP_IMR,OP_IMR,      },{K1,0x0008,K1_QUALIFIER_BYTES,{4,1,0},{{20,12,0},{8,12,0},{0,0,0}},{{7,1,58},{5,2,60},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "lddmar",    {OP_REG,OP_REG,OP_IMM},{K1,0x0004,K1_QUALIFIER_NONE ,{0,0,0},{{8,6,0},{20,6,0},{8,12,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "stdmar",    {OP_REG,OP_REG,OP_IMM},{K1,0x000C,K1_QUALIFIER_NONE ,{0,0,0},{{8,6,0},{20,6,0},{8,12,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "dmair",     {OP_REG,OP_REG,OP_IMM},{K1,0x0014,K1_QUALIFIER_NONE ,{0,0,0},{{8,6,0},{20,6,0},{8,12,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "wait",      {                    },{K1,0x00F4,K1_QUALIFIER_NONE ,{0,0,0},{{0,0,0},{0,0,0},{0,0,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
 
   //LSU
-  "ldm",    {OP_REG,OP_IMR,      },{K1,(0x1)+(0x00<<2)},
-  "stm",    {OP_REG,OP_IMR,      },{K1,(0x1)+(0x08<<2)},
-
-  "ldc",    {OP_REG,OP_IMR,      },{K1,(0x1)+((0x02)<<2)},
-  "stc",    {OP_REG,OP_IMR,      },{K1,(0x1)+((0x0A)<<2)},
-
-  "ldmx",   {OP_REG,OP_IMR,      },{K1,(0x1)+(0x001<<2)},
-  "stmx",   {OP_REG,OP_IMR,      },{K1,(0x1)+(0x011<<2)},
-
-  "in",     {OP_IMM,OP_REG,      },{K1,(0x1)+(0x005<<2)},
-  "out",    {OP_IMM,OP_REG,      },{K1,(0x1)+(0x015<<2)},
-
-  "outi",   {OP_IMM,OP_IMM,      },{K1,(0x1)+(0x009<<2)},
-
-
-  "ldmv",   {OP_REG,OP_IMR,      },{K1,(0x1)+(0x0D<<2)},
-  "stmv",   {OP_REG,OP_IMR,      },{K1,(0x1)+(0x1D<<2)},
-
-  "ldcv",   {OP_REG,OP_IMR,      },{K1,(0x1)+(0x2D<<2)},
-  "stcv",   {OP_REG,OP_IMR,      },{K1,(0x1)+(0x3D<<2)},
-
-  "ldmf",   {OP_REG,OP_IMR,      },{K1,(0x1)+(0x03<<2)},
-  "stmf",   {OP_REG,OP_IMR,      },{K1,(0x1)+(0x13<<2)},
-
-  "ldcf",   {OP_REG,OP_IMR,      },{K1,(0x1)+(0x0B<<2)},
-  "stcf",   {OP_REG,OP_IMR,      },{K1,(0x1)+(0x1B<<2)},
-
-
-  "ldmd",   {OP_REG,OP_IMR,      },{K1,(0x1)+(0x07<<2)},
-  "stmd",   {OP_REG,OP_IMR,      },{K1,(0x1)+(0x17<<2)},
-
-  "ldcd",   {OP_REG,OP_IMR,      },{K1,(0x1)+(0x0F<<2)},
-  "stcd",   {OP_REG,OP_IMR,      },{K1,(0x1)+(0x1F<<2)},
+  "ldm",       {OP_REG,OP_IMR,      },{K1,0x0001,K1_QUALIFIER_SIZE ,{6,2,0},{{26,6,0},{8,12,0},{0,0,0}},{{0,0,0},{20,6,0},{0,0,0}},{4,1,0},K1_TARGET_NONE},
+  "stm",       {OP_REG,OP_IMR,      },{K1,0x0021,K1_QUALIFIER_SIZE ,{6,2,0},{{26,6,0},{8,12,0},{0,0,0}},{{0,0,0},{20,6,0},{0,0,0}},{4,1,0},K1_TARGET_NONE},
+  "ldc",       {OP_REG,OP_IMR,      },{K1,0x0009,K1_QUALIFIER_SIZE ,{6,2,0},{{26,6,0},{8,12,0},{0,0,0}},{{0,0,0},{20,6,0},{0,0,0}},{4,1,0},K1_TARGET_NONE},
+  "stc",       {OP_REG,OP_IMR,      },{K1,0x0029,K1_QUALIFIER_SIZE ,{6,2,0},{{26,6,0},{8,12,0},{0,0,0}},{{0,0,0},{20,6,0},{0,0,0}},{4,1,0},K1_TARGET_NONE},
+  "ldmx",      {OP_REG,OP_IMR,      },{K1,0x0005,K1_QUALIFIER_SIZE ,{7,2,0},{{26,6,0},{9,16,0},{0,0,0}},{{0,0,0},{25,1,62},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "stmx",      {OP_REG,OP_IMR,      },{K1,0x0045,K1_QUALIFIER_SIZE ,{7,2,0},{{26,6,0},{9,16,0},{0,0,0}},{{0,0,0},{25,1,62},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "in",        {OP_IMM,OP_REG,      },{K1,0x0015,K1_QUALIFIER_SIZE ,{7,2,0},{{16,8,0},{26,6,0},{0,0,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "out",       {OP_IMM,OP_REG,      },{K1,0x0055,K1_QUALIFIER_SIZE ,{7,2,0},{{16,8,0},{26,6,0},{0,0,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "outi",      {OP_IMM,OP_IMM,      },{K1,0x0025,K1_QUALIFIER_SIZE ,{7,1,0},{{26,6,0},{16,16,0},{0,0,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "ldmv",      {OP_VT ,OP_IMR,      },{K1,0x0035,K1_QUALIFIER_NONE ,{0,0,0},{{26,6,0},{9,15,0},{0,0,0}},{{0,0,0},{25,3,56},{0,0,0}},{8,1,0},K1_TARGET_NONE},
+  "stmv",      {OP_VT ,OP_IMR,      },{K1,0x0075,K1_QUALIFIER_NONE ,{0,0,0},{{26,6,0},{9,15,0},{0,0,0}},{{0,0,0},{25,3,56},{0,0,0}},{8,1,0},K1_TARGET_NONE},
+  "ldcv",      {OP_VT ,OP_IMR,      },{K1,0x00B5,K1_QUALIFIER_NONE ,{0,0,0},{{26,6,0},{9,15,0},{0,0,0}},{{0,0,0},{25,3,56},{0,0,0}},{8,1,0},K1_TARGET_NONE},
+  "stcv",      {OP_VT ,OP_IMR,      },{K1,0x00F5,K1_QUALIFIER_NONE ,{0,0,0},{{26,6,0},{9,15,0},{0,0,0}},{{0,0,0},{25,3,56},{0,0,0}},{8,1,0},K1_TARGET_NONE},
+  "ldmf",      {OP_VF ,OP_IMR,      },{K1,0x000D,K1_QUALIFIER_NONE ,{0,0,0},{{25,7,0},{8,15,0},{0,0,0}},{{0,0,0},{23,2,60},{0,0,0}},{7,1,0},K1_TARGET_NONE},
+  "stmf",      {OP_VF ,OP_IMR,      },{K1,0x004D,K1_QUALIFIER_NONE ,{0,0,0},{{25,7,0},{8,15,0},{0,0,0}},{{0,0,0},{23,2,60},{0,0,0}},{7,1,0},K1_TARGET_NONE},
+  "ldcf",      {OP_VF ,OP_IMR,      },{K1,0x002D,K1_QUALIFIER_NONE ,{0,0,0},{{25,7,0},{8,15,0},{0,0,0}},{{0,0,0},{23,2,60},{0,0,0}},{7,1,0},K1_TARGET_NONE},
+  "stcf",      {OP_VF ,OP_IMR,      },{K1,0x006D,K1_QUALIFIER_NONE ,{0,0,0},{{25,7,0},{8,15,0},{0,0,0}},{{0,0,0},{23,2,60},{0,0,0}},{7,1,0},K1_TARGET_NONE},
+  "ldmd",      {OP_VD ,OP_IMR,      },{K1,0x001D,K1_QUALIFIER_NONE ,{0,0,0},{{26,6,0},{8,16,0},{0,0,0}},{{0,0,0},{24,2,60},{0,0,0}},{7,1,0},K1_TARGET_NONE},
+  "stmd",      {OP_VD ,OP_IMR,      },{K1,0x005D,K1_QUALIFIER_NONE ,{0,0,0},{{26,6,0},{8,16,0},{0,0,0}},{{0,0,0},{24,2,60},{0,0,0}},{7,1,0},K1_TARGET_NONE},
+  "ldcd",      {OP_VD ,OP_IMR,      },{K1,0x003D,K1_QUALIFIER_NONE ,{0,0,0},{{26,6,0},{8,16,0},{0,0,0}},{{0,0,0},{24,2,60},{0,0,0}},{7,1,0},K1_TARGET_NONE},
+  "stcd",      {OP_VD ,OP_IMR,      },{K1,0x007D,K1_QUALIFIER_NONE ,{0,0,0},{{26,6,0},{8,16,0},{0,0,0}},{{0,0,0},{24,2,60},{0,0,0}},{7,1,0},K1_TARGET_NONE},
 
   //ALU
-  "nop",    {                    },{K1,(0x62)},
-  "xchg",   {                    },{K1,(0x22)},
-
-  "move",   {OP_REG,OP_REG,      },{K1,(0x2)+((0x01)<<2)},
-  "movei",  {OP_REG,OP_IMM,      },{K1,(0x2)+((0x03)<<2)},
-
-  "add",    {OP_REG,OP_REG,OP_REG},{K1,(0x2)+((0x00)<<2)},
-  "addi",   {OP_REG,OP_REG,OP_IMM},{K1,(0x2)+((0x01)<<2)},
-  "addq",   {OP_REG,OP_IMM,      },{K1,(0x2)+((0x02)<<2)},
-
-  "sub",    {OP_REG,OP_REG,OP_REG},{K1,(0x2)+((0x00)<<2)+((0x01)<<8)},
-  "subi",   {OP_REG,OP_REG,OP_IMM},{K1,(0x2)+((0x01)<<2)+((0x01)<<4)},
-  "subq",   {OP_REG,OP_IMM,      },{K1,(0x2)+((0x02)<<2)+((0x01)<<4)},
-
-  "muls",   {OP_REG,OP_REG,OP_REG},{K1,(0x2)+((0x00)<<2)+((0x02)<<8)},
-  "mulsi",  {OP_REG,OP_REG,OP_IMM},{K1,(0x2)+((0x01)<<2)+((0x02)<<4)},
-  "mulsq",  {OP_REG,OP_IMM,      },{K1,(0x2)+((0x02)<<2)+((0x02)<<4)},
-
-  "mulu",   {OP_REG,OP_REG,OP_REG},{K1,(0x2)+((0x00)<<2)+((0x03)<<8)},
-  "mului",  {OP_REG,OP_REG,OP_IMM},{K1,(0x2)+((0x01)<<2)+((0x03)<<4)},
-  "muluq",  {OP_REG,OP_IMM,      },{K1,(0x2)+((0x02)<<2)+((0x03)<<4)},
-
-  "divs",   {OP_REG,OP_REG,OP_REG},{K1,(0x2)+((0x00)<<2)+((0x04)<<8)},
-  "divsi",  {OP_REG,OP_REG,OP_IMM},{K1,(0x2)+((0x01)<<2)+((0x04)<<4)},
-  "divsq",  {OP_REG,OP_IMM,      },{K1,(0x2)+((0x02)<<2)+((0x04)<<4)},
-
-  "divu",   {OP_REG,OP_REG,OP_REG},{K1,(0x2)+((0x00)<<2)+((0x05)<<8)},
-  "divui",  {OP_REG,OP_REG,OP_IMM},{K1,(0x2)+((0x01)<<2)+((0x05)<<4)},
-  "divuq",  {OP_REG,OP_IMM,      },{K1,(0x2)+((0x02)<<2)+((0x05)<<4)},
-
-  "and",    {OP_REG,OP_REG,OP_REG},{K1,(0x2)+((0x00)<<2)+((0x06)<<8)},
-  "andi",   {OP_REG,OP_REG,OP_IMM},{K1,(0x2)+((0x01)<<2)+((0x06)<<4)},
-  "andq",   {OP_REG,OP_IMM,      },{K1,(0x2)+((0x02)<<2)+((0x06)<<4)},
-
-  "or",     {OP_REG,OP_REG,OP_REG},{K1,(0x2)+((0x00)<<2)+((0x07)<<8)},
-  "ori",    {OP_REG,OP_REG,OP_IMM},{K1,(0x2)+((0x01)<<2)+((0x07)<<4)},
-  "orq",    {OP_REG,OP_IMM,      },{K1,(0x2)+((0x02)<<2)+((0x07)<<4)},
-
-  "xor",    {OP_REG,OP_REG,OP_REG},{K1,(0x2)+((0x00)<<2)+((0x08)<<8)},
-  "xori",   {OP_REG,OP_REG,OP_IMM},{K1,(0x2)+((0x01)<<2)+((0x08)<<4)},
-  "xorq",   {OP_REG,OP_IMM,      },{K1,(0x2)+((0x02)<<2)+((0x08)<<4)},
-
-  "asl",    {OP_REG,OP_REG,OP_REG},{K1,(0x2)+((0x00)<<2)+((0x09)<<8)},
-  "asli",   {OP_REG,OP_REG,OP_IMM},{K1,(0x2)+((0x01)<<2)+((0x09)<<4)},
-  "aslq",   {OP_REG,OP_IMM,      },{K1,(0x2)+((0x02)<<2)+((0x09)<<4)},
-
-  "lsl",    {OP_REG,OP_REG,OP_REG},{K1,(0x2)+((0x00)<<2)+((0x0A)<<8)},
-  "lsli",   {OP_REG,OP_REG,OP_IMM},{K1,(0x2)+((0x01)<<2)+((0x0A)<<4)},
-  "lslq",   {OP_REG,OP_IMM,      },{K1,(0x2)+((0x02)<<2)+((0x0A)<<4)},
-
-  "asr",    {OP_REG,OP_REG,OP_REG},{K1,(0x2)+((0x00)<<2)+((0x0B)<<8)},
-  "asri",   {OP_REG,OP_REG,OP_IMM},{K1,(0x2)+((0x01)<<2)+((0x0B)<<4)},
-  "asrq",   {OP_REG,OP_IMM,      },{K1,(0x2)+((0x02)<<2)+((0x0B)<<4)},
-  
-  "lsr",    {OP_REG,OP_REG,OP_REG},{K1,(0x2)+((0x00)<<2)+((0x0C)<<8)},
-  "lsri",   {OP_REG,OP_REG,OP_IMM},{K1,(0x2)+((0x01)<<2)+((0x0C)<<4)},
-  "lsrq",   {OP_REG,OP_IMM,      },{K1,(0x2)+((0x02)<<2)+((0x0C)<<4)},
+  "nop",       {                    },{K1,0x0062,K1_QUALIFIER_END  ,{7,1,0},{{0,0,0},{0,0,0},{0,0,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "xchg",      {                    },{K1,0x0022,K1_QUALIFIER_NONE ,{0,0,0},{{0,0,0},{0,0,0},{0,0,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "movei",     {OP_REG,OP_IMM,      },{K1,0x000E,K1_QUALIFIER_NONE ,{0,0,0},{{26,6,0},{4,22,0},{0,0,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "add",       {OP_REG,OP_REG,OP_REG},{K1,0x0002,K1_QUALIFIER_SIZE ,{12,2,0},{{26,6,0},{20,6,0},{14,6,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "addi",      {OP_REG,OP_REG,OP_IMM},{K1,0x0006,K1_QUALIFIER_SIZE ,{8,2,0},{{26,6,0},{20,6,0},{10,10,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "move",      {OP_REG,OP_REG,      },{K1,0x0006,K1_QUALIFIER_SIZE ,{8,2,0},{{26,6,0},{20,6,0},{0,0,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "addq",      {OP_REG,OP_IMM,      },{K1,0x000A,K1_QUALIFIER_SIZE ,{8,2,0},{{26,6,0},{10,16,0},{0,0,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "sub",       {OP_REG,OP_REG,OP_REG},{K1,0x0102,K1_QUALIFIER_SIZE ,{12,2,0},{{26,6,0},{20,6,0},{14,6,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "subi",      {OP_REG,OP_REG,OP_IMM},{K1,0x0016,K1_QUALIFIER_SIZE ,{8,2,0},{{26,6,0},{20,6,0},{10,10,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "subq",      {OP_REG,OP_IMM,      },{K1,0x001A,K1_QUALIFIER_SIZE ,{8,2,0},{{26,6,0},{10,16,0},{0,0,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "muls",      {OP_REG,OP_REG,OP_REG},{K1,0x0202,K1_QUALIFIER_SIZE ,{12,2,0},{{26,6,0},{20,6,0},{14,6,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "mulsi",     {OP_REG,OP_REG,OP_IMM},{K1,0x0026,K1_QUALIFIER_SIZE ,{8,2,0},{{26,6,0},{20,6,0},{10,10,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "mulsq",     {OP_REG,OP_IMM,      },{K1,0x002A,K1_QUALIFIER_SIZE ,{8,2,0},{{26,6,0},{10,16,0},{0,0,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "mulu",      {OP_REG,OP_REG,OP_REG},{K1,0x0302,K1_QUALIFIER_SIZE ,{12,2,0},{{26,6,0},{20,6,0},{14,6,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "mului",     {OP_REG,OP_REG,OP_IMM},{K1,0x0036,K1_QUALIFIER_SIZE ,{8,2,0},{{26,6,0},{20,6,0},{10,10,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "muluq",     {OP_REG,OP_IMM,      },{K1,0x003A,K1_QUALIFIER_SIZE ,{8,2,0},{{26,6,0},{10,16,0},{0,0,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "divs",      {OP_REG,OP_REG,OP_REG},{K1,0x0402,K1_QUALIFIER_SIZE ,{12,2,0},{{26,6,0},{20,6,0},{14,6,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "divsi",     {OP_REG,OP_REG,OP_IMM},{K1,0x0046,K1_QUALIFIER_SIZE ,{8,2,0},{{26,6,0},{20,6,0},{10,10,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "divsq",     {OP_REG,OP_IMM,      },{K1,0x004A,K1_QUALIFIER_SIZE ,{8,2,0},{{26,6,0},{10,16,0},{0,0,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "divu",      {OP_REG,OP_REG,OP_REG},{K1,0x0502,K1_QUALIFIER_SIZE ,{12,2,0},{{26,6,0},{20,6,0},{14,6,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "divui",     {OP_REG,OP_REG,OP_IMM},{K1,0x0056,K1_QUALIFIER_SIZE ,{8,2,0},{{26,6,0},{20,6,0},{10,10,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "divuq",     {OP_REG,OP_IMM,      },{K1,0x005A,K1_QUALIFIER_SIZE ,{8,2,0},{{26,6,0},{10,16,0},{0,0,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "and",       {OP_REG,OP_REG,OP_REG},{K1,0x0602,K1_QUALIFIER_SIZE ,{12,2,0},{{26,6,0},{20,6,0},{14,6,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "andi",      {OP_REG,OP_REG,OP_IMM},{K1,0x0066,K1_QUALIFIER_SIZE ,{8,2,0},{{26,6,0},{20,6,0},{10,10,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "andq",      {OP_REG,OP_IMM,      },{K1,0x006A,K1_QUALIFIER_SIZE ,{8,2,0},{{26,6,0},{10,16,0},{0,0,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "or",        {OP_REG,OP_REG,OP_REG},{K1,0x0702,K1_QUALIFIER_SIZE ,{12,2,0},{{26,6,0},{20,6,0},{14,6,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "ori",       {OP_REG,OP_REG,OP_IMM},{K1,0x0076,K1_QUALIFIER_SIZE ,{8,2,0},{{26,6,0},{20,6,0},{10,10,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "orq",       {OP_REG,OP_IMM,      },{K1,0x007A,K1_QUALIFIER_SIZE ,{8,2,0},{{26,6,0},{10,16,0},{0,0,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "xor",       {OP_REG,OP_REG,OP_REG},{K1,0x0802,K1_QUALIFIER_SIZE ,{12,2,0},{{26,6,0},{20,6,0},{14,6,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "xori",      {OP_REG,OP_REG,OP_IMM},{K1,0x0086,K1_QUALIFIER_SIZE ,{8,2,0},{{26,6,0},{20,6,0},{10,10,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "xorq",      {OP_REG,OP_IMM,      },{K1,0x008A,K1_QUALIFIER_SIZE ,{8,2,0},{{26,6,0},{10,16,0},{0,0,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "asl",       {OP_REG,OP_REG,OP_REG},{K1,0x0902,K1_QUALIFIER_SIZE ,{12,2,0},{{26,6,0},{20,6,0},{14,6,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "asli",      {OP_REG,OP_REG,OP_IMM},{K1,0x0096,K1_QUALIFIER_SIZE ,{8,2,0},{{26,6,0},{20,6,0},{10,10,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "aslq",      {OP_REG,OP_IMM,      },{K1,0x009A,K1_QUALIFIER_SIZE ,{8,2,0},{{26,6,0},{10,16,0},{0,0,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "lsl",       {OP_REG,OP_REG,OP_REG},{K1,0x0A02,K1_QUALIFIER_SIZE ,{12,2,0},{{26,6,0},{20,6,0},{14,6,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "lsli",      {OP_REG,OP_REG,OP_IMM},{K1,0x00A6,K1_QUALIFIER_SIZE ,{8,2,0},{{26,6,0},{20,6,0},{10,10,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "lslq",      {OP_REG,OP_IMM,      },{K1,0x00AA,K1_QUALIFIER_SIZE ,{8,2,0},{{26,6,0},{10,16,0},{0,0,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "asr",       {OP_REG,OP_REG,OP_REG},{K1,0x0B02,K1_QUALIFIER_SIZE ,{12,2,0},{{26,6,0},{20,6,0},{14,6,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "asri",      {OP_REG,OP_REG,OP_IMM},{K1,0x00B6,K1_QUALIFIER_SIZE ,{8,2,0},{{26,6,0},{20,6,0},{10,10,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "asrq",      {OP_REG,OP_IMM,      },{K1,0x00BA,K1_QUALIFIER_SIZE ,{8,2,0},{{26,6,0},{10,16,0},{0,0,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "lsr",       {OP_REG,OP_REG,OP_REG},{K1,0x0C02,K1_QUALIFIER_SIZE ,{12,2,0},{{26,6,0},{20,6,0},{14,6,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "lsri",      {OP_REG,OP_REG,OP_IMM},{K1,0x00C6,K1_QUALIFIER_SIZE ,{8,2,0},{{26,6,0},{20,6,0},{10,10,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "lsrq",      {OP_REG,OP_IMM,      },{K1,0x00CA,K1_QUALIFIER_SIZE ,{8,2,0},{{26,6,0},{10,16,0},{0,0,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
 
   //BRU
-  "bne",    {OP_IMM,             },{K1,(0x0)+((0+0x0C)<<2)+((0x00)<<8)},
-  "beq",    {OP_IMM,             },{K1,(0x0)+((0+0x0C)<<2)+((0x01)<<8)},
-
-  "bl",     {OP_IMM,             },{K1,(0x0)+((0+0x0C)<<2)+((0x02)<<8)},
-  "ble",    {OP_IMM,             },{K1,(0x0)+((0+0x0C)<<2)+((0x03)<<8)},
-
-  "bg",     {OP_IMM,             },{K1,(0x0)+((0+0x0C)<<2)+((0x04)<<8)},
-  "bge",    {OP_IMM,             },{K1,(0x0)+((0+0x0C)<<2)+((0x05)<<8)},
-
-  "bls",    {OP_IMM,             },{K1,(0x0)+((0+0x0C)<<2)+((0x06)<<8)},
-  "bles",   {OP_IMM,             },{K1,(0x0)+((0+0x0C)<<2)+((0x07)<<8)},
-
-  "bgs",    {OP_IMM,             },{K1,(0x0)+((0+0x0C)<<2)+((0x08)<<8)},
-  "bges",   {OP_IMM,             },{K1,(0x0)+((0+0x0C)<<2)+((0x09)<<8)},
-
-  "bra",    {OP_IMM,             },{K1,(0x0)+((0+0x0C)<<2)+((0x0A)<<8)},
-
-  "cmp",    {OP_REG,OP_REG,      },{K1,(0x0)+((0+0x00)<<2)},
-  "cmpi",   {OP_REG,OP_IMM,      },{K1,(0x0)+((0+0x01)<<2)},
-
-  "fcmp",   {OP_VF ,OP_VF ,      },{K1,(0x0)+((0+0x04)<<2)},
-  "fcmpi",  {OP_VF ,OP_IMM,      },{K1,(0x0)+((0+0x02)<<2)},
-
-  "dcmp",   {OP_VD ,OP_VD ,      },{K1,(0x0)+((0+0x08)<<2)},
-  "dcmpi",  {OP_VD ,OP_IMM,      },{K1,(0x0)+((0+0x03)<<2)},
-
-  "jmp",    {OP_IMM,             },{K1,(0x0)+((0+0x2C)<<2)+((0x00)<<8)},
-  "call",   {OP_IMM,             },{K1,(0x0)+((0+0x2C)<<2)+((0x01)<<8)},
-  "jmpr",   {OP_IMM,             },{K1,(0x0)+((0+0x2C)<<2)+((0x02)<<8)},
-  "callr",  {OP_IMM,             },{K1,(0x0)+((0+0x2C)<<2)+((0x03)<<8)},
-
-  "ret",    {                    },{K1,(0x0)+((0+0x3C)<<2)},
+  "bne",       {OP_IMM,             },{K1,0x0030,K1_QUALIFIER_NONE ,{0,0,0},{{12,14,0},{0,0,0},{0,0,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_RELATIVE},
+  "beq",       {OP_IMM,             },{K1,0x0130,K1_QUALIFIER_NONE ,{0,0,0},{{12,14,0},{0,0,0},{0,0,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_RELATIVE},
+  "bl",        {OP_IMM,             },{K1,0x0230,K1_QUALIFIER_NONE ,{0,0,0},{{12,14,0},{0,0,0},{0,0,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_RELATIVE},
+  "ble",       {OP_IMM,             },{K1,0x0330,K1_QUALIFIER_NONE ,{0,0,0},{{12,14,0},{0,0,0},{0,0,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_RELATIVE},
+  "bg",        {OP_IMM,             },{K1,0x0430,K1_QUALIFIER_NONE ,{0,0,0},{{12,14,0},{0,0,0},{0,0,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_RELATIVE},
+  "bge",       {OP_IMM,             },{K1,0x0530,K1_QUALIFIER_NONE ,{0,0,0},{{12,14,0},{0,0,0},{0,0,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_RELATIVE},
+  "bls",       {OP_IMM,             },{K1,0x0630,K1_QUALIFIER_NONE ,{0,0,0},{{12,14,0},{0,0,0},{0,0,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_RELATIVE},
+  "bles",      {OP_IMM,             },{K1,0x0730,K1_QUALIFIER_NONE ,{0,0,0},{{12,14,0},{0,0,0},{0,0,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_RELATIVE},
+  "bgs",       {OP_IMM,             },{K1,0x0830,K1_QUALIFIER_NONE ,{0,0,0},{{12,14,0},{0,0,0},{0,0,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_RELATIVE},
+  "bges",      {OP_IMM,             },{K1,0x0930,K1_QUALIFIER_NONE ,{0,0,0},{{12,14,0},{0,0,0},{0,0,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_RELATIVE},
+  "cmp",       {OP_REG,OP_REG,      },{K1,0x0000,K1_QUALIFIER_SIZE ,{8,2,0},{{26,6,0},{20,6,0},{0,0,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "cmpi",      {OP_REG,OP_IMM,      },{K1,0x0004,K1_QUALIFIER_SIZE ,{4,2,0},{{26,6,0},{6,20,0},{0,0,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "fcmp",      {OP_VF ,OP_VF ,      },{K1,0x0010,K1_QUALIFIER_NONE ,{0,0,0},{{25,7,0},{18,7,0},{0,0,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "fcmpi",     {OP_VF ,OP_IMM,      },{K1,0x0008,K1_QUALIFIER_NONE ,{0,0,0},{{25,7,0},{4,21,0},{0,0,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "dcmp",      {OP_VD ,OP_VD ,      },{K1,0x0020,K1_QUALIFIER_NONE ,{0,0,0},{{26,6,0},{20,6,0},{0,0,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "dcmpi",     {OP_VD ,OP_IMM,      },{K1,0x000C,K1_QUALIFIER_NONE ,{0,0,0},{{26,6,0},{4,22,0},{0,0,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "jmp",       {OP_IMM,             },{K1,0x01B0,K1_QUALIFIER_NONE ,{0,0,0},{{12,14,0},{0,0,0},{0,0,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_ABSOLUTE},
+  "call",      {OP_IMM,             },{K1,0x00B0,K1_QUALIFIER_NONE ,{0,0,0},{{12,14,0},{0,0,0},{0,0,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_ABSOLUTE},
+  "jmpr",      {OP_IMM,             },{K1,0x03B0,K1_QUALIFIER_NONE ,{0,0,0},{{12,14,0},{0,0,0},{0,0,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_RELATIVE},
+  "callr",     {OP_IMM,             },{K1,0x02B0,K1_QUALIFIER_NONE ,{0,0,0},{{12,14,0},{0,0,0},{0,0,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_RELATIVE},
+  "ret",       {                    },{K1,0x00F0,K1_QUALIFIER_NONE ,{0,0,0},{{0,0,0},{0,0,0},{0,0,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
 
   //VFPU
-  "fadd",   {OP_VT ,OP_VT ,OP_VT },{K1,(0x3)+((0x00)<<10)},
-  "fsub",   {OP_VT ,OP_VT ,OP_VT },{K1,(0x3)+((0x01)<<10)},
-  "fmul",   {OP_VT ,OP_VT ,OP_VT },{K1,(0x3)+((0x02)<<10)},
-  "fmuladd",{OP_VT ,OP_VT ,OP_VT },{K1,(0x3)+((0x03)<<10)},
-
-  "dadd",   {OP_VD ,OP_VD ,OP_VD },{K1,(0x3)+((0x00)<<6)+(0x30)},
-  "dsub",   {OP_VD ,OP_VD ,OP_VD },{K1,(0x3)+((0x01)<<6)+(0x30)},
-  "dmul",   {OP_VD ,OP_VD ,OP_VD },{K1,(0x3)+((0x02)<<6)+(0x30)},
-  "dmuladd",{OP_VD ,OP_VD ,OP_VD },{K1,(0x3)+((0x03)<<6)+(0x30)},
-
-  "faddv",   {OP_VT ,OP_VT ,OP_VF },{K1,(0x3)+((0x00)<<10)+(0x20)},
-  "fsubv",   {OP_VT ,OP_VT ,OP_VF },{K1,(0x3)+((0x01)<<10)+(0x20)},
-  "fmulv",   {OP_VT ,OP_VT ,OP_VF },{K1,(0x3)+((0x02)<<10)+(0x20)},
-  "fmuladdv",{OP_VT ,OP_VT ,OP_VF },{K1,(0x3)+((0x03)<<10)+(0x20)},
-
-  "fmulva",    {OP_VT ,OP_VF ,      },{K1,(0x3)+((0x00)<<10)+(0x10)},
-  "fmuladdva", {OP_VT ,OP_VF ,      },{K1,(0x3)+((0x01)<<10)+(0x10)},
-  "fmuladdvao",{OP_VT ,OP_VT ,OP_VF },{K1,(0x3)+((0x02)<<10)+(0x10)},
-  "fipr",      {OP_VF ,OP_VT ,OP_VT },{K1,(0x3)+((0x03)<<10)+(0x10)},
-
-
-  "movefi", {OP_VF ,OP_IMM,      },{K1,(0x3)+((0x01)<<2)},
-  "movedi", {OP_VD ,OP_IMM,      },{K1,(0x3)+((0x02)<<2)},
-  "movevi", {OP_VT ,OP_IMM,      },{K1,(0x3)+((0x03)<<2)},
-
-  "movev",  {OP_VT ,OP_VT ,      },{K1,(0x3)+((0x01)<<4)},
-  "movefd", {OP_VD ,OP_VF ,      },{K1,(0x3)+((0x02)<<4)},
-  "movedf", {OP_VF ,OP_VD ,      },{K1,(0x3)+((0x12)<<4)},
-
-
-  "itof0",  {OP_VT ,OP_REG,      },{K1,(0x3)+((0x03)<<4)+((0x00)<<12)},
-  "itof4",  {OP_VT ,OP_REG,      },{K1,(0x3)+((0x03)<<4)+((0x01)<<12)},
-  "itof8",  {OP_VT ,OP_REG,      },{K1,(0x3)+((0x03)<<4)+((0x02)<<12)},
-  "itof15", {OP_VT ,OP_REG,      },{K1,(0x3)+((0x03)<<4)+((0x03)<<12)},
-
-  "ftoi0",  {OP_REG,OP_VT ,      },{K1,(0x3)+((0x03)<<4)+((0x04)<<12)},
-  "ftoi4",  {OP_REG,OP_VT ,      },{K1,(0x3)+((0x03)<<4)+((0x05)<<12)},
-  "ftoi8",  {OP_REG,OP_VT ,      },{K1,(0x3)+((0x03)<<4)+((0x06)<<12)},
-  "ftoi15", {OP_REG,OP_VT ,      },{K1,(0x3)+((0x03)<<4)+((0x07)<<12)},
-
-  "itof",   {OP_VF ,OP_REG,      },{K1,(0x3)+((0x03)<<4)+((0x01)<<8)},
-  "ftoi",   {OP_REG,OP_VF ,      },{K1,(0x3)+((0x03)<<4)+((0x05)<<8)},
-  "itod",   {OP_VD ,OP_REG,      },{K1,(0x3)+((0x03)<<4)+((0x02)<<8)},
-  "dtoi",   {OP_REG,OP_VD ,      },{K1,(0x3)+((0x03)<<4)+((0x06)<<8)},
-
-  //FDIV
-  "fdiv",   {OP_VT ,OP_VT ,OP_VT },{K1,(0x33)+((0x0C)<<6)},
-  "fsqrt",  {OP_VT ,OP_VT ,OP_VT },{K1,(0x33)+((0x0D)<<6)},
-
-  "ddiv",   {OP_VT ,OP_VT ,OP_VT },{K1,(0x33)+((0x0E)<<6)},
-  "dsqrt",  {OP_VT ,OP_VT ,OP_VT },{K1,(0x33)+((0x0F)<<6)},
+  "fadd",      {OP_VT ,OP_VT ,OP_VT },{K1,0x0003,K1_QUALIFIER_LANES,{6,2,0},{{27,5,0},{22,5,0},{17,5,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "fsub",      {OP_VT ,OP_VT ,OP_VT },{K1,0x0403,K1_QUALIFIER_LANES,{6,2,0},{{27,5,0},{22,5,0},{17,5,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "fmul",      {OP_VT ,OP_VT ,OP_VT },{K1,0x0803,K1_QUALIFIER_LANES,{6,2,0},{{27,5,0},{22,5,0},{17,5,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "fmuladd",   {OP_VT ,OP_VT ,OP_VT },{K1,0x0C03,K1_QUALIFIER_LANES,{6,2,0},{{27,5,0},{22,5,0},{17,5,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "faddv",     {OP_VT ,OP_VT ,OP_VF },{K1,0x0103,K1_QUALIFIER_LANES,{6,2,0},{{27,5,0},{22,5,0},{15,7,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "fsubv",     {OP_VT ,OP_VT ,OP_VF },{K1,0x0503,K1_QUALIFIER_LANES,{6,2,0},{{27,5,0},{22,5,0},{15,7,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "fmulv",     {OP_VT ,OP_VT ,OP_VF },{K1,0x0903,K1_QUALIFIER_LANES,{6,2,0},{{27,5,0},{22,5,0},{15,7,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "fmuladdv",  {OP_VT ,OP_VT ,OP_VF },{K1,0x0D03,K1_QUALIFIER_LANES,{6,2,0},{{27,5,0},{22,5,0},{15,7,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "fmulva",    {OP_VT ,OP_VF ,      },{K1,0x0203,K1_QUALIFIER_LANES,{6,2,0},{{22,5,0},{15,7,0},{0,0,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "fmuladdva", {OP_VT ,OP_VF ,      },{K1,0x0603,K1_QUALIFIER_LANES,{6,2,0},{{22,5,0},{15,7,0},{0,0,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "fmuladdvao",{OP_VT ,OP_VT ,OP_VF },{K1,0x0A03,K1_QUALIFIER_LANES,{6,2,0},{{27,5,0},{22,5,0},{15,7,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "fipr",      {OP_VF ,OP_VT ,OP_VT },{K1,0x0E03,K1_QUALIFIER_LANES,{6,2,0},{{15,7,0},{22,5,0},{27,5,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "movev",     {OP_VT ,OP_VT ,      },{K1,0x0013,K1_QUALIFIER_LANES,{6,2,0},{{27,5,0},{22,5,0},{0,0,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "movefd",    {OP_VF ,OP_VD ,      },{K1,0x0063,K1_QUALIFIER_NONE ,{0,0,0},{{19,7,0},{26,6,0},{0,0,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "movedf",    {OP_VD ,OP_VF ,      },{K1,0x0023,K1_QUALIFIER_NONE ,{0,0,0},{{26,6,0},{19,7,0},{0,0,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "itof0",     {OP_VT ,OP_REG,      },{K1,0x0033,K1_QUALIFIER_LANES,{6,2,0},{{21,5,0},{26,6,0},{0,0,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "itof4",     {OP_VT ,OP_REG,      },{K1,0x1033,K1_QUALIFIER_LANES,{6,2,0},{{21,5,0},{26,6,0},{0,0,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "itof8",     {OP_VT ,OP_REG,      },{K1,0x2033,K1_QUALIFIER_LANES,{6,2,0},{{21,5,0},{26,6,0},{0,0,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "itof15",    {OP_VT ,OP_REG,      },{K1,0x3033,K1_QUALIFIER_LANES,{6,2,0},{{21,5,0},{26,6,0},{0,0,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "ftoi0",     {OP_REG,OP_VT ,      },{K1,0x4033,K1_QUALIFIER_LANES,{6,2,0},{{26,6,0},{21,5,0},{0,0,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "ftoi4",     {OP_REG,OP_VT ,      },{K1,0x5033,K1_QUALIFIER_LANES,{6,2,0},{{26,6,0},{21,5,0},{0,0,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "ftoi8",     {OP_REG,OP_VT ,      },{K1,0x6033,K1_QUALIFIER_LANES,{6,2,0},{{26,6,0},{21,5,0},{0,0,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "ftoi15",    {OP_REG,OP_VT ,      },{K1,0x7033,K1_QUALIFIER_LANES,{6,2,0},{{26,6,0},{21,5,0},{0,0,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "itof",      {OP_VF ,OP_REG,      },{K1,0x0133,K1_QUALIFIER_SIZE ,{6,2,0},{{19,7,0},{26,6,0},{0,0,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "ftoi",      {OP_REG,OP_VF ,      },{K1,0x0533,K1_QUALIFIER_SIZE ,{6,2,0},{{26,6,0},{19,7,0},{0,0,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "dadd",      {OP_VD ,OP_VD ,OP_VD },{K1,0x0303,K1_QUALIFIER_NONE ,{0,0,0},{{26,6,0},{20,6,0},{14,6,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "dsub",      {OP_VD ,OP_VD ,OP_VD },{K1,0x0343,K1_QUALIFIER_NONE ,{0,0,0},{{26,6,0},{20,6,0},{14,6,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "dmul",      {OP_VD ,OP_VD ,OP_VD },{K1,0x0383,K1_QUALIFIER_NONE ,{0,0,0},{{26,6,0},{20,6,0},{14,6,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "dmuladd",   {OP_VD ,OP_VD ,OP_VD },{K1,0x03C3,K1_QUALIFIER_NONE ,{0,0,0},{{26,6,0},{20,6,0},{14,6,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "itod",      {OP_VD ,OP_REG,      },{K1,0x0233,K1_QUALIFIER_SIZE ,{6,2,0},{{20,6,0},{26,6,0},{0,0,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "dtoi",      {OP_REG,OP_VD ,      },{K1,0x0633,K1_QUALIFIER_SIZE ,{6,2,0},{{26,6,0},{20,6,0},{0,0,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "movefi",    {OP_VF ,OP_IMM,      },{K1,0x0007,K1_QUALIFIER_NONE ,{0,0,0},{{25,7,0},{4,21,0},{0,0,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "movedi",    {OP_VD ,OP_IMM,      },{K1,0x000B,K1_QUALIFIER_NONE ,{0,0,0},{{26,6,0},{4,22,0},{0,0,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "movevi",    {OP_VT ,OP_IMM,      },{K1,0x000F,K1_QUALIFIER_NONE ,{0,0,0},{{27,5,0},{4,23,0},{0,0,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+
+  //VDIV
+  "fdiv",      {OP_VF ,OP_VF ,OP_VF },{K1,0x0333,K1_QUALIFIER_NONE ,{0,0,0},{{25,7,0},{11,7,0},{18,7,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "fsqrt",     {OP_VF ,OP_VF ,      },{K1,0x0373,K1_QUALIFIER_NONE ,{0,0,0},{{25,7,0},{11,7,0},{0,0,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "ddiv",      {OP_VD ,OP_VD ,OP_VD },{K1,0x03B3,K1_QUALIFIER_NONE ,{0,0,0},{{26,6,0},{14,6,0},{20,6,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
+  "dsqrt",     {OP_VD ,OP_VD ,      },{K1,0x03F3,K1_QUALIFIER_NONE ,{0,0,0},{{26,6,0},{14,6,0},{0,0,0}},{{0,0,0},{0,0,0},{0,0,0}},{0,0,0},K1_TARGET_NONE},
@@ -0,0 +1,24 @@
+;Division-dominated loop: five DIVS and DIVU of every size out of twelve operations, divisors never zero
+	movei r1,1
+	movei r2,1000000
+	movei r3,1000003
+	movei r4,7
+	movei r8,0
+	nop
+Loop:
+	addq.q r1,1
+	divu.q r5,r3,r4
+	divs.l r6,r3,r1
+	addq.q r4,3
+	divu.w r7,r5,r4
+	xor.q r3,r3,r6
+	cmp.q r1,r2
+	add.q r8,r8,r7
+	bne Loop
+	divs.q r9,r8,r4
+	divu.l r10,r9,r1
+	nop
+	nop.e
+	nop
+	nop
+	nop
@@ -0,0 +1,265 @@
+#include <base/vm.h>
+
+#include <iostream>
+#include <iomanip>
+#include <stdexcept>
+#include <utility>
+#include <memory>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <chrono>
+#include <limits>
+#include <algorithm>
+#include <charconv>
+
+#include <shared_library.hpp>
+
+namespace
+{
+
+struct implementation
+{
+    explicit implementation(const std::string& path)
+    :library{path}
+    ,name{path}
+    {
+        arCreateVirtualMachine  = library.load<PFN_arCreateVirtualMachine>("arCreateVirtualMachine");
+        arCreateProcessor       = library.load<PFN_arCreateProcessor>("arCreateProcessor");
+        arCreatePhysicalMemory  = library.load<PFN_arCreatePhysicalMemory>("arCreatePhysicalMemory");
+        arRunProcessor          = library.load<PFN_arRunProcessor>("arRunProcessor");
+        arDestroyVirtualMachine = library.load<PFN_arDestroyVirtualMachine>("arDestroyVirtualMachine");
+        arDestroyProcessor      = library.load<PFN_arDestroyProcessor>("arDestroyProcessor");
+        arDestroyPhysicalMemory = library.load<PFN_arDestroyPhysicalMemory>("arDestroyPhysicalMemory");
+    }
+
+    nes::shared_library library;
+    std::string name;
+
+    PFN_arCreateVirtualMachine  arCreateVirtualMachine{};
+    PFN_arCreateProcessor       arCreateProcessor{};
+    PFN_arCreatePhysicalMemory  arCreatePhysicalMemory{};
+    PFN_arRunProcessor          arRunProcessor{};
+    PFN_arDestroyVirtualMachine arDestroyVirtualMachine{};
+    PFN_arDestroyProcessor      arDestroyProcessor{};
+    PFN_arDestroyPhysicalMemory arDestroyPhysicalMemory{};
+};
+
+struct measure
+{
+    std::uint64_t cycles{};
+    double seconds{std::numeric_limits<double>::max()};
+};
+
+constexpr std::size_t physical_memory_size{8 * 1024 * 1024};
+
+//Runs the whole binary once, timing arRunProcessor only
+measure run_once(const implementation& impl, const std::vector<std::uint32_t>& code, std::uint8_t* memory)
+{
+    ArVirtualMachineCreateInfo machine_info{};
+    machine_info.sType = AR_STRUCTURE_TYPE_VIRTUAl_MACHINE_CREATE_INFO;
+
+    ArVirtualMachine machine{};
+    if(impl.arCreateVirtualMachine(&machine, &machine_info) != AR_SUCCESS)
+    {
+        throw std::runtime_error{"Can not create virtual machine."};
+    }
+
+    ArProcessorCreateInfo processor_info{};
+    processor_info.sType = AR_STRUCTURE_TYPE_PROCESSOR_CREATE_INFO;
+    processor_info.pBootCode = std::data(code);
+    processor_info.bootCodeSize = static_cast<std::uint32_t>(std::size(code));
+
+    ArProcessor processor{};
+    if(impl.arCreateProcessor(machine, &processor_info, &processor) != AR_SUCCESS)
+    {
+        impl.arDestroyVirtualMachine(machine);
+        throw std::runtime_error{"Can not create processor."};
+    }
+
+    ArPhysicalMemoryCreateInfo memory_info{};
+    memory_info.sType = AR_STRUCTURE_TYPE_PHYSICAL_MEMORY_CREATE_INFO;
+    memory_info.pMemory = memory;
+    memory_info.size = physical_memory_size;
+
+    ArPhysicalMemory physical_memory{};
+    if(impl.arCreatePhysicalMemory(machine, &memory_info, &physical_memory) != AR_SUCCESS)
+    {
+        impl.arDestroyProcessor(machine, processor);
+        impl.arDestroyVirtualMachine(machine);
+        throw std::runtime_error{"Can not create physical memory."};
+    }
+
+    measure output{};
+
+    const auto begin{std::chrono::steady_clock::now()};
+    const auto result{impl.arRunProcessor(processor, std::numeric_limits<std::uint64_t>::max(), &output.cycles)};
+    const auto end{std::chrono::steady_clock::now()};
+
+    output.seconds = std::chrono::duration<double>{end - begin}.count();
+
+    impl.arDestroyPhysicalMemory(machine, physical_memory);
+    impl.arDestroyProcessor(machine, processor);
+    impl.arDestroyVirtualMachine(machine);
+
+    if(result != AR_END_OF_CODE)
+    {
+        throw std::runtime_error{"Can not run processor."};
+    }
+
+    return output;
+}
+
+std::vector<std::uint32_t> read_binary(const std::filesystem::path& path)
+{
+    std::ifstream ifs{path, std::ios_base::binary};
+    if(!ifs)
+    {
+        throw std::runtime_error{"Can not find file \"" + path.string() + "\"."};
+    }
+
+    std::vector<std::uint32_t> output{};
+    output.resize(std::filesystem::file_size(path) / 4u);
+
+    const auto bytes_size{static_cast<std::streamsize>(std::size(output) * 4)};
+    if(ifs.read(reinterpret_cast<char*>(std::data(output)), bytes_size).gcount() != bytes_size)
+    {
+        throw std::runtime_error{"Can not read file \"" + path.string() + "\"."};
+    }
+
+    return output;
+}
+
+struct benchmark_options
+{
+    std::vector<std::string> binaries{};
+    std::vector<std::string> libraries{};
+    std::uint32_t repeat{5};
+};
+
+#ifdef NES_WIN32_SHARED_LIBRARY
+constexpr const char* threaded_default_path{"altair_vm_relaxed.dll"};
+constexpr const char* switch_default_path{"altair_vm_relaxed_switch.dll"};
+constexpr const char* jit_default_path{"altair_vm_jit.dll"};
+#else
+constexpr const char* threaded_default_path{"altair_vm_relaxed.so"};
+constexpr const char* switch_default_path{"altair_vm_relaxed_switch.so"};
+constexpr const char* jit_default_path{"altair_vm_jit.so"};
+#endif
+
+benchmark_options parse_arguments(const std::vector<std::string_view>& args)
+{
+    if(std::size(args) < 2)
+    {
+        throw std::runtime_error{"Usage: altair_vm_benchmark [path_to_binary...] [-repeat=N] [-library=path...]"};
+    }
+
+    benchmark_options output{};
+
+    for(auto it{std::cbegin(args) + 1}; it != std::cend(args); ++it)
+    {
+        if(it->substr(0, 8) == "-repeat=")
+        {
+            const auto value{it->substr(8)};
+            std::from_chars(std::data(value), std::data(value) + std::size(value), output.repeat);
+            output.repeat = std::max(output.repeat, 1u);
+        }
+        else if(it->substr(0, 9) == "-library=")
+        {
+            output.libraries.emplace_back(it->substr(9));
+        }
+        else if(!std::empty(*it) && it->front() == '-')
+        {
+            std::cout << "Unrecognised argument [" << *it << "]" << std::endl;
+        }
+        else
+        {
+            output.binaries.emplace_back(*it);
+        }
+    }
+
+    if(std::empty(output.libraries))
+    {
+        output.libraries.emplace_back(threaded_default_path);
+        output.libraries.emplace_back(switch_default_path);
+        output.libraries.emplace_back(jit_default_path);
+    }
+
+    return output;
+}
+
+void run(const benchmark_options& options)
+{
+    std::vector<implementation> implementations{};
+    implementations.reserve(std::size(options.libraries));
+    for(auto&& path : options.libraries)
+    {
+        implementations.emplace_back(path);
+    }
+
+    auto memory{std::make_unique<std::uint8_t[]>(physical_memory_size)};
+
+    std::cout << std::fixed << std::setprecision(2);
+
+    for(auto&& path : options.binaries)
+    {
+        const auto code{read_binary(path)};
+
+        std::cout << path << std::endl;
+
+        double reference{};
+        for(auto&& impl : implementations)
+        {
+            measure best{};
+            for(std::uint32_t i{}; i < options.repeat; ++i)
+            {
+                std::fill_n(memory.get(), physical_memory_size, std::uint8_t{});
+
+                const auto current{run_once(impl, code, memory.get())};
+                if(current.seconds < best.seconds)
+                {
+                    best = current;
+                }
+            }
+
+            const auto rate{static_cast<double>(best.cycles) / best.seconds / 1000000.0};
+            if(reference == 0.0)
+            {
+                reference = rate;
+            }
+
+            std::cout << "    " << std::left << std::setw(32) << impl.name
+                      << std::right << std::setw(14) << best.cycles << " bundles "
+                      << std::setw(10) << best.seconds * 1000.0 << " ms "
+                      << std::setw(10) << rate << " Mbundles/s "
+                      << std::setw(6) << rate / reference << "x" << std::endl;
+        }
+    }
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        std::cout.sync_with_stdio(false);
+
+        std::vector<std::string_view> args{};
+        args.reserve(static_cast<std::size_t>(argc));
+        for(int i{}; i < argc; ++i)
+        {
+            args.emplace_back(argv[i]);
+        }
+
+        run(parse_arguments(args));
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+
+        return 1;
+    }
+}
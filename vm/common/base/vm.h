@@ -22,7 +22,11 @@ typedef enum ArResult
     AR_ERROR_TOO_MANY_OBJECTS = -3,
     AR_ERROR_MEMORY_OUT_OF_RANGE = -4,
     AR_ERROR_PHYSICAL_MEMORY_OUT_OF_RANGE = -5,
+    AR_ERROR_PHYSICAL_MEMORY_OVERLAP = -6,
+    AR_ERROR_INVALID_STATE = -7,
+    AR_ERROR_BUFFER_TOO_SMALL = -8,
     AR_ERROR_HOST_OUT_OF_MEMORY = -256,
+    AR_ERROR_HOST_MAPPING_FAILED = -257,
 } ArResult;
 
 typedef enum ArStructureType
@@ -30,8 +34,31 @@ typedef enum ArStructureType
     AR_STRUCTURE_TYPE_VIRTUAl_MACHINE_CREATE_INFO = 0,
     AR_STRUCTURE_TYPE_PROCESSOR_CREATE_INFO = 1,
     AR_STRUCTURE_TYPE_PHYSICAL_MEMORY_CREATE_INFO = 2,
+    AR_STRUCTURE_TYPE_VIRTUAL_MACHINE_RUN_INFO = 3,
+    AR_STRUCTURE_TYPE_PROCESSOR_DMA_CREATE_INFO = 4,
+    AR_STRUCTURE_TYPE_PROCESSOR_STATISTICS = 5,
+    AR_STRUCTURE_TYPE_PHYSICAL_MEMORY_MAPPING_CREATE_INFO = 6,
+    AR_STRUCTURE_TYPE_PROCESSOR_CACHE_CREATE_INFO = 7,
+    AR_STRUCTURE_TYPE_PROCESSOR_TRACE_CREATE_INFO = 8,
+    AR_STRUCTURE_TYPE_PROCESSOR_PROFILE_CREATE_INFO = 9,
+    AR_STRUCTURE_TYPE_PHYSICAL_MEMORY_FILE_CREATE_INFO = 10,
 } ArStructureType;
 
+typedef enum ArSchedulingMode
+{
+    AR_SCHEDULING_MODE_LOCKSTEP = 0, //< Every processor executes one bundle in turn
+    AR_SCHEDULING_MODE_QUANTUM = 1,  //< Every processor executes a quantum of bundles in turn
+    AR_SCHEDULING_MODE_PARALLEL = 2, //< Every processor executes a quantum of bundles on its own host thread, then waits for the others
+} ArSchedulingMode;
+
+//Physical addresses of the memories of the memory map, see MemoryMap.txt
+#define AR_PHYSICAL_ADDRESS_IO         (0x0000000000ull) //< I/O, up to 4 GB
+#define AR_PHYSICAL_ADDRESS_SOUND_DRAM (0x0200000000ull) //< Sound DRAM, up to 4 GB
+#define AR_PHYSICAL_ADDRESS_VRAM1      (0x0300000000ull) //< VRAM1, up to 4 GB
+#define AR_PHYSICAL_ADDRESS_VRAM2      (0x1000000000ull) //< VRAM2 of the GPU, up to 64 GB
+#define AR_PHYSICAL_ADDRESS_SSD_RAM    (0x2000000000ull) //< SSD RAM, up to 384 GB
+#define AR_PHYSICAL_ADDRESS_RAM        (0x8000000000ull) //< RAM, up to 512 GB
+
 typedef struct ArVirtualMachineCreateInfo
 {
     ArStructureType sType; //< The type of this structure
@@ -50,10 +77,154 @@ typedef struct ArPhysicalMemoryCreateInfo
 {
     ArStructureType sType; //< The type of this structure
     void* pNext;           //< A pointer to the next structure
-    void* pMemory;         //< A pointer to the memory beginning
+    void* pMemory;         //< A pointer to the memory beginning, may be NULL if an ArPhysicalMemoryMappingCreateInfo is chained
     uint64_t size;         //< The number of bytes of the memory
+    uint64_t address;      //< The physical address of the first byte of the memory, DMA transfers to [address, address + size) reach it
 } ArPhysicalMemoryCreateInfo;
 
+/// \brief Back a physical memory with a host mapping instead of pMemory, chained to ArPhysicalMemoryCreateInfo::pNext
+///
+/// The host only commits the pages the processors touch, so a physical memory may be far larger than the host memory.
+/// The bytes past the end of the file, or all of them without a file, read as 0
+typedef struct ArPhysicalMemoryMappingCreateInfo
+{
+    ArStructureType sType; //< The type of this structure
+    void* pNext;           //< A pointer to the next structure
+    const char* pPath;     //< The file mapped at the beginning of the memory, NULL for an anonymous mapping
+    uint64_t offset;       //< The offset of the mapping in the file, a multiple of the host page size
+    uint32_t shared;       //< 1 if writes go to the file, which grows to offset + size, 0 if they stay private to the memory
+} ArPhysicalMemoryMappingCreateInfo;
+
+/// \brief Preload a range of a physical memory from a file, chained to ArPhysicalMemoryCreateInfo::pNext
+///
+/// Several can be chained, the preloaded bytes are the content of the memory at its creation. A memory privately mapped
+/// by an ArPhysicalMemoryMappingCreateInfo maps the pages of the file over the range, without reading them, when
+/// offset, fileOffset and the address of pMemory are multiples of the host page size. Other memories read the file
+typedef struct ArPhysicalMemoryFileCreateInfo
+{
+    ArStructureType sType; //< The type of this structure
+    void* pNext;           //< A pointer to the next structure
+    const char* pPath;     //< The file to preload
+    uint64_t fileOffset;   //< The offset of the first preloaded byte in the file
+    uint64_t offset;       //< The offset of the range in the memory
+    uint64_t size;         //< The number of bytes of the range, offset + size must not exceed the size of the memory. The bytes past the end of the file are left untouched
+} ArPhysicalMemoryFileCreateInfo;
+
+/// \brief The timing of the DMA engine of a processor, chained to ArProcessorCreateInfo::pNext
+///
+/// Without it every transfer completes in the cycle it is issued
+typedef struct ArProcessorDmaCreateInfo
+{
+    ArStructureType sType; //< The type of this structure
+    void* pNext;           //< A pointer to the next structure
+    uint32_t latency;      //< The number of cycles between the end of a transfer and its completion
+    uint32_t bandwidth;    //< The number of bytes the engine transfers per cycle, 0 for an unlimited bandwidth
+} ArProcessorDmaCreateInfo;
+
+/// \brief Model the cache of a processor as a direct-mapped cache over the physical memory, chained to ArProcessorCreateInfo::pNext
+///
+/// Without it the cache is a 32 KiB scratchpad, and LDC/STC addresses are offsets in it.
+/// With it they are physical addresses: a miss fills the line from the physical memory, after writing back the dirty line it replaces.
+/// DMA transfers do not snoop the cache, arFlushProcessorCache writes the dirty lines back
+typedef struct ArProcessorCacheCreateInfo
+{
+    ArStructureType sType; //< The type of this structure
+    void* pNext;           //< A pointer to the next structure
+    uint32_t lineSize;     //< The number of bytes of a line, a power of two between 16 and 32768
+} ArProcessorCacheCreateInfo;
+
+/// \brief Record the last bundles executed by a processor in a ring buffer, chained to ArProcessorCreateInfo::pNext
+///
+/// A tracing processor interprets the bundles an implementation would otherwise run as compiled code
+typedef struct ArProcessorTraceCreateInfo
+{
+    ArStructureType sType; //< The type of this structure
+    void* pNext;           //< A pointer to the next structure
+    uint32_t entryCount;   //< The number of bundles kept, a power of two
+} ArProcessorTraceCreateInfo;
+
+/// \brief Count the executions of every bundle of a processor, chained to ArProcessorCreateInfo::pNext
+///
+/// A profiling processor interprets the bundles an implementation would otherwise run as compiled code
+typedef struct ArProcessorProfileCreateInfo
+{
+    ArStructureType sType; //< The type of this structure
+    void* pNext;           //< A pointer to the next structure
+} ArProcessorProfileCreateInfo;
+
+typedef struct ArProcessorStatistics
+{
+    ArStructureType sType;        //< The type of this structure
+    void* pNext;                  //< A pointer to the next structure
+    uint64_t cycles;              //< The number of cycles run by the processor, stalls included
+    uint64_t dmaTransfers;        //< The number of issued DMA transfers
+    uint64_t dmaBytes;            //< The number of bytes of the issued DMA transfers
+    uint64_t dmaStallCycles;      //< The number of cycles the processor waited for DMA transfers
+    uint64_t pipelineHazards;     //< The number of bundles which waited for their operands, 0 unless the implementation models the pipeline
+    uint64_t pipelineStallCycles; //< The number of cycles bundles waited for their operands, 0 unless the implementation models the pipeline
+    uint64_t cacheHits;           //< The number of cache line accesses which found their line, 0 unless the processor models its cache
+    uint64_t cacheMisses;         //< The number of cache line accesses which filled their line
+    uint64_t cacheEvictions;      //< The number of valid lines replaced by a fill
+    uint64_t cacheWritebacks;     //< The number of dirty lines written back to the physical memory, by evictions or arFlushProcessorCache
+    uint64_t illegalOpcodes;      //< The number of op-codes of the instruction memory which no slot of a bundle can decode, known as soon as it is written
+} ArProcessorStatistics;
+
+typedef enum ArStallCause
+{
+    AR_STALL_CAUSE_LOAD_USE = 0,   //< A bundle read a register before the LSU load writing it was done
+    AR_STALL_CAUSE_DEPENDENCY = 1, //< A bundle read a register before the ALU, MUL, DIV or FPU operation writing it was done
+    AR_STALL_CAUSE_DIVIDER = 2,    //< A DIV or FDIV waited for the previous one to leave the divider
+    AR_STALL_CAUSE_DMA_WAIT = 3,   //< The processor waited for DMA transfers, after a WAIT or with a full DMA queue
+} ArStallCause;
+
+#define AR_STALL_REGISTER_FLAGS (192u)        //< ArStallRecord::reg of the flags
+#define AR_STALL_REGISTER_ACCUMULATOR (193u)  //< ArStallRecord::reg of the VFPU accumulator
+#define AR_STALL_REGISTER_NONE  (0xFFFFFFFFu) //< ArStallRecord::reg of a stall without register
+
+/// \brief The stall cycles of one bundle for one cause
+typedef struct ArStallRecord
+{
+    uint32_t pc;        //< The program counter of the bundle which waited
+    ArStallCause cause; //< Why it waited
+    uint32_t reg;       //< The register waited for: 0-63 integer registers, 64-191 the floats of the float registers, AR_STALL_REGISTER_FLAGS, AR_STALL_REGISTER_ACCUMULATOR or AR_STALL_REGISTER_NONE
+    uint64_t count;     //< The number of times the bundle waited
+    uint64_t cycles;    //< The number of cycles the bundle waited
+} ArStallRecord;
+
+#define AR_TRACE_REGISTER_NONE (0xFFu) //< ArTraceEntry::registers of an operation which writes no register
+
+/// \brief A bundle executed by a tracing processor, 64 bytes
+typedef struct ArTraceEntry
+{
+    uint64_t cycle;       //< The cycle the bundle was executed at
+    uint16_t pc;          //< The program counter of the bundle
+    uint8_t size;         //< The number of op-codes of the bundle, 2 or 4
+    uint8_t faulted;      //< 1 if the bundle could not be decoded or executed
+    uint8_t registers[4]; //< The register written by each op-code, numbered as ArStallRecord::reg, or AR_TRACE_REGISTER_NONE
+    uint32_t opcodes[4];  //< The op-codes of the bundle, 0 past its size
+    uint64_t values[4];   //< The bits of each written register after the bundle, the first two floats of a vector and of the accumulator
+} ArTraceEntry;
+
+/// \brief The counters of one bundle of a profiling processor
+typedef struct ArProfileRecord
+{
+    uint32_t pc;               //< The program counter of the bundle
+    uint32_t size;             //< The number of op-codes of the bundle when it last ran, 2 or 4
+    uint64_t executions;       //< The number of times the bundle ran
+    uint64_t branchesTaken;    //< The number of times the delayed branch of the bundle was taken
+    uint64_t branchesNotTaken; //< The number of times the delayed branch of the bundle was not taken
+    uint64_t dmaBytes;         //< The number of bytes of the DMA transfers issued by the bundle
+} ArProfileRecord;
+
+typedef struct ArVirtualMachineRunInfo
+{
+    ArStructureType sType;           //< The type of this structure
+    void* pNext;                     //< A pointer to the next structure
+    ArSchedulingMode schedulingMode; //< How processors take turns
+    uint64_t quantum;                //< The number of bundles of a turn, must not be 0 unless schedulingMode is AR_SCHEDULING_MODE_LOCKSTEP
+    uint64_t maxCycles;              //< The maximum number of bundles executed by each processor
+} ArVirtualMachineRunInfo;
+
 #ifndef AR_NO_PROTOTYPES
 
 /** \brief Creates a new virtual machine
@@ -68,6 +239,9 @@ ArResult arCreateVirtualMachine(ArVirtualMachine* pVirtualMachine, const ArVirtu
 
 /** \brief Creates a new processor within a virtual machine
 
+    The whole instruction memory is decoded, the op-codes no bundle can run are counted by
+    ArProcessorStatistics::illegalOpcodes
+
     \param virtualMachine A ArVirtualMachine handle
     \param pInfo A pointer on a valid ArProcessorCreateInfo instance
     \param pProcessor A pointer to a ArProcessor handle
@@ -86,7 +260,10 @@ ArResult arCreateProcessor(ArVirtualMachine virtualMachine, const ArProcessorCre
 
     \return AR_SUCCESS in case of success
             AR_ERROR_HOST_OUT_OF_MEMORY if a host memory allocation failed
-            AR_ERROR_TOO_MANY_OBJECTS if there is already a physical memory instance inside the virtual machine
+            AR_ERROR_PHYSICAL_MEMORY_OVERLAP if the memory overlaps another physical memory of the virtual machine
+            AR_ERROR_PHYSICAL_MEMORY_OUT_OF_RANGE if the memory goes past the end of the physical address space
+            AR_ERROR_HOST_MAPPING_FAILED if the host could not open or map the memory of an ArPhysicalMemoryMappingCreateInfo,
+                                         or open or read the file of an ArPhysicalMemoryFileCreateInfo
 */
 ArResult arCreatePhysicalMemory(ArVirtualMachine virtualMachine, const ArPhysicalMemoryCreateInfo* pInfo, ArPhysicalMemory* pMemory);
 
@@ -111,7 +288,10 @@ ArResult arDecodeInstruction(ArProcessor processor);
 */
 ArResult arExecuteInstruction(ArProcessor processor);
 
-/** \brief Run the instruction on the processor, and update its status
+/** \brief Issue the DMA transfer of the last executed bundle, and complete the transfers which are due
+
+    Transfers are validated when they are issued and their copy happens when they complete. WAIT stalls the processor
+    until every issued transfer has completed.
 
     \param processor A ArProcessor handle
 
@@ -123,6 +303,195 @@ ArResult arExecuteInstruction(ArProcessor processor);
 */
 ArResult arExecuteDirectMemoryAccess(ArProcessor processor);
 
+/** \brief Decode, execute and run the direct memory accesses of bundles until the end of the code or the cycle budget
+
+    Equivalent to calling arDecodeInstruction, arExecuteInstruction and arExecuteDirectMemoryAccess in a loop,
+    without leaving the implementation between two cycles
+
+    \param processor A ArProcessor handle
+    \param maxCycles The maximum number of cycles to run, DMA stalls included
+    \param pExecutedCycles A pointer to the number of cycles run by this call, which counts the bundle that ended the
+                           code or failed, may be NULL
+
+    \return AR_SUCCESS if the cycle budget has been exhausted
+            AR_END_OF_CODE if the processor reached the end of its code
+            AR_ERROR_ILLEGAL_INSTRUCTION if the op-code is illegal, or if the instruction tries to access non-existing physical memory
+            AR_ERROR_MEMORY_OUT_OF_RANGE if the final address + size of processor's SRAM is out of range
+            AR_ERROR_PHYSICAL_MEMORY_OUT_OF_RANGE if the final address + size of machine's physical memory is out of range
+            AR_ERROR_HOST_OUT_OF_MEMORY if a host memory allocation failed
+*/
+ArResult arRunProcessor(ArProcessor processor, uint64_t maxCycles, uint64_t* pExecutedCycles);
+
+/** \brief Get the counters of a processor since its creation
+
+    \param processor A ArProcessor handle
+    \param pStatistics A pointer to an ArProcessorStatistics instance, with a valid sType
+*/
+void arGetProcessorStatistics(ArProcessor processor, ArProcessorStatistics* pStatistics);
+
+/** \brief Get the stall cycles of a processor since its creation, by bundle, cause and register
+
+    Records are sorted by decreasing number of cycles. When pRecords is NULL, the number of records is returned in
+    pRecordCount, otherwise pRecordCount is the capacity of pRecords and is set to the number of records written.
+    Pipeline hazards are only recorded by implementations which model the pipeline.
+
+    \param processor A ArProcessor handle
+    \param pRecordCount A pointer to the number of records
+    \param pRecords A pointer to an array of *pRecordCount ArStallRecord, may be NULL
+
+    \return AR_SUCCESS in case of success
+            AR_ERROR_HOST_OUT_OF_MEMORY if a host memory allocation failed
+*/
+ArResult arGetProcessorStallReport(ArProcessor processor, uint32_t* pRecordCount, ArStallRecord* pRecords);
+
+/** \brief Get the last bundles executed by a processor created with an ArProcessorTraceCreateInfo, oldest first
+
+    When pEntries is NULL, the number of entries recorded is returned in pEntryCount, otherwise pEntryCount is the
+    capacity of pEntries, which receives the most recent entries, and is set to the number of entries written.
+    May be called by another host thread while the processor runs, the entries are then the bundles it had recorded.
+
+    \param processor A ArProcessor handle
+    \param pEntryCount A pointer to the number of entries
+    \param pEntries A pointer to an array of *pEntryCount ArTraceEntry, may be NULL
+*/
+void arGetProcessorTrace(ArProcessor processor, uint32_t* pEntryCount, ArTraceEntry* pEntries);
+
+/** \brief Get the counters of the bundles run by a processor created with an ArProcessorProfileCreateInfo, by increasing pc
+
+    When pRecords is NULL, the number of bundles which ran is returned in pRecordCount, otherwise pRecordCount is the
+    capacity of pRecords and is set to the number of records written.
+
+    \param processor A ArProcessor handle, which must not be running
+    \param pRecordCount A pointer to the number of records
+    \param pRecords A pointer to an array of *pRecordCount ArProfileRecord, may be NULL
+*/
+void arGetProcessorProfile(ArProcessor processor, uint32_t* pRecordCount, ArProfileRecord* pRecords);
+
+/** \brief Write the assembly of the bundle at pc in the instruction memory of a processor, with the decoder of the processor
+
+    The operations are separated by " | ", an op-code which can not be decoded is written as ".word" and its value.
+    The text is truncated to textSize - 1 characters and always null-terminated.
+
+    \param processor A ArProcessor handle, which must not be running
+    \param pc The program counter of the bundle
+    \param size The number of op-codes of the bundle, 2 or 4
+    \param textSize The capacity of pText, at least 1
+    \param pText A pointer to an array of textSize characters
+
+    \return AR_SUCCESS in case of success
+            AR_ERROR_ILLEGAL_INSTRUCTION if an op-code of the bundle is illegal
+            AR_ERROR_MEMORY_OUT_OF_RANGE if the bundle is past the end of the instruction memory
+*/
+ArResult arDisassembleBundle(ArProcessor processor, uint32_t pc, uint32_t size, uint32_t textSize, char* pText);
+
+/** \brief Write the dirty lines of the cache of a processor back to the physical memory, they stay valid
+
+    Does nothing unless the processor was created with an ArProcessorCacheCreateInfo.
+
+    \param processor A ArProcessor handle
+
+    \return AR_SUCCESS in case of success
+            AR_ERROR_PHYSICAL_MEMORY_OUT_OF_RANGE if the physical memory of a dirty line has been destroyed
+*/
+ArResult arFlushProcessorCache(ArProcessor processor);
+
+/** \brief Run every processor of a virtual machine in turn, in their creation order
+
+    A processor halts when it reaches the end of its code, and is skipped by every later turn, including those of
+    later calls. The first error stops the whole virtual machine.
+
+    With AR_SCHEDULING_MODE_PARALLEL the processors only synchronize at the end of each quantum, DMA transfers with the
+    physical memory are atomic and all transfers of a quantum are visible to every processor after it. When several
+    processors fault in the same quantum, the first one in creation order is reported. Hosts without threads fall back
+    to AR_SCHEDULING_MODE_QUANTUM.
+
+    \param virtualMachine A ArVirtualMachine handle
+    \param pInfo A pointer on a valid ArVirtualMachineRunInfo instance
+    \param pFaultingProcessor A pointer to the ArProcessor handle which returned an error, may be NULL
+
+    \return AR_SUCCESS if the cycle budget has been exhausted
+            AR_END_OF_CODE if every processor reached the end of its code
+            AR_ERROR_HOST_OUT_OF_MEMORY if a host thread could not be started
+            Any error returned by arRunProcessor
+*/
+ArResult arRunVirtualMachine(ArVirtualMachine virtualMachine, const ArVirtualMachineRunInfo* pInfo, ArProcessor* pFaultingProcessor);
+
+/** \brief Save the state of a virtual machine: its processors and the pages of its physical memories they wrote
+
+    The state holds every register, SRAM, cache line, in-flight DMA transfer and counter of the processors, and the
+    physical memory pages which may differ from their content at the creation of their memory. Writes of the host to
+    the physical memories are not tracked. When pData is NULL, the size of the state is returned in pDataSize,
+    otherwise pDataSize must hold at least this size and is set to the number of bytes written.
+    The state can only be loaded by the same implementation.
+
+    \param virtualMachine A ArVirtualMachine handle, which must not be running
+    \param pDataSize A pointer to the number of bytes of the state
+    \param pData A pointer to an array of *pDataSize bytes, may be NULL
+
+    \return AR_SUCCESS in case of success
+            AR_ERROR_BUFFER_TOO_SMALL if *pDataSize is smaller than the state, nothing is written and pDataSize is set to its size
+*/
+ArResult arSaveState(ArVirtualMachine virtualMachine, uint64_t* pDataSize, void* pData);
+
+/** \brief Load a state saved by arSaveState into a virtual machine
+
+    The virtual machine must have as many processors, created with the same ArProcessorCacheCreateInfo, and physical
+    memories at the same addresses and of the same sizes as the saved one. Memory pages written since the creation of
+    their memory and not held by the state get back their content at that creation, which is kept for the pages first
+    written once the virtual machine saved or loaded a state. The instruction memories are decoded again and compiled
+    code is discarded.
+
+    \param virtualMachine A ArVirtualMachine handle, which must not be running
+    \param pData A pointer to the state
+    \param dataSize The number of bytes of the state
+
+    \return AR_SUCCESS in case of success, nothing is loaded otherwise
+            AR_ERROR_INVALID_STATE if the state is not a state of this implementation, does not match the virtual machine,
+                                   or misses a page written before the virtual machine saved or loaded a state
+            AR_ERROR_HOST_OUT_OF_MEMORY if a host memory allocation failed
+*/
+ArResult arLoadState(ArVirtualMachine virtualMachine, const void* pData, uint64_t dataSize);
+
+/** \brief Create a virtual machine which starts from the current state of another one
+
+    Each processor is copied, and the fork gets a physical memory at the address of each memory of virtualMachine
+    which shares its content copy-on-write: a page is only copied by the first write of the fork to it. Decoded bundles
+    are kept and compiled code is discarded. The memories of virtualMachine, and of the virtual machine it was forked
+    from if it is a fork, must not be written nor destroyed while the fork exists. Forks can run concurrently on
+    different host threads. The fork objects are destroyed like created ones.
+
+    \param virtualMachine A ArVirtualMachine handle, which must not be running
+    \param pFork A pointer to a ArVirtualMachine handle
+    \param pProcessors A pointer to an array with an element per processor, receiving the processors of the fork in creation order, may be NULL
+    \param pMemories A pointer to an array with an element per physical memory, receiving the memories of the fork by increasing address, may be NULL
+
+    \return AR_SUCCESS in case of success
+            AR_ERROR_HOST_OUT_OF_MEMORY if a host memory allocation failed
+*/
+ArResult arForkVirtualMachine(ArVirtualMachine virtualMachine, ArVirtualMachine* pFork, ArProcessor* pProcessors, ArPhysicalMemory* pMemories);
+
+/** \brief Copy bytes of a physical memory to the host
+
+    The only way to read the memory of a fork, whose content is not at the pointer given to arCreatePhysicalMemory
+
+    \param memory A ArPhysicalMemory handle, whose virtual machine must not be running
+    \param offset The offset of the first byte in the memory
+    \param size The number of bytes, offset + size must not exceed the size of the memory
+    \param pData A pointer to an array of size bytes
+*/
+void arReadPhysicalMemory(ArPhysicalMemory memory, uint64_t offset, uint64_t size, void* pData);
+
+/** \brief Copy bytes of the host to a physical memory
+
+    Unlike direct writes of the host to the memory, the written pages are tracked by the states
+
+    \param memory A ArPhysicalMemory handle, whose virtual machine must not be running
+    \param offset The offset of the first byte in the memory
+    \param size The number of bytes, offset + size must not exceed the size of the memory
+    \param pData A pointer to an array of size bytes
+*/
+void arWritePhysicalMemory(ArPhysicalMemory memory, uint64_t offset, uint64_t size, const void* pData);
+
 /** \brief Destroy a virtual machine
 
     All subobjects must have been freed
@@ -142,6 +511,8 @@ void arDestroyProcessor(ArVirtualMachine virtualMachine, ArProcessor processor);
 
 /** \brief Destroy a physical memory device within a virtual machine
 
+    The DMA transfers of processors still in flight with the memory are completed first, with the transfers issued before them.
+
     Must be called before any call to arDestroyVirtualMachine
 
     \param virtualMachine A ArVirtualMachine handle
@@ -158,6 +529,19 @@ typedef ArResult (*PFN_arCreatePhysicalMemory)(ArVirtualMachine virtualMachine,
 typedef ArResult (*PFN_arDecodeInstruction)(ArProcessor processor);
 typedef ArResult (*PFN_arExecuteInstruction)(ArProcessor processor);
 typedef ArResult (*PFN_arExecuteDirectMemoryAccess)(ArProcessor processor);
+typedef ArResult (*PFN_arRunProcessor)(ArProcessor processor, uint64_t maxCycles, uint64_t* pExecutedCycles);
+typedef void (*PFN_arGetProcessorStatistics)(ArProcessor processor, ArProcessorStatistics* pStatistics);
+typedef ArResult (*PFN_arGetProcessorStallReport)(ArProcessor processor, uint32_t* pRecordCount, ArStallRecord* pRecords);
+typedef void (*PFN_arGetProcessorTrace)(ArProcessor processor, uint32_t* pEntryCount, ArTraceEntry* pEntries);
+typedef void (*PFN_arGetProcessorProfile)(ArProcessor processor, uint32_t* pRecordCount, ArProfileRecord* pRecords);
+typedef ArResult (*PFN_arDisassembleBundle)(ArProcessor processor, uint32_t pc, uint32_t size, uint32_t textSize, char* pText);
+typedef ArResult (*PFN_arFlushProcessorCache)(ArProcessor processor);
+typedef ArResult (*PFN_arRunVirtualMachine)(ArVirtualMachine virtualMachine, const ArVirtualMachineRunInfo* pInfo, ArProcessor* pFaultingProcessor);
+typedef ArResult (*PFN_arSaveState)(ArVirtualMachine virtualMachine, uint64_t* pDataSize, void* pData);
+typedef ArResult (*PFN_arLoadState)(ArVirtualMachine virtualMachine, const void* pData, uint64_t dataSize);
+typedef ArResult (*PFN_arForkVirtualMachine)(ArVirtualMachine virtualMachine, ArVirtualMachine* pFork, ArProcessor* pProcessors, ArPhysicalMemory* pMemories);
+typedef void (*PFN_arReadPhysicalMemory)(ArPhysicalMemory memory, uint64_t offset, uint64_t size, void* pData);
+typedef void (*PFN_arWritePhysicalMemory)(ArPhysicalMemory memory, uint64_t offset, uint64_t size, const void* pData);
 
 typedef void (*PFN_arDestroyVirtualMachine)(ArVirtualMachine virtualMachine);
 typedef void (*PFN_arDestroyProcessor)(ArVirtualMachine virtualMachine, ArProcessor processor);
@@ -0,0 +1,879 @@
+#include <iostream>
+#include <stdexcept>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <algorithm>
+#include <map>
+#include <vector>
+#include <cstdio>
+
+namespace
+{
+
+//Must match isa.c: an encoding selects on bits 0 to 14, looked up as the low byte then bits 8 to 14
+constexpr std::uint32_t select_bits{15};
+constexpr std::uint32_t low_bits{8};
+constexpr std::uint32_t high_bits{select_bits - low_bits};
+constexpr std::uint32_t slot_classes{3}; //slot 0, slot 1, slots 2 and 3
+constexpr std::uint32_t high_table{0x8000};
+
+//The unit of the relative and absolute branch target fields, a bundle of two op-codes. The assembly of both vasm and
+//the disassembler writes targets as byte addresses
+constexpr std::uint32_t target_bytes{8};
+
+constexpr std::string_view field_letters{"abcihlse"};
+constexpr std::string_view register_letters{"rfdv"};
+
+enum class Target
+{
+    none,
+    relative,
+    absolute,
+};
+
+struct Field
+{
+    bool present{};
+    bool constant{}; //the value is bias, no bit of the op-code holds it
+    std::uint32_t high{};
+    std::uint32_t low{};
+    std::uint32_t bias{};
+    Target target{};
+
+    std::uint32_t bits() const
+    {
+        return constant ? 0u : high - low + 1u;
+    }
+
+    std::uint32_t mask() const
+    {
+        return constant ? 0u : static_cast<std::uint32_t>((std::uint64_t{1} << bits()) - 1u);
+    }
+};
+
+enum class OperandKind
+{
+    reg,
+    decimal,
+    hexadecimal,
+    memory,
+};
+
+struct Operand
+{
+    OperandKind kind{};
+    char prefix{}; //r, f, d or v for registers
+    char value{};  //the field of the register or immediate
+    char base{};   //the field of the base register of memory operands
+    bool increment{};
+};
+
+struct Encoding
+{
+    std::size_t line{};
+    std::string unit{}; //the comment opening the unit, if this encoding is the first of it
+    std::string op{};
+    std::uint32_t slots{};
+    std::uint32_t match{};
+    std::uint32_t mask{};
+    std::map<char, Field> fields{};
+    std::string assembly{};
+    std::string mnemonic{};
+    char qualifier{}; //s, v, n, e or 0
+    std::vector<Operand> operands{};
+    std::vector<Encoding> aliases{}; //other syntaxes vasm accepts for the encoding, the fields they do not write are 0
+
+    const Field& field(char letter) const
+    {
+        static const Field absent{};
+        const auto it{fields.find(letter)};
+        return it != std::end(fields) ? it->second : absent;
+    }
+};
+
+struct Description
+{
+    std::vector<Encoding> encodings{};
+    std::vector<std::string> ops{}; //in order of first appearance, the Opcode enum
+};
+
+[[noreturn]] void fail(const std::filesystem::path& path, std::size_t line, const std::string& message)
+{
+    throw std::runtime_error{path.string() + ":" + std::to_string(line) + ": " + message};
+}
+
+std::uint32_t parse_number(const std::string& text, int base, const std::filesystem::path& path, std::size_t line)
+{
+    std::size_t end{};
+    unsigned long value{};
+
+    try
+    {
+        value = std::stoul(text, &end, base);
+    }
+    catch(const std::exception&)
+    {
+        end = 0;
+    }
+
+    if(text.empty() || end != std::size(text))
+    {
+        fail(path, line, "\"" + text + "\" is not a number.");
+    }
+
+    return static_cast<std::uint32_t>(value);
+}
+
+//<letter>=<high>:<low>[+bias][:relative|:absolute] or <letter>=#<constant>
+void parse_field(const std::string& token, Encoding& encoding, const std::filesystem::path& path)
+{
+    if(std::size(token) < 3 || token[1] != '=' || field_letters.find(token[0]) == std::string_view::npos)
+    {
+        fail(path, encoding.line, "Malformed field \"" + token + "\".");
+    }
+
+    Field& field{encoding.fields[token[0]]};
+    if(field.present)
+    {
+        fail(path, encoding.line, std::string{"Field "} + token[0] + " is defined twice.");
+    }
+
+    field.present = true;
+
+    const std::string value{token.substr(2)};
+    if(value[0] == '#')
+    {
+        field.constant = true;
+        field.bias = parse_number(value.substr(1), 10, path, encoding.line);
+        return;
+    }
+
+    std::vector<std::string> parts{};
+    std::istringstream iss{value};
+    for(std::string part; std::getline(iss, part, ':');)
+    {
+        parts.push_back(part);
+    }
+
+    if(std::size(parts) < 2 || std::size(parts) > 3)
+    {
+        fail(path, encoding.line, "Malformed field \"" + token + "\".");
+    }
+
+    const auto plus{parts[1].find('+')};
+    if(plus != std::string::npos)
+    {
+        field.bias = parse_number(parts[1].substr(plus + 1), 10, path, encoding.line);
+        parts[1].resize(plus);
+    }
+
+    field.high = parse_number(parts[0], 10, path, encoding.line);
+    field.low = parse_number(parts[1], 10, path, encoding.line);
+
+    if(field.high > 31 || field.low > field.high)
+    {
+        fail(path, encoding.line, "Field \"" + token + "\" is out of the op-code.");
+    }
+
+    if(std::size(parts) == 3)
+    {
+        if(token[0] != 'i' || (parts[2] != "relative" && parts[2] != "absolute"))
+        {
+            fail(path, encoding.line, "Only i may be a relative or absolute target.");
+        }
+
+        field.target = parts[2] == "relative" ? Target::relative : Target::absolute;
+    }
+}
+
+bool is_field(const Encoding& encoding, char letter)
+{
+    return letter && field_letters.find(letter) != std::string_view::npos && encoding.field(letter).present;
+}
+
+//mnemonic[.qualifier] [operand[,operand...]]
+void parse_assembly(Encoding& encoding, const std::filesystem::path& path)
+{
+    const std::string& text{encoding.assembly};
+
+    std::size_t i{};
+    while(i < std::size(text) && text[i] != '.' && text[i] != ' ')
+    {
+        encoding.mnemonic += text[i++];
+    }
+
+    if(encoding.mnemonic.empty())
+    {
+        fail(path, encoding.line, "The assembly has no mnemonic.");
+    }
+
+    if(i < std::size(text) && text[i] == '.')
+    {
+        encoding.qualifier = i + 1 < std::size(text) ? text[i + 1] : '\0';
+        i += 2;
+
+        const bool valid{std::string_view{"svne"}.find(encoding.qualifier) != std::string_view::npos && encoding.qualifier &&
+                         is_field(encoding, encoding.qualifier == 'e' ? 'e' : 's') &&
+                         !encoding.field(encoding.qualifier == 'e' ? 'e' : 's').constant};
+        if(!valid || (i < std::size(text) && text[i] != ' '))
+        {
+            fail(path, encoding.line, "Unknown qualifier in \"" + text + "\".");
+        }
+    }
+
+    if(i >= std::size(text))
+    {
+        return;
+    }
+
+    std::istringstream iss{text.substr(i + 1)};
+    for(std::string token; std::getline(iss, token, ',');)
+    {
+        Operand operand{};
+        bool valid{};
+
+        if(std::size(token) == 2 && register_letters.find(token[0]) != std::string_view::npos)
+        {
+            operand = {OperandKind::reg, token[0], token[1]};
+            valid = is_field(encoding, token[1]);
+        }
+        else if(std::size(token) == 1)
+        {
+            operand = {OperandKind::decimal, '\0', token[0]};
+            valid = is_field(encoding, token[0]);
+        }
+        else if(std::size(token) == 2 && token[0] == '$')
+        {
+            operand = {OperandKind::hexadecimal, '\0', token[1]};
+            valid = is_field(encoding, token[1]);
+        }
+        else if(std::size(token) >= 6 && token[0] == '$' && token.compare(2, 2, "[r") == 0 && (token.substr(5) == "]" || token.substr(5) == "+]"))
+        {
+            operand = {OperandKind::memory, 'r', token[1], token[4], token[5] == '+'};
+            valid = is_field(encoding, token[1]) && is_field(encoding, token[4]) &&
+                    (!operand.increment || (is_field(encoding, 'e') && !encoding.field('e').constant));
+        }
+
+        if(!valid || encoding.field(operand.value).constant)
+        {
+            fail(path, encoding.line, "Malformed operand \"" + token + "\".");
+        }
+
+        encoding.operands.push_back(operand);
+    }
+
+    if(std::size(encoding.operands) > 3)
+    {
+        fail(path, encoding.line, "An operation has at most 3 operands.");
+    }
+}
+
+Encoding parse_encoding(const std::string& text, std::size_t line, const std::filesystem::path& path)
+{
+    Encoding encoding{};
+    encoding.line = line;
+
+    const auto separator{text.find(" : ")};
+    if(separator == std::string::npos)
+    {
+        fail(path, line, "Expected \"<opcode> <slots> <match>/<mask> [fields...] : <assembly>\".");
+    }
+
+    encoding.assembly = text.substr(separator + 3);
+    encoding.assembly.erase(0, encoding.assembly.find_first_not_of(' '));
+    encoding.assembly.erase(encoding.assembly.find_last_not_of(" \t\r") + 1);
+
+    std::istringstream iss{text.substr(0, separator)};
+    std::string slots{};
+    std::string selection{};
+    iss >> encoding.op >> slots >> selection;
+
+    for(const char c : slots)
+    {
+        if(c < '0' || c > '2')
+        {
+            fail(path, line, "Slots are 0, 1 and 2.");
+        }
+
+        encoding.slots |= 1u << (c - '0');
+    }
+
+    const auto slash{selection.find('/')};
+    if(encoding.slots == 0 || slash == std::string::npos)
+    {
+        fail(path, line, "Expected \"<opcode> <slots> <match>/<mask>\".");
+    }
+
+    encoding.match = parse_number(selection.substr(0, slash), 16, path, line);
+    encoding.mask = parse_number(selection.substr(slash + 1), 16, path, line);
+
+    if(encoding.mask >= (1u << select_bits) || (encoding.match & ~encoding.mask))
+    {
+        fail(path, line, "The match must be within the mask, below bit " + std::to_string(select_bits) + ".");
+    }
+
+    for(std::string token; iss >> token;)
+    {
+        parse_field(token, encoding, path);
+    }
+
+    //h and l are the high and low parts of i, written as two addresses
+    const Field& high{encoding.field('h')};
+    const Field& low{encoding.field('l')};
+    if(high.present || low.present)
+    {
+        if(!high.present || !low.present || encoding.field('i').present || high.constant || low.constant ||
+           low.bits() != 12 || high.low != low.high + 1)
+        {
+            fail(path, line, "h and l must be contiguous, l holding the 12 low bits of i.");
+        }
+
+        encoding.fields['i'] = {true, false, high.high, low.low};
+    }
+
+    for(const char letter : std::string_view{"abc"})
+    {
+        if(encoding.field(letter).constant)
+        {
+            fail(path, line, std::string{"Operand "} + letter + " can not be a constant.");
+        }
+    }
+
+    parse_assembly(encoding, path);
+
+    return encoding;
+}
+
+Description read_description(const std::filesystem::path& path)
+{
+    std::ifstream ifs{path};
+    if(!ifs)
+    {
+        throw std::runtime_error{"Can not find file \"" + path.string() + "\"."};
+    }
+
+    Description description{};
+    std::string unit{};
+    std::size_t line{};
+
+    for(std::string text; std::getline(ifs, text);)
+    {
+        ++line;
+
+        if(text.empty() || text.find_first_not_of(" \t\r") == std::string::npos)
+        {
+            continue;
+        }
+
+        //"= : <assembly>" is an alias of the encoding above, only known to vasm
+        if(text[0] == '=')
+        {
+            const auto separator{text.find(" : ")};
+            if(separator == std::string::npos || text.find_first_not_of(' ', 1) != separator + 1)
+            {
+                fail(path, line, "Expected \"= : <assembly>\".");
+            }
+
+            if(description.encodings.empty())
+            {
+                fail(path, line, "An alias must follow the encoding it writes.");
+            }
+
+            Encoding alias{description.encodings.back()};
+            alias.line = line;
+            alias.unit.clear();
+            alias.aliases.clear();
+            alias.assembly = text.substr(separator + 3);
+            alias.assembly.erase(0, alias.assembly.find_first_not_of(' '));
+            alias.assembly.erase(alias.assembly.find_last_not_of(" \t\r") + 1);
+            alias.mnemonic.clear();
+            alias.qualifier = '\0';
+            alias.operands.clear();
+
+            parse_assembly(alias, path);
+            description.encodings.back().aliases.push_back(std::move(alias));
+            continue;
+        }
+
+        if(text[0] == '#')
+        {
+            //"#UNIT" opens a unit, other comments start with "# "
+            if(std::size(text) > 1 && text[1] != ' ')
+            {
+                unit = text.substr(1);
+            }
+
+            continue;
+        }
+
+        Encoding encoding{parse_encoding(text, line, path)};
+
+        const auto known{std::find(std::begin(description.ops), std::end(description.ops), encoding.op)};
+        if(known == std::end(description.ops))
+        {
+            encoding.unit = std::move(unit);
+            unit.clear();
+            description.ops.push_back(encoding.op);
+        }
+        else if(description.encodings.back().op != encoding.op)
+        {
+            fail(path, line, "The encodings of " + encoding.op + " must be consecutive.");
+        }
+
+        description.encodings.push_back(std::move(encoding));
+    }
+
+    const auto& encodings{description.encodings};
+    if(std::size(encodings) >= 255)
+    {
+        throw std::runtime_error{"Too many encodings for the 8-bit high tables."};
+    }
+
+    for(std::size_t i{}; i < std::size(encodings); ++i)
+    {
+        for(std::size_t j{}; j < i; ++j)
+        {
+            const Encoding& a{encodings[i]};
+            const Encoding& b{encodings[j]};
+
+            if((a.slots & b.slots) && ((a.match ^ b.match) & a.mask & b.mask) == 0)
+            {
+                fail(path, a.line, "Selects the same op-codes as line " + std::to_string(b.line) + ".");
+            }
+
+            //the disassembler finds the encoding of an operation by its op and data
+            if(a.op == b.op && (!a.field('e').constant || !b.field('e').constant || a.field('e').bias == b.field('e').bias))
+            {
+                fail(path, a.line, "The encodings of " + a.op + " must differ by a constant e.");
+            }
+        }
+    }
+
+    return description;
+}
+
+std::ofstream open_output(const std::filesystem::path& path)
+{
+    std::ofstream ofs{path};
+    if(!ofs)
+    {
+        throw std::runtime_error{"Can not write file \"" + path.string() + "\"."};
+    }
+
+    return ofs;
+}
+
+std::string hexadecimal(std::uint32_t value, int digits)
+{
+    char text[16];
+    std::snprintf(text, sizeof(text), "0x%0*X", digits, static_cast<unsigned>(value));
+    return text;
+}
+
+void write_opcodes(const Description& description, const std::filesystem::path& input, const std::filesystem::path& path)
+{
+    auto ofs{open_output(path)};
+
+    ofs << "//Generated by altair_isa_generator from " << input.filename().string() << ", do not edit\n\n"
+        << "#ifndef ALTAIR_ISA_OPCODES_H_DEFINED\n"
+        << "#define ALTAIR_ISA_OPCODES_H_DEFINED\n\n"
+        << "typedef enum Opcode\n{\n"
+        << "    OPCODE_UNKNOWN,\n";
+
+    for(const Encoding& encoding : description.encodings)
+    {
+        if(!encoding.unit.empty())
+        {
+            ofs << "\n    //" << encoding.unit << '\n';
+        }
+
+        if(&encoding == &description.encodings.front() || (&encoding - 1)->op != encoding.op)
+        {
+            ofs << "    OPCODE_" << encoding.op << ",\n";
+        }
+    }
+
+    ofs << "} Opcode;\n\n#endif\n";
+}
+
+std::string c_field(const Field& field)
+{
+    if(!field.present)
+    {
+        return "{0, 0, 0}";
+    }
+
+    return "{" + std::to_string(field.constant ? 0u : field.low) + ", " + std::to_string(field.bias) + ", " + hexadecimal(field.mask(), 2) + "}";
+}
+
+std::string c_format(const Encoding& encoding)
+{
+    const Target target{encoding.field('i').target};
+
+    return "{{" + c_field(encoding.field('a')) + ", " + c_field(encoding.field('b')) + ", " + c_field(encoding.field('c')) + "}, " +
+           c_field(encoding.field('i')) + ", " + c_field(encoding.field('s')) + ", " + c_field(encoding.field('e')) + ", " +
+           (target == Target::relative ? "TARGET_RELATIVE" : target == Target::absolute ? "TARGET_ABSOLUTE" : "TARGET_NONE") + "}";
+}
+
+//The entry of the encoding an op-code selects in a slot class, 0 if none
+std::uint32_t find_encoding(const Description& description, std::uint32_t slot, std::uint32_t opcode)
+{
+    for(std::size_t i{}; i < std::size(description.encodings); ++i)
+    {
+        const Encoding& encoding{description.encodings[i]};
+        if((encoding.slots & (1u << slot)) && (opcode & encoding.mask) == encoding.match)
+        {
+            return static_cast<std::uint32_t>(i + 1);
+        }
+    }
+
+    return 0;
+}
+
+void write_tables(const Description& description, const std::filesystem::path& input, const std::filesystem::path& path)
+{
+    const auto& encodings{description.encodings};
+
+    std::vector<std::string> formats{"{{{0, 0, 0}}}"};
+    std::vector<std::size_t> encoding_formats{};
+    for(const Encoding& encoding : encodings)
+    {
+        std::string format{c_format(encoding)};
+        if(format == c_format(Encoding{}))
+        {
+            format = formats[0];
+        }
+
+        const auto it{std::find(std::begin(formats), std::end(formats), format)};
+        encoding_formats.push_back(static_cast<std::size_t>(it - std::begin(formats)));
+        if(it == std::end(formats))
+        {
+            formats.push_back(std::move(format));
+        }
+    }
+
+    //A low table entry selects an encoding, or a high table when one of the encodings sharing the low byte selects on more bits
+    constexpr std::uint32_t low_mask{(1u << low_bits) - 1u};
+    std::vector<std::vector<std::uint32_t>> low_tables(slot_classes, std::vector<std::uint32_t>(1u << low_bits));
+    std::vector<std::vector<std::uint32_t>> high_tables{};
+
+    for(std::uint32_t slot{}; slot < slot_classes; ++slot)
+    {
+        for(std::uint32_t low{}; low <= low_mask; ++low)
+        {
+            const bool high{std::any_of(std::begin(encodings), std::end(encodings), [&](const Encoding& encoding)
+            {
+                return (encoding.slots & (1u << slot)) && (low & encoding.mask & low_mask) == (encoding.match & low_mask) && (encoding.mask & ~low_mask);
+            })};
+
+            if(!high)
+            {
+                low_tables[slot][low] = find_encoding(description, slot, low);
+                continue;
+            }
+
+            std::vector<std::uint32_t> table(1u << high_bits);
+            for(std::uint32_t bits{}; bits < std::size(table); ++bits)
+            {
+                table[bits] = find_encoding(description, slot, (bits << low_bits) | low);
+            }
+
+            const auto it{std::find(std::begin(high_tables), std::end(high_tables), table)};
+            low_tables[slot][low] = high_table | static_cast<std::uint32_t>(it - std::begin(high_tables));
+            if(it == std::end(high_tables))
+            {
+                high_tables.push_back(std::move(table));
+            }
+        }
+    }
+
+    auto ofs{open_output(path)};
+
+    ofs << "//Generated by altair_isa_generator from " << input.filename().string() << ", do not edit\n\n";
+
+    ofs << "#define TARGET_BYTES " << target_bytes << "u //< the unit of the branch target fields\n\n";
+
+    ofs << "static const Format formats[] =\n{\n";
+    for(const std::string& format : formats)
+    {
+        ofs << "    " << format << ",\n";
+    }
+    ofs << "};\n\n";
+
+    ofs << "static const Encoding encodings[] =\n{\n"
+        << "    {OPCODE_UNKNOWN, 0},\n";
+    for(std::size_t i{}; i < std::size(encodings); ++i)
+    {
+        ofs << "    {OPCODE_" << encodings[i].op << ", " << encoding_formats[i] << "},\n";
+    }
+    ofs << "};\n\n";
+
+    ofs << "static const char* const assemblies[] =\n{\n"
+        << "    \"???\",\n";
+    for(const Encoding& encoding : encodings)
+    {
+        ofs << "    \"" << encoding.assembly << "\",\n";
+    }
+    ofs << "};\n\n";
+
+    ofs << "static const OpcodeEncodings opcodeEncodings[] =\n{\n"
+        << "    {0, 1}, //OPCODE_UNKNOWN\n";
+    for(const std::string& op : description.ops)
+    {
+        const auto first{std::find_if(std::begin(encodings), std::end(encodings), [&](const Encoding& encoding) { return encoding.op == op; })};
+        const auto count{std::count_if(std::begin(encodings), std::end(encodings), [&](const Encoding& encoding) { return encoding.op == op; })};
+        ofs << "    {" << (first - std::begin(encodings)) + 1 << ", " << count << "}, //OPCODE_" << op << '\n';
+    }
+    ofs << "};\n\n";
+
+    ofs << "static const uint16_t lowTables[SLOT_CLASSES][1u << LOW_BITS] =\n{\n";
+    for(const auto& table : low_tables)
+    {
+        ofs << "    {";
+        for(std::size_t i{}; i < std::size(table); ++i)
+        {
+            ofs << (i % 16 ? " " : "\n        ") << hexadecimal(table[i], 4) << ',';
+        }
+        ofs << "\n    },\n";
+    }
+    ofs << "};\n\n";
+
+    ofs << "static const uint8_t highTables[][1u << HIGH_BITS] =\n{\n";
+    for(const auto& table : high_tables)
+    {
+        ofs << "    {";
+        for(std::size_t i{}; i < std::size(table); ++i)
+        {
+            ofs << (i % 16 ? " " : "\n        ") << hexadecimal(table[i], 2) << ',';
+        }
+        ofs << "\n    },\n";
+    }
+    ofs << "};\n";
+}
+
+std::string vasm_field(const Field& field)
+{
+    if(!field.present || field.constant)
+    {
+        return "{0,0,0}";
+    }
+
+    return "{" + std::to_string(field.low) + "," + std::to_string(field.bits()) + "," + std::to_string(field.bias) + "}";
+}
+
+//The entry of mnemonics[] in vasm of an encoding
+std::string vasm_mnemonic(const Encoding& encoding)
+{
+    std::string types{};
+    std::string values{};
+    std::string bases{};
+    std::string increment{vasm_field({})};
+
+    for(std::size_t i{}; i < 3; ++i)
+    {
+        const Operand* const operand{i < std::size(encoding.operands) ? &encoding.operands[i] : nullptr};
+        if(operand && operand->kind == OperandKind::reg)
+        {
+            types += operand->prefix == 'r' ? "OP_REG" : operand->prefix == 'f' ? "OP_VF " : operand->prefix == 'd' ? "OP_VD " : "OP_VT ";
+        }
+        else if(operand)
+        {
+            types += operand->kind == OperandKind::memory ? "OP_IMR" : "OP_IMM";
+        }
+
+        types += operand && i < 2 ? "," : "";
+        values += std::string{i ? "," : ""} + vasm_field(operand ? encoding.field(operand->value) : Field{});
+        bases += std::string{i ? "," : ""} + vasm_field(operand && operand->base ? encoding.field(operand->base) : Field{});
+
+        if(operand && operand->increment)
+        {
+            increment = vasm_field(encoding.field('e'));
+        }
+    }
+
+    const char* qualifier{"K1_QUALIFIER_NONE "};
+    switch(encoding.qualifier)
+    {
+        case 's': qualifier = "K1_QUALIFIER_SIZE "; break;
+        case 'v': qualifier = "K1_QUALIFIER_LANES"; break;
+        case 'n': qualifier = "K1_QUALIFIER_BYTES"; break;
+        case 'e': qualifier = "K1_QUALIFIER_END  "; break;
+        default: break;
+    }
+
+    const Target target{encoding.field('i').target};
+    const char* const target_name{target == Target::relative ? "K1_TARGET_RELATIVE" : target == Target::absolute ? "K1_TARGET_ABSOLUTE" : "K1_TARGET_NONE"};
+
+    types.resize(20, ' ');
+
+    char name[16];
+    std::snprintf(name, sizeof(name), "\"%s\",", encoding.mnemonic.c_str());
+
+    char line[512];
+    std::snprintf(line, sizeof(line), "  %-13s{%s},{K1,%s,%s,%s,{%s},{%s},%s,%s},\n", name, types.c_str(), hexadecimal(encoding.match, 4).c_str(),
+                  qualifier, vasm_field(encoding.field(encoding.qualifier == 'e' ? 'e' : 's')).c_str(), values.c_str(), bases.c_str(),
+                  increment.c_str(), target_name);
+
+    return line;
+}
+
+void write_vasm(const Description& description, const std::filesystem::path& input, const std::filesystem::path& path)
+{
+    auto ofs{open_output(path)};
+
+    ofs << "  /* generated by altair_isa_generator from " << input.filename().string() << ", do not edit */\n\n"
+        << "#define K1_TARGET_BYTES " << target_bytes << " /* the unit of the branch target fields */\n";
+
+    for(const Encoding& encoding : description.encodings)
+    {
+        if(!encoding.unit.empty())
+        {
+            ofs << "\n  //" << encoding.unit << '\n';
+        }
+
+        ofs << vasm_mnemonic(encoding);
+
+        for(const Encoding& alias : encoding.aliases)
+        {
+            ofs << vasm_mnemonic(alias);
+        }
+    }
+}
+
+}
+
+//An operation of an encoding in vasm syntax, its fields taken from the bits of pattern, at the byte address address
+std::string test_operation(const Encoding& encoding, std::uint32_t pattern, std::uint32_t address)
+{
+    static const char* const sizes[]{"b", "w", "l", "q"};
+    static const char* const lanes[]{"x", "xy", "xyz", "xyzw"};
+
+    const auto value{[&](char letter)
+    {
+        const Field& field{encoding.field(letter)};
+        return field.constant ? field.bias : ((pattern >> field.low) & field.mask()) + field.bias;
+    }};
+
+    std::string text{encoding.mnemonic};
+    switch(encoding.qualifier)
+    {
+        case 's': text += std::string{"."} + sizes[value('s') & 3u]; break;
+        case 'v': text += std::string{"."} + lanes[value('s') & 3u]; break;
+        case 'n': text += "." + std::to_string((value('s') + 1u) * 32u); break;
+        case 'e': text += value('e') ? ".e" : ""; break;
+        default: break;
+    }
+
+    for(std::size_t i{}; i < std::size(encoding.operands); ++i)
+    {
+        const Operand& operand{encoding.operands[i]};
+        const Field& field{encoding.field(operand.value)};
+        std::uint32_t immediate{value(operand.value)};
+
+        if(field.target == Target::relative)
+        {
+            const std::uint32_t sign{1u << (field.bits() - 1u)};
+            immediate = address + ((immediate ^ sign) - sign) * target_bytes;
+        }
+        else if(field.target == Target::absolute)
+        {
+            immediate *= target_bytes;
+        }
+
+        char operand_text[64];
+        switch(operand.kind)
+        {
+            case OperandKind::reg:
+                //vasm knows v0 to v31 and f0 to f127, some fields of vector registers are wider
+                immediate &= operand.prefix == 'v' ? 31u : operand.prefix == 'f' ? 127u : 63u;
+                std::snprintf(operand_text, sizeof(operand_text), "%c%u", operand.prefix, static_cast<unsigned>(immediate));
+                break;
+
+            case OperandKind::decimal:
+                std::snprintf(operand_text, sizeof(operand_text), "%u", static_cast<unsigned>(immediate));
+                break;
+
+            case OperandKind::hexadecimal:
+                std::snprintf(operand_text, sizeof(operand_text), "$%X", static_cast<unsigned>(immediate));
+                break;
+
+            case OperandKind::memory:
+                std::snprintf(operand_text, sizeof(operand_text), "$%X[r%u%s]", static_cast<unsigned>(immediate), static_cast<unsigned>(value(operand.base)),
+                              operand.increment && value('e') ? "+" : "");
+                break;
+        }
+
+        text += (i ? "," : " ") + std::string{operand_text};
+    }
+
+    return text;
+}
+
+//A vasm program of every encoding and alias, twice with different fields, each in a bundle of two op-codes whose other
+//slot is a nop. It starts with a bundle of nops so that relative targets stay positive
+void write_test(const Description& description, const std::filesystem::path& input, const std::filesystem::path& path)
+{
+    auto ofs{open_output(path)};
+
+    ofs << "; generated by altair_isa_generator from " << input.filename().string() << ", do not edit\n\n"
+        << "\tnop\n\tnop\n";
+
+    std::uint32_t address{target_bytes};
+    for(const Encoding& encoding : description.encodings)
+    {
+        std::vector<const Encoding*> syntaxes{&encoding};
+        for(const Encoding& alias : encoding.aliases)
+        {
+            syntaxes.push_back(&alias);
+        }
+
+        for(const Encoding* const syntax : syntaxes)
+        {
+            for(const std::uint32_t pattern : {0xFFFFFFFFu, 0x55555555u})
+            {
+                const std::string operation{test_operation(*syntax, pattern, address)};
+
+                ofs << '\t' << (encoding.slots & 1u ? operation : "nop") << "\n\t" << (encoding.slots & 1u ? "nop" : operation) << '\n';
+                address += target_bytes;
+            }
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        const std::string_view mode{argc > 1 ? argv[1] : ""};
+
+        if(mode == "-vm" && argc == 5)
+        {
+            const Description description{read_description(argv[2])};
+            write_opcodes(description, argv[2], argv[3]);
+            write_tables(description, argv[2], argv[4]);
+        }
+        else if(mode == "-vasm" && argc == 4)
+        {
+            write_vasm(read_description(argv[2]), argv[2], argv[3]);
+        }
+        else if(mode == "-test" && argc == 4)
+        {
+            write_test(read_description(argv[2]), argv[2], argv[3]);
+        }
+        else
+        {
+            throw std::runtime_error{"Usage: altair_isa_generator -vm [isa] [opcodes_header] [tables]\n"
+                                     "       altair_isa_generator -vasm [isa] [vasm_opcodes_header]\n"
+                                     "       altair_isa_generator -test [isa] [vasm_program]"};
+        }
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+
+        return 1;
+    }
+}
@@ -0,0 +1,280 @@
+#include "isa.h"
+
+#include <assert.h>
+#include <stdio.h>
+
+/// \brief A field of an opcode, ((opcode >> shift) & mask) + bias, a constant when mask is 0
+typedef struct Field
+{
+    uint8_t shift;
+    uint8_t bias;
+    uint32_t mask;
+} Field;
+
+typedef enum Target
+{
+    TARGET_NONE,     //< imm is the field as is
+    TARGET_RELATIVE, //< imm is a signed offset in TARGET_BYTES from the program counter
+    TARGET_ABSOLUTE, //< imm is an address in TARGET_BYTES
+} Target;
+
+/// \brief Where an operation keeps its operands in its opcode
+typedef struct Format
+{
+    Field operands[MAX_OPERANDS];
+    Field imm;
+    Field size;
+    Field data;
+    uint8_t target; //< Target
+} Format;
+
+/// \brief An operation as written in ISA/K1.isa, its assembly column is in assemblies, the template of the disassembler
+typedef struct Encoding
+{
+    uint8_t op; //< Opcode
+    uint8_t format; //< index in formats
+} Encoding;
+
+/// \brief The encodings of an Opcode, consecutive, which differ by their constant data when there are several
+typedef struct OpcodeEncodings
+{
+    uint8_t first;
+    uint8_t count;
+} OpcodeEncodings;
+
+//An opcode is decoded with two lookups: its low byte, then for the encodings which select on more bits, bits 8 to 14
+#define SELECT_BITS 15u
+#define LOW_BITS 8u
+#define HIGH_BITS (SELECT_BITS - LOW_BITS)
+#define HIGH_TABLE 0x8000u //< the entry is the index of a high table rather than of an encoding
+#define SLOT_CLASSES 3u //< slot 0, slot 1, slots 2 and 3
+#define OPCODE_BYTES 4u //< the program counter counts op-codes, the assembly byte addresses
+
+//formats, encodings and assemblies (index 0 is the illegal encoding), opcodeEncodings, lowTables and highTables
+#include "isa_tables.inl"
+
+static uint32_t slotClass(uint32_t index)
+{
+    return index < 2 ? index : 2u;
+}
+
+static uint32_t extractField(const Field* field, uint32_t opcode)
+{
+    return ((opcode >> field->shift) & field->mask) + field->bias;
+}
+
+static int32_t extend_sign(uint32_t value, uint32_t mask)
+{
+    if(value > (mask >> 1) + 1u)
+    {
+        return (int32_t)(~mask | value);
+    }
+    else
+    {
+        return (int32_t)value;
+    }
+}
+
+int isaDecodeOperation(uint32_t index, uint32_t pc, uint32_t opcode, Operation* output)
+{
+    uint32_t entry = lowTables[slotClass(index)][opcode & ((1u << LOW_BITS) - 1u)];
+    if(entry & HIGH_TABLE)
+    {
+        entry = highTables[entry & ~HIGH_TABLE][(opcode >> LOW_BITS) & ((1u << HIGH_BITS) - 1u)];
+    }
+
+    const Encoding* const encoding = &encodings[entry];
+    const Format* const format = &formats[encoding->format];
+
+    output->op = encoding->op;
+    output->size = (uint8_t)extractField(&format->size, opcode);
+    output->data = (uint8_t)extractField(&format->data, opcode);
+
+    for(uint32_t i = 0; i < MAX_OPERANDS; ++i)
+    {
+        output->operands[i] = (uint8_t)extractField(&format->operands[i], opcode);
+    }
+
+    const uint32_t imm = extractField(&format->imm, opcode);
+    if(format->target == TARGET_RELATIVE)
+    {
+        output->imm = pc + extend_sign(imm, format->imm.mask) * (int32_t)(TARGET_BYTES / OPCODE_BYTES);
+    }
+    else if(format->target == TARGET_ABSOLUTE)
+    {
+        output->imm = imm * (TARGET_BYTES / OPCODE_BYTES);
+    }
+    else
+    {
+        output->imm = imm;
+    }
+
+    return entry != 0;
+}
+
+static const char sizeSuffixes[4] = {'b', 'w', 'l', 'q'};
+static const char* const laneSuffixes[4] = {"x", "xy", "xyz", "xyzw"};
+
+static uint32_t findEncoding(const Operation* op)
+{
+    const OpcodeEncodings* const range = &opcodeEncodings[op->op < sizeof(opcodeEncodings) / sizeof(opcodeEncodings[0]) ? op->op : OPCODE_UNKNOWN];
+
+    //ITOFV and FTOIV have an encoding per count of fractional bits
+    for(uint32_t i = range->first; i < range->first + range->count; ++i)
+    {
+        if(range->count == 1 || formats[encodings[i].format].data.bias == op->data)
+        {
+            return i;
+        }
+    }
+
+    return range->first;
+}
+
+static uint32_t fieldValue(const Operation* op, const Format* format, char field)
+{
+    switch(field)
+    {
+        case 'a': return op->operands[0];
+        case 'b': return op->operands[1];
+        case 'c': return op->operands[2];
+        case 'h': return op->imm >> 12u;
+        case 'l': return op->imm & 0x0FFFu;
+        case 's': return op->size;
+        case 'e': return op->data;
+        default:  return format->target != TARGET_NONE ? op->imm * OPCODE_BYTES : op->imm;
+    }
+}
+
+int isaDisassembleOperation(const Operation* op, char* text, size_t capacity)
+{
+    //The template is checked by the generator: mnemonic[.qualifier] then operands of registers rX fX dX vX,
+    //immediates X and $X, and memory $X[rY+] where + is written when data is set
+    const uint32_t encoding = findEncoding(op);
+    const Format* const format = &formats[encodings[encoding].format];
+    const char* assembly = assemblies[encoding];
+
+    char buffer[96];
+    size_t length = 0;
+
+    //snprintf returns the untruncated length, the text is cut at the end of the buffer
+#define APPEND(...) \
+    do \
+    { \
+        length += (size_t)snprintf(buffer + length, sizeof(buffer) - length, __VA_ARGS__); \
+        length = length < sizeof(buffer) ? length : sizeof(buffer) - 1u; \
+    } while(0)
+
+#define PUT(character) \
+    do \
+    { \
+        if(length < sizeof(buffer) - 1u) \
+        { \
+            buffer[length++] = (character); \
+        } \
+    } while(0)
+
+    while(*assembly && *assembly != '.' && *assembly != ' ')
+    {
+        PUT(*assembly);
+        ++assembly;
+    }
+
+    if(*assembly == '.')
+    {
+        switch(assembly[1])
+        {
+            case 's': APPEND(".%c", sizeSuffixes[op->size & 0x03u]); break;
+            case 'v': APPEND(".%s", laneSuffixes[op->size & 0x03u]); break;
+            case 'n': APPEND(".%u", (op->size + 1u) * 32u); break;
+            default:  APPEND("%s", op->data ? ".e" : ""); break;
+        }
+
+        assembly += 2;
+    }
+
+    while(*assembly)
+    {
+        switch(*assembly)
+        {
+            case 'r': //fallthrough
+            case 'f': //fallthrough
+            case 'd': //fallthrough
+            case 'v':
+                APPEND("%c%u", assembly[0], fieldValue(op, format, assembly[1]));
+                assembly += 2;
+                break;
+
+            case '$':
+                APPEND("$%X", fieldValue(op, format, assembly[1]));
+                assembly += 2;
+                break;
+
+            case '+':
+                APPEND("%s", op->data ? "+" : "");
+                ++assembly;
+                break;
+
+            case ' ': //fallthrough
+            case ',': //fallthrough
+            case '[': //fallthrough
+            case ']':
+                PUT(*assembly);
+                ++assembly;
+                break;
+
+            default:
+                APPEND("%u", fieldValue(op, format, *assembly));
+                ++assembly;
+                break;
+        }
+    }
+
+#undef PUT
+#undef APPEND
+
+    buffer[length] = '\0';
+
+    return snprintf(text, capacity, "%s", buffer);
+}
+
+int isaDisassembleBundle(uint32_t pc, const uint32_t* opcodes, uint32_t size, char* text, size_t capacity)
+{
+    assert(capacity > 0 && text);
+
+    text[0] = '\0';
+
+    int legal = 1;
+    size_t length = 0;
+
+    for(uint32_t i = 0; i < size && length < capacity; ++i)
+    {
+        Operation op = {0};
+        int written;
+
+        if(i)
+        {
+            written = snprintf(text + length, capacity - length, " | ");
+            length += written > 0 ? (size_t)written : 0u;
+
+            if(length >= capacity)
+            {
+                break;
+            }
+        }
+
+        if(isaDecodeOperation(i, pc, opcodes[i], &op))
+        {
+            written = isaDisassembleOperation(&op, text + length, capacity - length);
+        }
+        else
+        {
+            written = snprintf(text + length, capacity - length, ".word $%08X", opcodes[i]);
+            legal = 0;
+        }
+
+        length += written > 0 ? (size_t)written : 0u;
+    }
+
+    return legal;
+}
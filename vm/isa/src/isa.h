@@ -0,0 +1,60 @@
+#ifndef ALTAIR_ISA_H_DEFINED
+#define ALTAIR_ISA_H_DEFINED
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//The Opcode enum, generated from ISA/K1.isa
+#include "isa_opcodes.h"
+
+#define MAX_OPERANDS 3
+
+/// \brief A decoded operation, 16 bytes so that a bundle fits in a cache line
+typedef struct Operation
+{
+    int32_t handler; //< offset of the code executing the operation when dispatch is threaded, left untouched by the decoder
+    uint32_t imm; //< the immediate value, the branch target or the DMA parameters
+    uint16_t kernel; //< the code executing the operation, left untouched by the decoder
+    uint8_t op; //< the Opcode
+    uint8_t size; //< 0 = byte, 1 = word, 2 = doubleword, 3 = quadword
+    uint8_t operands[MAX_OPERANDS]; //< register indices
+    uint8_t data; //< additionnal data, op dependent
+} Operation;
+
+/// \brief Decode one opcode of a bundle
+///
+/// Writes op, imm, size, operands and data of output.
+///
+/// \param index the slot of the opcode in its bundle, which selects the compute units it may use
+/// \param pc the program counter of the bundle, in words, to resolve relative branches
+/// \param opcode the opcode
+/// \param output the decoded operation
+///
+/// \return 1 if the opcode is legal, 0 otherwise
+int isaDecodeOperation(uint32_t index, uint32_t pc, uint32_t opcode, Operation* output);
+
+/// \brief Write the assembly of a decoded operation in the syntax of vasm, branch targets as byte addresses
+///
+/// \return the length snprintf would have written
+int isaDisassembleOperation(const Operation* op, char* text, size_t capacity);
+
+/// \brief Write the assembly of a bundle, its operations separated by " | "
+///
+/// Illegal opcodes are written as ".word $XXXXXXXX". text is always null-terminated, truncated to capacity.
+///
+/// \param pc the program counter of the bundle, in words
+/// \param opcodes the opcodes of the bundle
+/// \param size the number of opcodes
+///
+/// \return 1 if every opcode is legal, 0 otherwise
+int isaDisassembleBundle(uint32_t pc, const uint32_t* opcodes, uint32_t size, char* text, size_t capacity);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,82 @@
+#include <isa.h>
+
+#include <iostream>
+#include <stdexcept>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+
+std::vector<std::uint32_t> read_binary(const std::filesystem::path& path)
+{
+    std::ifstream ifs{path, std::ios_base::binary};
+    if(!ifs)
+    {
+        throw std::runtime_error{"Can not find file \"" + path.string() + "\"."};
+    }
+
+    std::vector<std::uint32_t> output{};
+    output.resize(std::filesystem::file_size(path) / 4u);
+
+    const auto bytes_size{static_cast<std::streamsize>(std::size(output) * 4)};
+    if(ifs.read(reinterpret_cast<char*>(std::data(output)), bytes_size).gcount() != bytes_size)
+    {
+        throw std::runtime_error{"Can not read file \"" + path.string() + "\"."};
+    }
+
+    return output;
+}
+
+//Writes the program back in the syntax of vasm, one operation per line, as bundles of two op-codes whatever XCHG does
+void write_source(const std::vector<std::uint32_t>& binary, const std::filesystem::path& path)
+{
+    if(std::size(binary) % 2u)
+    {
+        throw std::runtime_error{"The binary is not made of bundles of two op-codes."};
+    }
+
+    std::ofstream ofs{path};
+    if(!ofs)
+    {
+        throw std::runtime_error{"Can not write file \"" + path.string() + "\"."};
+    }
+
+    char line[512];
+    for(std::uint32_t pc{}; pc < std::size(binary); pc += 2u)
+    {
+        if(!isaDisassembleBundle(pc, std::data(binary) + pc, 2u, line, sizeof(line)))
+        {
+            throw std::runtime_error{"Illegal op-code at pc " + std::to_string(pc) + ": " + line};
+        }
+
+        const std::string_view text{line};
+        const auto separator{text.find(" | ")};
+        ofs << '\t' << text.substr(0, separator) << "\n\t" << text.substr(separator + 3) << '\n';
+    }
+}
+
+}
+
+//Disassembles a binary of every encoding written by altair_isa_generator -test, so that vasm may assemble it again
+int main(int argc, char** argv)
+{
+    try
+    {
+        if(argc != 3)
+        {
+            throw std::runtime_error{"Usage: altair_isa_disassemble [path_to_binary] [path_to_source]"};
+        }
+
+        write_source(read_binary(argv[1]), argv[2]);
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+
+        return 1;
+    }
+}
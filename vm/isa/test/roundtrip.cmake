@@ -0,0 +1,17 @@
+#Assembles every encoding of the ISA description with vasm, disassembles the binary with altair_isa and assembles the
+#disassembly again: both binaries must be identical
+#
+#Expects GENERATOR, VASM, DISASSEMBLER, DESCRIPTION and DIRECTORY
+
+function(run)
+    execute_process(COMMAND ${ARGN} RESULT_VARIABLE result)
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "Failed: ${ARGN}")
+    endif()
+endfunction()
+
+run(${GENERATOR} -test ${DESCRIPTION} ${DIRECTORY}/encodings.asm)
+run(${VASM} -quiet -Fbin ${DIRECTORY}/encodings.asm -o ${DIRECTORY}/encodings.bin)
+run(${DISASSEMBLER} ${DIRECTORY}/encodings.bin ${DIRECTORY}/disassembly.asm)
+run(${VASM} -quiet -Fbin ${DIRECTORY}/disassembly.asm -o ${DIRECTORY}/disassembly.bin)
+run(${CMAKE_COMMAND} -E compare_files ${DIRECTORY}/encodings.bin ${DIRECTORY}/disassembly.bin)
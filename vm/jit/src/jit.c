@@ -0,0 +1,1131 @@
+#include "jit.h"
+
+#include <string.h>
+
+#if defined(__x86_64__) && defined(__unix__)
+    #define AR_JIT_X86_64
+    #include <sys/mman.h>
+    #include <unistd.h>
+#endif
+
+#ifdef AR_JIT_X86_64
+
+#define JIT_MAX_BLOCK_CODE (8192u) //upper bound of the code emitted for one superblock
+
+//Host registers. Compiled code keeps the processor in r12, pCycles in r13, maxCycles in r14 and the branch condition
+//in rbx, rax, rcx and rdx are scratch and the others hold the integer registers a superblock uses the most
+#define RAX (0u)
+#define RCX (1u)
+#define RDX (2u)
+#define RBP (5u)
+#define RSI (6u)
+#define RDI (7u)
+#define R8  (8u)
+#define R9  (9u)
+#define R10 (10u)
+#define R11 (11u)
+#define R12 (12u)
+#define R15 (15u)
+
+#define CACHED_REGISTERS (8u)
+
+static const uint8_t cacheRegisters[CACHED_REGISTERS] = {RBP, RSI, RDI, R8, R9, R10, R11, R15};
+
+#define IREG(index)        ((uint32_t)offsetof(ArProcessor_T, ireg) + (index) * 8u)
+#define FREG(index, bytes) ((uint32_t)offsetof(ArProcessor_T, freg) + (index) * (bytes))
+#define DSRAM              ((uint32_t)offsetof(ArProcessor_T, dsram))
+#define CACHE              ((uint32_t)offsetof(ArProcessor_T, cache))
+#define FLAGS              ((uint32_t)offsetof(ArProcessor_T, flags))
+#define PC                 ((uint32_t)offsetof(ArProcessor_T, pc))
+
+//The ALU operations are declared as NAME, NAMEI, NAMEQ triplets from ADD to LSR
+_Static_assert(OPCODE_LSRQ - OPCODE_ADD == 13 * 3 - 1, "ALU opcodes must be grouped by three");
+
+//Every superblock saves the same registers, so that compiled code may continue into another superblock past this
+static const uint8_t prologue[] =
+{
+    0x53,             //push rbx
+    0x55,             //push rbp
+    0x41, 0x54,       //push r12
+    0x41, 0x55,       //push r13
+    0x41, 0x56,       //push r14
+    0x41, 0x57,       //push r15
+    0x49, 0x89, 0xFC, //mov r12, rdi
+    0x49, 0x89, 0xF5, //mov r13, rsi
+    0x49, 0x89, 0xD6, //mov r14, rdx
+};
+
+typedef struct Emitter
+{
+    uint8_t* code;
+    uint32_t size;
+    int cacheModel; //1 if cache accesses look up the tags of ArProcessorCacheCreateInfo, which only the interpreter does
+    uint8_t hosts[IREG_COUNT]; //the host register holding each integer register, 0 if it is read from the processor
+    uint64_t written; //the integer registers held in host registers which the superblock writes, stored back on exit
+    uint32_t loop; //where a superblock looping on itself starts again, its registers loaded
+    uint32_t exitCount;
+    uint32_t exits[2]; //the displacements of the jumps to the interpreter, patched once their target is compiled
+    uint32_t exitPcs[2];
+} Emitter;
+
+static void emit8(Emitter* restrict e, uint32_t value)
+{
+    e->code[e->size++] = (uint8_t)value;
+}
+
+static void emit32(Emitter* restrict e, uint32_t value)
+{
+    memcpy(e->code + e->size, &value, sizeof(value));
+    e->size += 4;
+}
+
+static void emitBytes(Emitter* restrict e, const uint8_t* restrict bytes, uint32_t size)
+{
+    memcpy(e->code + e->size, bytes, size);
+    e->size += size;
+}
+
+//REX prefix of the ModRM reg and rm registers, wide for 64 bits
+static void emitRex(Emitter* restrict e, int wide, uint32_t reg, uint32_t rm)
+{
+    emit8(e, 0x40u | (wide ? 0x08u : 0u) | ((reg >> 3u) << 2u) | (rm >> 3u));
+}
+
+//ModRM and SIB bytes of [r12 + disp32], or [r12 + rax + disp32] when indexed
+static void emitMemory(Emitter* restrict e, uint32_t reg, int indexed, uint32_t disp)
+{
+    emit8(e, 0x84u | ((reg & 7u) << 3u));
+    emit8(e, indexed ? 0x04u : 0x24u);
+    emit32(e, disp);
+}
+
+//Zero-extending load of 1, 2, 4 or 8 bytes
+static void emitLoad(Emitter* restrict e, uint32_t reg, uint32_t bytes, int indexed, uint32_t disp)
+{
+    emitRex(e, bytes == 8u, reg, R12);
+
+    switch(bytes)
+    {
+        case 1:  emit8(e, 0x0F); emit8(e, 0xB6); break; //movzx r32, m8
+        case 2:  emit8(e, 0x0F); emit8(e, 0xB7); break; //movzx r32, m16
+        default: emit8(e, 0x8B); break;                 //mov r32, m32 or mov r64, m64
+    }
+
+    emitMemory(e, reg, indexed, disp);
+}
+
+//Store of the low 1, 2, 4 or 8 bytes of a register
+static void emitStore(Emitter* restrict e, uint32_t reg, uint32_t bytes, int indexed, uint32_t disp)
+{
+    if(bytes == 2u)
+    {
+        emit8(e, 0x66);
+    }
+
+    emitRex(e, bytes == 8u, reg, R12);
+    emit8(e, bytes == 1u ? 0x88 : 0x89); //mov m8, r8 or mov m16/m32/m64, r16/r32/r64
+    emitMemory(e, reg, indexed, disp);
+}
+
+//mov r64, r64
+static void emitMoveRegister(Emitter* restrict e, uint32_t destination, uint32_t source)
+{
+    emitRex(e, 1, source, destination);
+    emit8(e, 0x89);
+    emit8(e, 0xC0u | ((source & 7u) << 3u) | (destination & 7u));
+}
+
+//mov r32, imm32, zero-extended to 64 bits
+static void emitMoveImmediate(Emitter* restrict e, uint32_t reg, uint32_t value)
+{
+    if(reg >= 8u)
+    {
+        emitRex(e, 0, 0, reg);
+    }
+
+    emit8(e, 0xB8u + (reg & 7u));
+    emit32(e, value);
+}
+
+//op r64, imm32 or op r64, imm8 of the 0x81 and 0xC1 groups
+static void emitImmediate(Emitter* restrict e, uint32_t opcode, uint32_t operation, uint32_t reg, uint32_t value)
+{
+    emitRex(e, 1, 0, reg);
+    emit8(e, opcode);
+    emit8(e, 0xC0u | (operation << 3u) | (reg & 7u));
+
+    if(opcode == 0x81u)
+    {
+        emit32(e, value);
+    }
+    else
+    {
+        emit8(e, value);
+    }
+}
+
+//Integer registers are read from and written to their host register when the superblock keeps them in one
+static void emitReadRegister(Emitter* restrict e, uint32_t reg, uint32_t index)
+{
+    if(e->hosts[index])
+    {
+        emitMoveRegister(e, reg, e->hosts[index]);
+    }
+    else
+    {
+        emitLoad(e, reg, 8, 0, IREG(index));
+    }
+}
+
+static void emitWriteRegister(Emitter* restrict e, uint32_t index, uint32_t reg)
+{
+    if(e->hosts[index])
+    {
+        emitMoveRegister(e, e->hosts[index], reg);
+    }
+    else
+    {
+        emitStore(e, reg, 8, 0, IREG(index));
+    }
+}
+
+static void emitIncrementRegister(Emitter* restrict e, uint32_t index, uint32_t value)
+{
+    if(e->hosts[index])
+    {
+        emitImmediate(e, 0x81, 0, e->hosts[index], value); //add r64, imm32
+    }
+    else
+    {
+        emitRex(e, 1, 0, R12); //add qword [r12 + disp32], imm32
+        emit8(e, 0x81);
+        emitMemory(e, 0, 0, IREG(index));
+        emit32(e, value);
+    }
+}
+
+//Truncate rax or rcx to an operation size, as sizemask does
+static void emitMask(Emitter* restrict e, uint32_t reg, uint32_t size)
+{
+    const uint32_t modrm = 0xC0u | (reg << 3u) | reg;
+
+    switch(size)
+    {
+        case 0:  emit8(e, 0x0F); emit8(e, 0xB6); emit8(e, modrm); break; //movzx r32, r8
+        case 1:  emit8(e, 0x0F); emit8(e, 0xB7); emit8(e, modrm); break; //movzx r32, r16
+        case 2:  emit8(e, 0x89); emit8(e, modrm); break;                 //mov r32, r32
+        default: break;
+    }
+}
+
+//Sign-extend rax or rcx from an operation size
+static void emitSignExtend(Emitter* restrict e, uint32_t reg, uint32_t size)
+{
+    const uint32_t modrm = 0xC0u | (reg << 3u) | reg;
+
+    switch(size)
+    {
+        case 0:  emit8(e, 0x48); emit8(e, 0x0F); emit8(e, 0xBE); emit8(e, modrm); break; //movsx r64, r8
+        case 1:  emit8(e, 0x48); emit8(e, 0x0F); emit8(e, 0xBF); emit8(e, modrm); break; //movsx r64, r16
+        case 2:  emit8(e, 0x48); emit8(e, 0x63); emit8(e, modrm); break;                 //movsxd r64, r32
+        default: break;
+    }
+}
+
+//Jump with a 32 bits displacement, returns the position of the displacement to patch
+static uint32_t emitJump(Emitter* restrict e, uint32_t condition)
+{
+    if(condition)
+    {
+        emit8(e, 0x0F);
+        emit8(e, condition);
+    }
+    else
+    {
+        emit8(e, 0xE9);
+    }
+
+    emit32(e, 0);
+
+    return e->size - 4u;
+}
+
+static void patchJump(Emitter* restrict e, uint32_t position, uint32_t target)
+{
+    const uint32_t displacement = target - (position + 4u);
+    memcpy(e->code + position, &displacement, sizeof(displacement));
+}
+
+#define JCC_JZ  (0x84u)
+#define JCC_JBE (0x86u)
+#define JCC_JA  (0x87u)
+
+//rax = rax OP rcx
+static void emitAlu(Emitter* restrict e, Opcode base)
+{
+    switch(base)
+    {
+        default: break;
+        case OPCODE_ADD:  emit8(e, 0x48); emit8(e, 0x01); emit8(e, 0xC8); break;
+        case OPCODE_SUB:  emit8(e, 0x48); emit8(e, 0x29); emit8(e, 0xC8); break;
+        case OPCODE_AND:  emit8(e, 0x48); emit8(e, 0x21); emit8(e, 0xC8); break;
+        case OPCODE_OR:   emit8(e, 0x48); emit8(e, 0x09); emit8(e, 0xC8); break;
+        case OPCODE_XOR:  emit8(e, 0x48); emit8(e, 0x31); emit8(e, 0xC8); break;
+        case OPCODE_MULS: //fallthrough, the low 64 bits do not depend on the signedness
+        case OPCODE_MULU: emit8(e, 0x48); emit8(e, 0x0F); emit8(e, 0xAF); emit8(e, 0xC1); break;
+        case OPCODE_ASL:  //fallthrough
+        case OPCODE_LSL:  emit8(e, 0x48); emit8(e, 0xD3); emit8(e, 0xE0); break;
+        case OPCODE_ASR:  emit8(e, 0x48); emit8(e, 0xD3); emit8(e, 0xF8); break;
+        case OPCODE_LSR:  emit8(e, 0x48); emit8(e, 0xD3); emit8(e, 0xE8); break;
+    }
+}
+
+//rax = rax / rcx on the operands truncated to the size, all ones for a zero divisor, and the signed division by -1 is
+//a negation so that the signed minimum divided by -1 gives the signed minimum
+//
+//The 64 bits division is several times slower than the 32 bits one on most hosts, it is only used for quadwords
+//which do not fit in 32 bits, both positive quadwords below 2^32 divide the same signed or not
+static void emitDivide(Emitter* restrict e, Opcode base, uint32_t size)
+{
+    static const uint8_t testDivisor[] = {0x48, 0x85, 0xC9};                         //test rcx, rcx
+    static const uint8_t compareMinusOne[] = {0x48, 0x83, 0xF9, 0xFF};               //cmp rcx, -1
+    static const uint8_t testHigh[] = {0x48, 0x89, 0xC2, 0x48, 0x09, 0xCA,
+                                       0x48, 0xC1, 0xEA, 0x20};                      //mov rdx, rax, or rdx, rcx, shr rdx, 32
+    static const uint8_t divideSigned[] = {0x48, 0x99, 0x48, 0xF7, 0xF9};            //cqo, idiv rcx
+    static const uint8_t divideUnsigned[] = {0x31, 0xD2, 0x48, 0xF7, 0xF1};          //xor edx, edx, div rcx
+    static const uint8_t divideSigned32[] = {0x99, 0xF7, 0xF9};                      //cdq, idiv ecx
+    static const uint8_t divideUnsigned32[] = {0x31, 0xD2, 0xF7, 0xF1};              //xor edx, edx, div ecx
+    static const uint8_t allOnes[] = {0x48, 0xC7, 0xC0, 0xFF, 0xFF, 0xFF, 0xFF};     //mov rax, -1
+    static const uint8_t negate[] = {0x48, 0xF7, 0xD8};                              //neg rax
+
+    const int sign = base == OPCODE_DIVS;
+
+    if(sign)
+    {
+        emitSignExtend(e, RAX, size);
+        emitSignExtend(e, RCX, size);
+    }
+    else
+    {
+        emitMask(e, RAX, size);
+        emitMask(e, RCX, size);
+    }
+
+    emitBytes(e, testDivisor, sizeof(testDivisor));
+    const uint32_t zero = emitJump(e, JCC_JZ);
+
+    uint32_t minusOne = 0;
+    if(sign)
+    {
+        emitBytes(e, compareMinusOne, sizeof(compareMinusOne));
+        minusOne = emitJump(e, JCC_JZ);
+    }
+
+    uint32_t narrow = 0;
+    if(size < 3)
+    {
+        //The operands are 32 bits values extended to 64 bits, the quotient fits in 32 bits past the division by -1
+        if(sign)
+        {
+            emitBytes(e, divideSigned32, sizeof(divideSigned32));
+        }
+        else
+        {
+            emitBytes(e, divideUnsigned32, sizeof(divideUnsigned32));
+        }
+    }
+    else
+    {
+        emitBytes(e, testHigh, sizeof(testHigh));
+        narrow = emitJump(e, JCC_JZ);
+
+        if(sign)
+        {
+            emitBytes(e, divideSigned, sizeof(divideSigned));
+        }
+        else
+        {
+            emitBytes(e, divideUnsigned, sizeof(divideUnsigned));
+        }
+    }
+
+    const uint32_t divided = emitJump(e, 0);
+
+    uint32_t dividedNarrow = 0;
+    if(size == 3)
+    {
+        patchJump(e, narrow, e->size);
+        emitBytes(e, divideUnsigned32, sizeof(divideUnsigned32));
+        dividedNarrow = emitJump(e, 0);
+    }
+
+    patchJump(e, zero, e->size);
+    emitBytes(e, allOnes, sizeof(allOnes));
+
+    if(sign)
+    {
+        const uint32_t done = emitJump(e, 0);
+
+        patchJump(e, minusOne, e->size);
+        emitBytes(e, negate, sizeof(negate));
+        patchJump(e, done, e->size);
+    }
+
+    patchJump(e, divided, e->size);
+    if(size == 3)
+    {
+        patchJump(e, dividedNarrow, e->size);
+    }
+}
+
+//REG = REG OP REG, REG = REG OP IMM and REG OP= IMM
+static void emitAluOperation(Emitter* restrict e, const Operation* restrict op)
+{
+    const uint8_t* restrict const operands = op->operands;
+    const uint32_t group = (uint32_t)(op->op - OPCODE_ADD);
+    const Opcode base = (Opcode)(OPCODE_ADD + group / 3u * 3u);
+
+    switch(group % 3u)
+    {
+        case 0: //register
+            emitReadRegister(e, RAX, operands[1]);
+            emitReadRegister(e, RCX, operands[0]);
+            break;
+
+        case 1: //immediate
+            emitReadRegister(e, RAX, operands[1]);
+            emitMoveImmediate(e, RCX, op->imm);
+            break;
+
+        default: //quick
+            emitReadRegister(e, RAX, operands[2]);
+            emitMoveImmediate(e, RCX, op->imm);
+            break;
+    }
+
+    //Narrow shifts take their count modulo the operation width, and shift the truncated operand
+    if(op->size < 3 && (base == OPCODE_ASL || base == OPCODE_LSL || base == OPCODE_ASR || base == OPCODE_LSR))
+    {
+        emit8(e, 0x83); //and ecx, imm8
+        emit8(e, 0xE1);
+        emit8(e, (8u << op->size) - 1u);
+
+        if(base == OPCODE_ASR)
+        {
+            emitSignExtend(e, RAX, op->size);
+        }
+        else if(base == OPCODE_LSR)
+        {
+            emitMask(e, RAX, op->size);
+        }
+    }
+
+    if(base == OPCODE_DIVS || base == OPCODE_DIVU)
+    {
+        emitDivide(e, base, op->size);
+    }
+    else
+    {
+        emitAlu(e, base);
+    }
+
+    emitMask(e, RAX, op->size);
+    emitWriteRegister(e, operands[2], RAX);
+}
+
+//Copy between a register and the SRAM or the cache at op->imm + ireg[operands[1]], then increment the base
+//
+//index is the integer register copied, or IREG_COUNT when it is the float register at the offset reg
+static void emitLoadStore(Emitter* restrict e, const Operation* restrict op, int load, uint32_t memory, uint32_t index, uint32_t reg, uint32_t bytes)
+{
+    const uint8_t* restrict const operands = op->operands;
+
+    emitReadRegister(e, RAX, operands[1]);
+    if(op->imm)
+    {
+        emit8(e, 0x48); //add rax, imm32
+        emit8(e, 0x05);
+        emit32(e, op->imm);
+    }
+
+    const uint32_t host = index < IREG_COUNT ? e->hosts[index] : 0u;
+
+    if(host && !load)
+    {
+        emitStore(e, host, bytes, 1, memory);
+    }
+    else if(host && bytes == 8u)
+    {
+        emitLoad(e, host, 8, 1, memory);
+    }
+    else if(host)
+    {
+        //A narrow load keeps the high bytes of the register
+        emitLoad(e, RCX, bytes, 1, memory);
+
+        if(bytes == 4u)
+        {
+            emitImmediate(e, 0xC1, 5, host, 32); //shr r64, 32
+            emitImmediate(e, 0xC1, 4, host, 32); //shl r64, 32
+        }
+        else
+        {
+            emitImmediate(e, 0x81, 4, host, ~((1u << (bytes * 8u)) - 1u)); //and r64, imm32 sign-extended
+        }
+
+        emitRex(e, 1, RCX, host); //or r64, rcx
+        emit8(e, 0x09);
+        emit8(e, 0xC0u | (RCX << 3u) | (host & 7u));
+    }
+    else
+    {
+        for(uint32_t offset = 0; offset < bytes; offset += 8u)
+        {
+            const uint32_t chunk = bytes - offset < 8u ? bytes - offset : 8u;
+
+            if(load)
+            {
+                emitLoad(e, RCX, chunk, 1, memory + offset);
+                emitStore(e, RCX, chunk, 0, reg + offset);
+            }
+            else
+            {
+                emitLoad(e, RCX, chunk, 0, reg + offset);
+                emitStore(e, RCX, chunk, 1, memory + offset);
+            }
+        }
+    }
+
+    if(op->data)
+    {
+        emitIncrementRegister(e, operands[1], op->data);
+    }
+}
+
+//flags = (flags & ~(Z | S | U | CMPT)) | (rax != rcx) << 1 | (rax < rcx signed) << 2 | (rax < rcx) << 3
+static void emitCompare(Emitter* restrict e)
+{
+    static const uint8_t code[] =
+    {
+        0x48, 0x39, 0xC8, //cmp rax, rcx
+        0x0F, 0x95, 0xC2, //setne dl
+        0x0F, 0x9C, 0xC0, //setl al
+        0x0F, 0x92, 0xC1, //setb cl
+        0x0F, 0xB6, 0xD2, //movzx edx, dl
+        0x0F, 0xB6, 0xC0, //movzx eax, al
+        0x0F, 0xB6, 0xC9, //movzx ecx, cl
+        0xD1, 0xE2,       //shl edx, 1
+        0xC1, 0xE0, 0x02, //shl eax, 2
+        0xC1, 0xE1, 0x03, //shl ecx, 3
+        0x09, 0xC2,       //or edx, eax
+        0x09, 0xCA,       //or edx, ecx
+    };
+
+    emitBytes(e, code, sizeof(code));
+
+    emitLoad(e, RAX, 4, 0, FLAGS);
+    emit8(e, 0x25); //and eax, imm32
+    emit32(e, ~(Z_MASK | S_MASK | U_MASK | CMPT_MASK));
+    emit8(e, 0x09); //or eax, edx
+    emit8(e, 0xD0);
+    emitStore(e, RAX, 4, 0, FLAGS);
+}
+
+static int isCacheAccess(Opcode op)
+{
+    return op == OPCODE_LDC  || op == OPCODE_STC  || op == OPCODE_LDCV || op == OPCODE_STCV ||
+           op == OPCODE_LDCF || op == OPCODE_STCF || op == OPCODE_LDCD || op == OPCODE_STCD;
+}
+
+static int emitOperation(Emitter* restrict e, const Operation* restrict op)
+{
+    const uint8_t* restrict const operands = op->operands;
+
+    if(e->cacheModel && isCacheAccess((Opcode)op->op))
+    {
+        return 0;
+    }
+
+    if(op->op >= OPCODE_ADD && op->op <= OPCODE_LSRQ)
+    {
+        emitAluOperation(e, op);
+
+        return 1;
+    }
+
+    switch(op->op)
+    {
+        default:
+            return 0;
+
+        case OPCODE_NOP:
+            return !op->data; //nop.e ends the code
+
+        case OPCODE_MOVEI:
+            if(e->hosts[operands[2]])
+            {
+                emitMoveImmediate(e, e->hosts[operands[2]], op->imm);
+            }
+            else
+            {
+                emitMoveImmediate(e, RAX, op->imm);
+                emitStore(e, RAX, 8, 0, IREG(operands[2]));
+            }
+            break;
+
+        case OPCODE_LDM:  //fallthrough
+        case OPCODE_LDMX: emitLoadStore(e, op, 1, DSRAM, operands[2], IREG(operands[2]), 1u << op->size); break;
+        case OPCODE_STM:  //fallthrough
+        case OPCODE_STMX: emitLoadStore(e, op, 0, DSRAM, operands[2], IREG(operands[2]), 1u << op->size); break;
+        case OPCODE_LDC:  emitLoadStore(e, op, 1, CACHE, operands[2], IREG(operands[2]), 1u << op->size); break;
+        case OPCODE_STC:  emitLoadStore(e, op, 0, CACHE, operands[2], IREG(operands[2]), 1u << op->size); break;
+        case OPCODE_LDMV: emitLoadStore(e, op, 1, DSRAM, IREG_COUNT, FREG(operands[2], 16u), 16u); break;
+        case OPCODE_STMV: emitLoadStore(e, op, 0, DSRAM, IREG_COUNT, FREG(operands[2], 16u), 16u); break;
+        case OPCODE_LDCV: emitLoadStore(e, op, 1, CACHE, IREG_COUNT, FREG(operands[2], 16u), 16u); break;
+        case OPCODE_STCV: emitLoadStore(e, op, 0, CACHE, IREG_COUNT, FREG(operands[2], 16u), 16u); break;
+        case OPCODE_LDMF: emitLoadStore(e, op, 1, DSRAM, IREG_COUNT, FREG(operands[2], 4u), 4u); break;
+        case OPCODE_STMF: emitLoadStore(e, op, 0, DSRAM, IREG_COUNT, FREG(operands[2], 4u), 4u); break;
+        case OPCODE_LDCF: emitLoadStore(e, op, 1, CACHE, IREG_COUNT, FREG(operands[2], 4u), 4u); break;
+        case OPCODE_STCF: emitLoadStore(e, op, 0, CACHE, IREG_COUNT, FREG(operands[2], 4u), 4u); break;
+        case OPCODE_LDMD: emitLoadStore(e, op, 1, DSRAM, IREG_COUNT, FREG(operands[2], 8u), 8u); break;
+        case OPCODE_STMD: emitLoadStore(e, op, 0, DSRAM, IREG_COUNT, FREG(operands[2], 8u), 8u); break;
+        case OPCODE_LDCD: emitLoadStore(e, op, 1, CACHE, IREG_COUNT, FREG(operands[2], 8u), 8u); break;
+        case OPCODE_STCD: emitLoadStore(e, op, 0, CACHE, IREG_COUNT, FREG(operands[2], 8u), 8u); break;
+
+        case OPCODE_CMP:
+            emitReadRegister(e, RAX, operands[1]);
+            emitReadRegister(e, RCX, operands[0]);
+            emitMask(e, RAX, op->size);
+            emitMask(e, RCX, op->size);
+            emitCompare(e);
+            break;
+
+        case OPCODE_CMPI:
+        {
+            static const uint32_t sizemask[] = {0xFFu, 0xFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu};
+
+            emitReadRegister(e, RAX, operands[1]);
+            emitMask(e, RAX, op->size);
+            emitMoveImmediate(e, RCX, op->imm & sizemask[op->size]);
+            emitCompare(e);
+            break;
+        }
+    }
+
+    return 1;
+}
+
+
+static int isBranch(Opcode op)
+{
+    return (op >= OPCODE_BNE && op <= OPCODE_BGES) || op == OPCODE_JMP || op == OPCODE_JMPR;
+}
+
+/// \brief ebx = branch taken, then clear the Z, S and U flags
+///
+/// The condition is (flags & mask) != 0, or == 0 when inverted, optionally or-ed with the equality
+static void emitCondition(Emitter* restrict e, Opcode op)
+{
+    uint32_t mask = Z_MASK;
+    int inverted = 0;
+    int orEqual = 0;
+
+    switch(op)
+    {
+        default:        break;
+        case OPCODE_BNE:  mask = Z_MASK; break;
+        case OPCODE_BEQ:  mask = Z_MASK; inverted = 1; break;
+        case OPCODE_BL:   mask = U_MASK; break;
+        case OPCODE_BLE:  mask = U_MASK; orEqual = 1; break;
+        case OPCODE_BG:   mask = U_MASK; inverted = 1; break;
+        case OPCODE_BGE:  mask = U_MASK; inverted = 1; orEqual = 1; break;
+        case OPCODE_BLS:  mask = S_MASK; break;
+        case OPCODE_BLES: mask = S_MASK; orEqual = 1; break;
+        case OPCODE_BGS:  mask = S_MASK; inverted = 1; break;
+        case OPCODE_BGES: mask = S_MASK; inverted = 1; orEqual = 1; break;
+    }
+
+    emitLoad(e, RAX, 4, 0, FLAGS);
+
+    emit8(e, 0xA9); //test eax, imm32
+    emit32(e, mask);
+    emit8(e, 0x0F); //setne bl / sete bl
+    emit8(e, inverted ? 0x94 : 0x95);
+    emit8(e, 0xC3);
+    emit8(e, 0x0F); //movzx ebx, bl
+    emit8(e, 0xB6);
+    emit8(e, 0xDB);
+
+    if(orEqual)
+    {
+        emit8(e, 0xA9); //test eax, Z_MASK
+        emit32(e, Z_MASK);
+        emit8(e, 0x0F); //sete cl
+        emit8(e, 0x94);
+        emit8(e, 0xC1);
+        emit8(e, 0x0F); //movzx ecx, cl
+        emit8(e, 0xB6);
+        emit8(e, 0xC9);
+        emit8(e, 0x09); //or ebx, ecx
+        emit8(e, 0xCB);
+    }
+
+    emit8(e, 0x25); //and eax, imm32
+    emit32(e, ~(Z_MASK | S_MASK | U_MASK));
+    emitStore(e, RAX, 4, 0, FLAGS);
+}
+
+//Counts how many times an operation names each integer register, and marks those it writes
+static void countRegisters(const Operation* restrict op, uint32_t uses[IREG_COUNT], uint64_t* restrict written)
+{
+    const uint8_t* restrict const operands = op->operands;
+
+    if(op->op >= OPCODE_ADD && op->op <= OPCODE_LSRQ)
+    {
+        switch((uint32_t)(op->op - OPCODE_ADD) % 3u)
+        {
+            case 0:  ++uses[operands[1]]; ++uses[operands[0]]; break;
+            case 1:  ++uses[operands[1]]; break;
+            default: ++uses[operands[2]]; break;
+        }
+
+        ++uses[operands[2]];
+        *written |= 1ull << operands[2];
+
+        return;
+    }
+
+    switch(op->op)
+    {
+        default:
+            break;
+
+        case OPCODE_MOVEI:
+            ++uses[operands[2]];
+            *written |= 1ull << operands[2];
+            break;
+
+        case OPCODE_LDM:  //fallthrough
+        case OPCODE_LDMX: //fallthrough
+        case OPCODE_LDC:  //fallthrough
+        case OPCODE_STM:  //fallthrough
+        case OPCODE_STMX: //fallthrough
+        case OPCODE_STC:
+            ++uses[operands[2]];
+            if(op->op == OPCODE_LDM || op->op == OPCODE_LDMX || op->op == OPCODE_LDC)
+            {
+                *written |= 1ull << operands[2];
+            }
+            //fallthrough
+
+        case OPCODE_LDMV: //fallthrough
+        case OPCODE_STMV: //fallthrough
+        case OPCODE_LDCV: //fallthrough
+        case OPCODE_STCV: //fallthrough
+        case OPCODE_LDMF: //fallthrough
+        case OPCODE_STMF: //fallthrough
+        case OPCODE_LDCF: //fallthrough
+        case OPCODE_STCF: //fallthrough
+        case OPCODE_LDMD: //fallthrough
+        case OPCODE_STMD: //fallthrough
+        case OPCODE_LDCD: //fallthrough
+        case OPCODE_STCD:
+            ++uses[operands[1]];
+            if(op->data)
+            {
+                *written |= 1ull << operands[1];
+            }
+            break;
+
+        case OPCODE_CMP:
+            ++uses[operands[1]];
+            ++uses[operands[0]];
+            break;
+
+        case OPCODE_CMPI:
+            ++uses[operands[1]];
+            break;
+    }
+}
+
+//Gives the host registers to the integer registers the superblock names the most
+static void allocateRegisters(Emitter* restrict e, const Superblock* restrict block, const DecodedBundle* restrict delaySlot)
+{
+    uint32_t uses[IREG_COUNT] = {0};
+    uint64_t written = 0;
+
+    for(uint32_t i = 0; i < block->microOpCount; ++i)
+    {
+        countRegisters(&block->microOps[i].operation, uses, &written);
+    }
+
+    for(uint32_t i = 0; delaySlot && i < block->size; ++i)
+    {
+        countRegisters(&delaySlot->operations[i], uses, &written);
+    }
+
+    for(uint32_t i = 0; i < CACHED_REGISTERS; ++i)
+    {
+        uint32_t best = 0;
+        for(uint32_t index = 1; index < IREG_COUNT; ++index)
+        {
+            if(!e->hosts[index] && uses[index] > uses[best])
+            {
+                best = index;
+            }
+        }
+
+        if(!uses[best] || e->hosts[best])
+        {
+            break;
+        }
+
+        e->hosts[best] = cacheRegisters[i];
+        uses[best] = 0;
+    }
+
+    for(uint32_t index = 0; index < IREG_COUNT; ++index)
+    {
+        if(e->hosts[index] && (written & (1ull << index)))
+        {
+            e->written |= 1ull << index;
+        }
+    }
+}
+
+static void emitEpilogue(Emitter* restrict e)
+{
+    static const uint8_t code[] =
+    {
+        0x31, 0xC0, //xor eax, eax (AR_SUCCESS)
+        0x41, 0x5F, //pop r15
+        0x41, 0x5E, //pop r14
+        0x41, 0x5D, //pop r13
+        0x41, 0x5C, //pop r12
+        0x5D,       //pop rbp
+        0x5B,       //pop rbx
+        0xC3,       //ret
+    };
+
+    emitBytes(e, code, sizeof(code));
+}
+
+//rax = *pCycles + bundles, compared to maxCycles
+static void emitBudget(Emitter* restrict e, uint32_t bundles)
+{
+    static const uint8_t code[] =
+    {
+        0x49, 0x8B, 0x45, 0x00, //mov rax, [r13]
+        0x48, 0x05,             //add rax, imm32
+    };
+
+    emitBytes(e, code, sizeof(code));
+    emit32(e, bundles);
+
+    emit8(e, 0x4C); //cmp rax, r14
+    emit8(e, 0x39);
+    emit8(e, 0xF0);
+}
+
+/// \brief Continue at pc
+///
+/// A loop on the superblock itself stays in host code while the next pass fits the cycle budget. Other targets are
+/// reached through a jump to the interpreter, patched to continue into their code once they are compiled
+static void emitExit(Emitter* restrict e, const Superblock* restrict block, uint32_t pc)
+{
+    if(pc == block->pc)
+    {
+        emitBudget(e, block->codeBundles);
+        patchJump(e, emitJump(e, JCC_JBE), e->loop);
+    }
+
+    for(uint32_t index = 0; index < IREG_COUNT; ++index)
+    {
+        if(e->written & (1ull << index))
+        {
+            emitStore(e, e->hosts[index], 8, 0, IREG(index));
+        }
+    }
+
+    if(pc != block->pc)
+    {
+        e->exits[e->exitCount] = emitJump(e, 0);
+        e->exitPcs[e->exitCount++] = pc;
+    }
+
+    emit8(e, 0x41); //mov dword [r12 + PC], imm32
+    emit8(e, 0xC7);
+    emitMemory(e, 0, 0, PC);
+    emit32(e, pc);
+
+    emitEpilogue(e);
+}
+
+//Compiled code is never writable and executable at once, the pages holding [begin, end) are switched for a write
+static int protectCode(ArProcessor restrict processor, size_t begin, size_t end, int writable)
+{
+    const size_t page = (size_t)sysconf(_SC_PAGESIZE);
+
+    begin &= ~(page - 1u);
+    end = (end + page - 1u) & ~(page - 1u);
+
+    return mprotect(processor->jitCode + begin, end - begin, writable ? PROT_READ | PROT_WRITE : PROT_READ | PROT_EXEC) == 0;
+}
+
+void jitFlush(ArProcessor processor)
+{
+    for(uint32_t i = 0; i < SUPERBLOCK_CACHE_SIZE; ++i)
+    {
+        processor->superblocks[i].code = NULL;
+        processor->superblocks[i].executions = 0;
+    }
+
+    processor->jitCodeSize = 0;
+    processor->jitExitCount = 0;
+}
+
+static uint8_t* reserveCode(ArProcessor restrict processor)
+{
+    if(!processor->jitCode)
+    {
+        void* const code = mmap(NULL, JIT_CODE_CAPACITY, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if(code == MAP_FAILED)
+        {
+            return NULL;
+        }
+
+        processor->jitCode = code;
+        jitFlush(processor);
+    }
+
+    //Out of space, everything is compiled again when hot
+    if(processor->jitCodeSize + JIT_MAX_BLOCK_CODE > JIT_CODE_CAPACITY)
+    {
+        jitFlush(processor);
+    }
+
+    return processor->jitCode + processor->jitCodeSize;
+}
+
+//Point the jump of an exit to code
+static void patchExit(ArProcessor restrict processor, uint32_t position, const uint8_t* restrict code)
+{
+    const uint32_t displacement = (uint32_t)(code - (processor->jitCode + position + 4u));
+
+    if(!protectCode(processor, position, position + 4u, 1))
+    {
+        return;
+    }
+
+    memcpy(processor->jitCode + position, &displacement, sizeof(displacement));
+
+    if(!protectCode(processor, position, position + 4u, 0))
+    {
+        jitFlush(processor);
+    }
+}
+
+//Continue an exit into the code of its target, now or once the target is compiled
+static void chainExit(ArProcessor restrict processor, uint32_t position, uint32_t pc, uint32_t size)
+{
+    const Superblock* restrict const target = &processor->superblocks[pc & (SUPERBLOCK_CACHE_SIZE - 1u)];
+
+    if(target->code && target->bundleCount && target->pc == pc && target->size == size)
+    {
+        patchExit(processor, position, (const uint8_t*)(uintptr_t)target->code + sizeof(prologue));
+    }
+    else if(processor->jitExitCount < JIT_MAX_EXITS)
+    {
+        processor->jitExits[processor->jitExitCount++] = (JitExit){.position = position, .pc = pc, .size = size};
+    }
+}
+
+//Emits the code of a superblock, 0 if one of its operations can not be compiled
+static int emitSuperblock(Emitter* restrict e, Superblock* restrict block, const DecodedBundle* restrict delaySlot)
+{
+    const Operation* branch = NULL;
+
+    for(uint32_t i = 0; i < block->microOpCount; ++i)
+    {
+        const Operation* restrict const op = &block->microOps[i].operation;
+
+        if(isBranch(op->op))
+        {
+            branch = op; //the branch can only be in the last bundle
+        }
+    }
+
+    if(branch && !delaySlot)
+    {
+        return 0;
+    }
+
+    block->codeBundles = block->bundleCount + (branch != NULL);
+
+    allocateRegisters(e, block, branch ? delaySlot : NULL);
+
+    emitBytes(e, prologue, sizeof(prologue));
+
+    //Entered from another superblock, the pass must fit the cycle budget too
+    emitBudget(e, block->codeBundles);
+    const uint32_t overBudget = emitJump(e, JCC_JA);
+
+    for(uint32_t index = 0; index < IREG_COUNT; ++index)
+    {
+        if(e->hosts[index])
+        {
+            emitLoad(e, e->hosts[index], 8, 0, IREG(index));
+        }
+    }
+
+    e->loop = e->size;
+
+    for(uint32_t i = 0; i < block->microOpCount; ++i)
+    {
+        const Operation* restrict const op = &block->microOps[i].operation;
+
+        if(!isBranch(op->op) && !emitOperation(e, op))
+        {
+            return 0;
+        }
+    }
+
+    if(branch)
+    {
+        if(branch->op != OPCODE_JMP && branch->op != OPCODE_JMPR)
+        {
+            emitCondition(e, branch->op);
+        }
+
+        for(uint32_t i = 0; i < block->size; ++i)
+        {
+            if(!emitOperation(e, &delaySlot->operations[i]))
+            {
+                return 0;
+            }
+        }
+    }
+
+    static const uint8_t addCycles[] = {0x49, 0x81, 0x45, 0x00}; //add qword [r13], imm32
+    emitBytes(e, addCycles, sizeof(addCycles));
+    emit32(e, block->codeBundles);
+
+    const uint32_t fallthrough = block->pc + block->codeBundles * block->size;
+
+    if(!branch)
+    {
+        emitExit(e, block, fallthrough);
+    }
+    else if(branch->op == OPCODE_JMP || branch->op == OPCODE_JMPR)
+    {
+        emitExit(e, block, branch->imm);
+    }
+    else
+    {
+        emit8(e, 0x85); //test ebx, ebx
+        emit8(e, 0xDB);
+        const uint32_t notTaken = emitJump(e, JCC_JZ);
+
+        emitExit(e, block, branch->imm);
+
+        patchJump(e, notTaken, e->size);
+        emitExit(e, block, fallthrough);
+    }
+
+    patchJump(e, overBudget, e->size);
+
+    emit8(e, 0x41); //mov dword [r12 + PC], imm32
+    emit8(e, 0xC7);
+    emitMemory(e, 0, 0, PC);
+    emit32(e, block->pc);
+
+    emitEpilogue(e);
+
+    return 1;
+}
+
+void jitCompileSuperblock(ArProcessor processor, Superblock* block, const DecodedBundle* delaySlot)
+{
+    uint8_t* const code = reserveCode(processor);
+    if(!code)
+    {
+        return;
+    }
+
+    const uint32_t start = (uint32_t)processor->jitCodeSize;
+    if(!protectCode(processor, start, start + JIT_MAX_BLOCK_CODE, 1))
+    {
+        return;
+    }
+
+    Emitter e = {.code = code, .cacheModel = processor->cacheTags != NULL};
+
+    const int compiled = emitSuperblock(&e, block, delaySlot);
+
+    //The pages hold the code of other superblocks too
+    if(!protectCode(processor, start, start + JIT_MAX_BLOCK_CODE, 0))
+    {
+        jitFlush(processor);
+        return;
+    }
+
+    if(!compiled)
+    {
+        return;
+    }
+
+    processor->jitCodeSize += (e.size + 15u) & ~15u;
+
+    block->code = (JitFunction)(uintptr_t)code;
+
+    //The exits waiting for this superblock continue into it
+    for(uint32_t i = 0; i < processor->jitExitCount;)
+    {
+        const JitExit exit = processor->jitExits[i];
+
+        if(exit.pc == block->pc && exit.size == block->size)
+        {
+            processor->jitExits[i] = processor->jitExits[--processor->jitExitCount];
+            patchExit(processor, exit.position, code + sizeof(prologue));
+        }
+        else
+        {
+            ++i;
+        }
+    }
+
+    for(uint32_t i = 0; i < e.exitCount && block->code; ++i)
+    {
+        chainExit(processor, start + e.exits[i], e.exitPcs[i], block->size);
+    }
+}
+
+void jitDestroyProcessor(ArProcessor processor)
+{
+    if(processor->jitCode)
+    {
+        munmap(processor->jitCode, JIT_CODE_CAPACITY);
+    }
+}
+
+#else
+
+//No code generator for this host, every superblock is interpreted
+void jitCompileSuperblock(ArProcessor processor, Superblock* block, const DecodedBundle* delaySlot)
+{
+    (void)processor;
+    (void)block;
+    (void)delaySlot;
+}
+
+void jitFlush(ArProcessor processor)
+{
+    (void)processor;
+}
+
+void jitDestroyProcessor(ArProcessor processor)
+{
+    (void)processor;
+}
+
+#endif
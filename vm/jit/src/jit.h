@@ -0,0 +1,23 @@
+#ifndef ALTAIR_VM_JIT_H_DEFINED
+#define ALTAIR_VM_JIT_H_DEFINED
+
+#include "vm.h"
+
+/// \brief Compile a superblock to host code
+///
+/// A superblock ended by a branch is compiled together with its delay slot. On success block->code
+/// and block->codeBundles are set, otherwise the superblock keeps being interpreted.
+///
+/// \param delaySlot the bundle following the superblock, may be NULL
+void jitCompileSuperblock(ArProcessor processor, Superblock* block, const DecodedBundle* delaySlot);
+
+/// \brief Drop all compiled code
+///
+/// Compiled superblocks continue into each other, so code is dropped all at once when the instructions it was compiled
+/// from change or when the code memory is full.
+void jitFlush(ArProcessor processor);
+
+/// \brief Release the executable memory of a processor
+void jitDestroyProcessor(ArProcessor processor);
+
+#endif
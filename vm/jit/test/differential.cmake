@@ -0,0 +1,20 @@
+#Runs random programs on the relaxed and the JIT libraries with budgets split at random: the saved states of every run
+#must match the state the relaxed library reaches in a single budget
+#
+#Expects RUNNER, VASM, RELAXED, JIT, PROGRAMS, CYCLES and DIRECTORY
+
+function(run)
+    execute_process(COMMAND ${ARGN} RESULT_VARIABLE result)
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "Failed: ${ARGN}")
+    endif()
+endfunction()
+
+set(binaries)
+foreach(seed RANGE 1 ${PROGRAMS})
+    run(${RUNNER} -generate ${seed} ${DIRECTORY}/program${seed}.asm)
+    run(${VASM} -quiet -Fbin ${DIRECTORY}/program${seed}.asm -o ${DIRECTORY}/program${seed}.bin)
+    list(APPEND binaries ${DIRECTORY}/program${seed}.bin)
+endforeach()
+
+run(${RUNNER} -compare ${CYCLES} ${RELAXED} ${JIT} -- ${binaries})
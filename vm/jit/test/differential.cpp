@@ -0,0 +1,469 @@
+#include <base/vm.h>
+
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+
+#include <shared_library.hpp>
+
+namespace
+{
+
+struct implementation
+{
+    explicit implementation(const std::string& path)
+    :library{path}
+    ,name{path}
+    {
+        arCreateVirtualMachine  = library.load<PFN_arCreateVirtualMachine>("arCreateVirtualMachine");
+        arCreateProcessor       = library.load<PFN_arCreateProcessor>("arCreateProcessor");
+        arRunProcessor          = library.load<PFN_arRunProcessor>("arRunProcessor");
+        arSaveState             = library.load<PFN_arSaveState>("arSaveState");
+        arDestroyVirtualMachine = library.load<PFN_arDestroyVirtualMachine>("arDestroyVirtualMachine");
+        arDestroyProcessor      = library.load<PFN_arDestroyProcessor>("arDestroyProcessor");
+    }
+
+    nes::shared_library library;
+    std::string name;
+
+    PFN_arCreateVirtualMachine  arCreateVirtualMachine{};
+    PFN_arCreateProcessor       arCreateProcessor{};
+    PFN_arRunProcessor          arRunProcessor{};
+    PFN_arSaveState             arSaveState{};
+    PFN_arDestroyVirtualMachine arDestroyVirtualMachine{};
+    PFN_arDestroyProcessor      arDestroyProcessor{};
+};
+
+//Random K1 programs: loops of ALU, load/store and compare operations over r0 to r15, forward branches and jumps with
+//their delay slot, memory accesses based on r60 to r63 which every loop iteration resets
+class program_generator
+{
+public:
+    explicit program_generator(std::uint64_t seed)
+    :m_engine{seed}
+    {
+
+    }
+
+    std::string generate()
+    {
+        m_output.clear();
+        m_label = 0;
+
+        line("movei r50,0");
+        line("nop");
+
+        const auto loops{2 + below(3)};
+        for(std::uint32_t loop{}; loop < loops; ++loop)
+        {
+            line("movei r51," + std::to_string(3 + below(57)));
+            line("nop");
+            m_output += "L" + std::to_string(loop) + ":\n";
+
+            for(std::uint32_t i{}; i < 4; ++i)
+            {
+                line("movei r" + std::to_string(60 + i) + "," + std::to_string(below(1000)));
+            }
+
+            const auto segments{1 + below(3)};
+            for(std::uint32_t segment{}; segment < segments; ++segment)
+            {
+                bundles(1 + below(13));
+
+                if(below(10) < 6)
+                {
+                    const auto label{"F" + std::to_string(++m_label)};
+
+                    line(compare());
+                    line(second());
+                    line((below(10) < 7 ? std::string{branches[below(std::size(branches))]} : std::string{"jmp"}) + " " + label);
+                    line(second());
+                    bundles(1); //delay slot
+                    bundles(below(4));
+                    m_output += label + ":\n";
+                }
+            }
+
+            line("subq r51,1");
+            line(second());
+            line("cmpi r51,0");
+            line(second());
+            line("bne L" + std::to_string(loop));
+            line(second());
+            bundles(1);
+        }
+
+        line("addq r50,1");
+        line("nop");
+        line("jmp 0");
+        line("nop");
+        line("nop");
+        line("nop");
+
+        return m_output;
+    }
+
+private:
+    static constexpr const char* sizes[]{"b", "w", "l", "q"};
+    static constexpr const char* alu[]{"add", "sub", "muls", "mulu", "divs", "divu", "and", "or", "xor", "asl", "lsl", "asr", "lsr"};
+    static constexpr const char* branches[]{"bne", "beq", "bl", "ble", "bg", "bge", "bls", "bles", "bgs", "bges"};
+    static constexpr std::uint32_t immediates[]{0, 1, 2, 3, 7, 31, 63, 255, 1023};
+    static constexpr std::uint32_t quick_immediates[]{0, 1, 2, 5, 63, 65535};
+
+    //The distributions of <random> are implementation-defined, the programs must not depend on the standard library
+    std::uint32_t below(std::size_t count)
+    {
+        return static_cast<std::uint32_t>(m_engine() % count);
+    }
+
+    //Operands are drawn one statement at a time, the order of evaluation of function arguments is unspecified
+    std::string reg()
+    {
+        return "r" + std::to_string(below(16));
+    }
+
+    std::string size()
+    {
+        return sizes[below(std::size(sizes))];
+    }
+
+    std::string address()
+    {
+        const auto offset{below(256)};
+        const auto base{60 + below(4)};
+        const auto increment{below(2)};
+
+        char text[32];
+        std::snprintf(text, sizeof(text), "$%X[r%u%s]", offset, base, increment ? "+" : "");
+
+        return text;
+    }
+
+    std::string arithmetic()
+    {
+        const auto kind{below(10)};
+        std::string output{alu[below(std::size(alu))]};
+
+        if(kind < 4)
+        {
+            output += "." + size();
+            output += " " + reg();
+            output += "," + reg();
+            output += "," + reg();
+        }
+        else if(kind < 6)
+        {
+            const auto choice{below(std::size(immediates) + 1)};
+            const auto value{choice < std::size(immediates) ? immediates[choice] : below(1024)};
+
+            output += "i." + size();
+            output += " " + reg();
+            output += "," + reg();
+            output += "," + std::to_string(value);
+        }
+        else if(kind < 8)
+        {
+            const auto choice{below(std::size(quick_immediates) + 1)};
+            const auto value{choice < std::size(quick_immediates) ? quick_immediates[choice] : below(65536)};
+
+            output += "q." + size();
+            output += " " + reg();
+            output += "," + std::to_string(value);
+        }
+        else if(kind < 9)
+        {
+            output = "movei " + reg();
+            output += "," + std::to_string(below(1u << 22));
+        }
+        else
+        {
+            output = "move." + size();
+            output += " " + reg();
+            output += "," + reg();
+        }
+
+        return output;
+    }
+
+    std::string memory()
+    {
+        static constexpr const char* names[]{"ldm.", "ldm.", "ldm.", "stm.", "stm.", "ldc.", "stc."};
+
+        const auto kind{below(8)};
+        std::string output{};
+
+        if(kind < std::size(names))
+        {
+            output = names[kind] + size();
+            output += " " + reg();
+        }
+        else if(below(2))
+        {
+            output = "ldmf f" + std::to_string(below(8));
+        }
+        else
+        {
+            output = "stmd d" + std::to_string(below(8));
+        }
+
+        output += "," + address();
+
+        return output;
+    }
+
+    std::string compare()
+    {
+        std::string output{};
+
+        if(below(2))
+        {
+            output = "cmp." + size();
+            output += " " + reg();
+            output += "," + reg();
+        }
+        else
+        {
+            output = "cmpi." + size();
+            output += " " + reg();
+            output += "," + std::to_string(below(2) ? below(1u << 20) : below(4));
+        }
+
+        return output;
+    }
+
+    //The first op-code of a bundle may compare, the second may not
+    std::string first()
+    {
+        switch(below(5))
+        {
+            case 0: case 1: return arithmetic();
+            case 2:         return memory();
+            case 3:         return compare();
+            default:        return "nop";
+        }
+    }
+
+    std::string second()
+    {
+        switch(below(4))
+        {
+            case 0: case 1: return arithmetic();
+            case 2:         return memory();
+            default:        return "nop";
+        }
+    }
+
+    void bundles(std::uint32_t count)
+    {
+        for(std::uint32_t i{}; i < count; ++i)
+        {
+            line(first());
+            line(second());
+        }
+    }
+
+    void line(const std::string& text)
+    {
+        m_output += '\t';
+        m_output += text;
+        m_output += '\n';
+    }
+
+    std::mt19937_64 m_engine;
+    std::string m_output{};
+    std::uint32_t m_label{};
+};
+
+std::vector<std::uint32_t> read_binary(const std::filesystem::path& path)
+{
+    std::ifstream ifs{path, std::ios_base::binary};
+    if(!ifs)
+    {
+        throw std::runtime_error{"Can not find file \"" + path.string() + "\"."};
+    }
+
+    std::vector<std::uint32_t> output{};
+    output.resize(std::filesystem::file_size(path) / 4u);
+
+    const auto bytes_size{static_cast<std::streamsize>(std::size(output) * 4)};
+    if(ifs.read(reinterpret_cast<char*>(std::data(output)), bytes_size).gcount() != bytes_size)
+    {
+        throw std::runtime_error{"Can not read file \"" + path.string() + "\"."};
+    }
+
+    return output;
+}
+
+/// \brief Runs a binary for a number of cycles and returns the saved state of the virtual machine
+///
+/// The cycles are split into budgets drawn from seed, mostly short ones so that superblocks and compiled code are left
+/// and entered again in the middle of loops. A seed of 0 runs all of them in a single budget.
+std::vector<std::uint8_t> run(const implementation& impl, const std::vector<std::uint32_t>& code, std::uint64_t cycles, std::uint64_t seed)
+{
+    ArVirtualMachineCreateInfo machine_info{};
+    machine_info.sType = AR_STRUCTURE_TYPE_VIRTUAl_MACHINE_CREATE_INFO;
+
+    ArVirtualMachine machine{};
+    if(impl.arCreateVirtualMachine(&machine, &machine_info) != AR_SUCCESS)
+    {
+        throw std::runtime_error{"Can not create virtual machine."};
+    }
+
+    ArProcessorCreateInfo processor_info{};
+    processor_info.sType = AR_STRUCTURE_TYPE_PROCESSOR_CREATE_INFO;
+    processor_info.pBootCode = std::data(code);
+    processor_info.bootCodeSize = static_cast<std::uint32_t>(std::size(code));
+
+    ArProcessor processor{};
+    if(impl.arCreateProcessor(machine, &processor_info, &processor) != AR_SUCCESS)
+    {
+        impl.arDestroyVirtualMachine(machine);
+        throw std::runtime_error{"Can not create processor."};
+    }
+
+    std::mt19937_64 engine{seed};
+    for(std::uint64_t done{}; done < cycles;)
+    {
+        std::uint64_t budget{cycles - done};
+        if(seed)
+        {
+            const auto value{engine()};
+            budget = std::min(budget, value % 4 == 0 ? 1 + value % 7 : 1 + value % 3000);
+        }
+
+        std::uint64_t executed{};
+        if(impl.arRunProcessor(processor, budget, &executed) != AR_SUCCESS || executed == 0)
+        {
+            break;
+        }
+
+        done += executed;
+    }
+
+    std::uint64_t size{};
+    std::vector<std::uint8_t> output{};
+    if(impl.arSaveState(machine, &size, nullptr) == AR_SUCCESS)
+    {
+        output.resize(size);
+        if(impl.arSaveState(machine, &size, std::data(output)) != AR_SUCCESS)
+        {
+            output.clear();
+        }
+    }
+
+    impl.arDestroyProcessor(machine, processor);
+    impl.arDestroyVirtualMachine(machine);
+
+    if(std::empty(output))
+    {
+        throw std::runtime_error{"Can not save state."};
+    }
+
+    //The third word of the state is the size of the processor, which differs between the implementations
+    std::memset(std::data(output) + 8, 0, 4);
+
+    return output;
+}
+
+//Every implementation, with split budgets, must reach the state the first one reaches in a single budget
+int compare(const std::vector<std::string_view>& args)
+{
+    if(std::size(args) < 5)
+    {
+        throw std::runtime_error{"Usage: altair_vm_differential -compare [cycles] [library...] -- [path_to_binary...]"};
+    }
+
+    const auto cycles{std::stoull(std::string{args[2]})};
+
+    std::vector<implementation> implementations{};
+    auto it{std::cbegin(args) + 3};
+    for(; it != std::cend(args) && *it != "--"; ++it)
+    {
+        implementations.emplace_back(std::string{*it});
+    }
+
+    if(std::empty(implementations) || it == std::cend(args))
+    {
+        throw std::runtime_error{"Missing libraries or binaries."};
+    }
+
+    constexpr std::uint64_t seeds[]{1, 2, 3};
+
+    int failures{};
+    for(++it; it != std::cend(args); ++it)
+    {
+        const auto code{read_binary(*it)};
+        const auto reference{run(implementations.front(), code, cycles, 0)};
+
+        for(auto&& impl : implementations)
+        {
+            for(auto&& seed : seeds)
+            {
+                const auto state{run(impl, code, cycles, seed)};
+                if(state != reference)
+                {
+                    const auto difference{std::mismatch(std::cbegin(state), std::cend(state), std::cbegin(reference), std::cend(reference))};
+
+                    std::cout << *it << ": " << impl.name << " with budgets of seed " << seed << " differs from "
+                              << implementations.front().name << " at byte " << (difference.first - std::cbegin(state)) << std::endl;
+                    ++failures;
+                }
+            }
+        }
+    }
+
+    return failures ? 1 : 0;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        std::cout.sync_with_stdio(false);
+
+        std::vector<std::string_view> args{};
+        args.reserve(static_cast<std::size_t>(argc));
+        for(int i{}; i < argc; ++i)
+        {
+            args.emplace_back(argv[i]);
+        }
+
+        if(std::size(args) == 4 && args[1] == "-generate")
+        {
+            std::ofstream ofs{std::string{args[3]}};
+            if(!ofs)
+            {
+                throw std::runtime_error{"Can not write file \"" + std::string{args[3]} + "\"."};
+            }
+
+            ofs << program_generator{std::stoull(std::string{args[2]})}.generate();
+
+            return 0;
+        }
+
+        if(std::size(args) >= 2 && args[1] == "-compare")
+        {
+            return compare(args);
+        }
+
+        throw std::runtime_error{"Usage: altair_vm_differential -generate [seed] [path_to_source]\n"
+                                 "       altair_vm_differential -compare [cycles] [library...] -- [path_to_binary...]"};
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+
+        return 1;
+    }
+}
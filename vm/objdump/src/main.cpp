@@ -0,0 +1,127 @@
+#include <isa.h>
+
+#include <iostream>
+#include <stdexcept>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <algorithm>
+#include <vector>
+#include <cstdio>
+
+namespace
+{
+
+std::vector<std::uint32_t> read_binary(const std::filesystem::path& path)
+{
+    std::ifstream ifs{path, std::ios_base::binary};
+    if(!ifs)
+    {
+        throw std::runtime_error{"Can not find file \"" + path.string() + "\"."};
+    }
+
+    std::vector<std::uint32_t> output{};
+    output.resize(std::filesystem::file_size(path) / 4u);
+
+    const auto bytes_size{static_cast<std::streamsize>(std::size(output) * 4)};
+    if(ifs.read(reinterpret_cast<char*>(std::data(output)), bytes_size).gcount() != bytes_size)
+    {
+        throw std::runtime_error{"Can not read file \"" + path.string() + "\"."};
+    }
+
+    return output;
+}
+
+bool has_xchg(std::uint32_t pc, const std::uint32_t* opcodes, std::uint32_t size)
+{
+    for(std::uint32_t i{}; i < size; ++i)
+    {
+        Operation op{};
+        if(isaDecodeOperation(i, pc, opcodes[i], &op) && op.op == OPCODE_XCHG)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+//Linear sweep from the start of the binary, XCHG flips the bundle size after its delay slot as on the processor
+void print_binary(const std::vector<std::uint32_t>& binary, bool wide)
+{
+    std::cout << "     pc  op-codes                              assembly\n";
+
+    std::uint32_t switch_after{}; //bundles to decode before the XCHG takes effect, 0 if none is pending
+    char line[512];
+
+    for(std::uint32_t pc{}; pc < std::size(binary);)
+    {
+        const std::uint32_t remaining{static_cast<std::uint32_t>(std::size(binary)) - pc};
+        const std::uint32_t size{std::min(wide ? 4u : 2u, remaining)};
+
+        int length{std::snprintf(line, sizeof(line), "  %5u ", static_cast<unsigned>(pc))};
+        for(std::uint32_t i{}; i < 4; ++i)
+        {
+            length += std::snprintf(line + length, sizeof(line) - static_cast<std::size_t>(length), i < size ? " %08x" : "         ",
+                                    i < size ? static_cast<unsigned>(binary[pc + i]) : 0u);
+        }
+
+        std::cout << line << "  ";
+
+        isaDisassembleBundle(pc, std::data(binary) + pc, size, line, sizeof(line));
+        std::cout << line << '\n';
+
+        if(switch_after && --switch_after == 0)
+        {
+            wide = !wide;
+        }
+
+        if(has_xchg(pc, std::data(binary) + pc, size))
+        {
+            switch_after = 1;
+        }
+
+        pc += size;
+    }
+
+    std::cout << std::flush;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        std::cout.sync_with_stdio(false);
+
+        if(argc < 2)
+        {
+            throw std::runtime_error{"Usage: k1objdump [path_to_binary] [-wide]"};
+        }
+
+        bool wide{};
+        for(int i{2}; i < argc; ++i)
+        {
+            const std::string_view option{argv[i]};
+
+            if(option == "-wide") //the first bundle has 4 opcodes, as if XCHG was already set
+            {
+                wide = true;
+            }
+            else
+            {
+                throw std::runtime_error{"Unknown option \"" + std::string{option} + "\"."};
+            }
+        }
+
+        print_binary(read_binary(argv[1]), wide);
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+
+        return 1;
+    }
+}
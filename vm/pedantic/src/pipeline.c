@@ -0,0 +1,432 @@
+#include "pipeline.h"
+
+//Scoreboard slots: the integer registers, then every float of the float registers, then the flags and the accumulator
+#define IREG_SLOT(index)  ((uint32_t)(index) & (IREG_COUNT - 1u))
+#define FREG_SLOT(index)  (IREG_COUNT + ((uint32_t)(index) & (FREG_COUNT - 1u)))
+#define VREG_SLOT(index)  FREG_SLOT((uint32_t)(index) * 4u)
+#define DREG_SLOT(index)  FREG_SLOT((uint32_t)(index) * 2u)
+#define FLAGS_SLOT        (IREG_COUNT + FREG_COUNT)
+#define ACCUMULATOR_SLOT  (IREG_COUNT + FREG_COUNT + 1u)
+
+#define MAX_READS  (12u)
+#define MAX_WRITES (5u)
+
+#define DIVIDER_BUSY       (3u) //the divider is not pipelined
+#define FLOAT_DIVIDER_BUSY (6u) //neither is the FDIV unit, an operation holds its six fdiv stages
+
+/// \brief The registers read and written by an operation
+typedef struct Access
+{
+    uint16_t reads[MAX_READS];
+    uint16_t writes[MAX_WRITES];
+    uint32_t readCount;
+    uint32_t writeCount;
+    uint32_t latency; //< the latency of the writes
+    uint32_t cause; //< the ArStallCause of a bundle waiting for the writes
+    int32_t increment; //< the slot of the base register incremented by the AGU, -1 if none
+    uint32_t divide; //< 1 if the operation needs the divider
+    uint32_t floatDivide; //< 1 if the operation needs the FDIV unit
+} Access;
+
+static void readSlots(Access* restrict access, uint32_t first, uint32_t count)
+{
+    for(uint32_t i = 0; i < count; ++i)
+    {
+        access->reads[access->readCount++] = (uint16_t)(first + i);
+    }
+}
+
+static void writeSlots(Access* restrict access, uint32_t first, uint32_t count, uint32_t latency)
+{
+    for(uint32_t i = 0; i < count; ++i)
+    {
+        access->writes[access->writeCount++] = (uint16_t)(first + i);
+    }
+
+    access->latency = latency;
+}
+
+//Loads and stores of LSU, the value register is an integer one or 1, 2 or 4 consecutive floats
+static void describeMemory(const Operation* restrict op, Access* restrict access, uint32_t value, uint32_t count, int store, uint32_t latency)
+{
+    readSlots(access, IREG_SLOT(op->operands[1]), 1);
+
+    if(store)
+    {
+        readSlots(access, value, count);
+    }
+    else
+    {
+        writeSlots(access, value, count, latency);
+        access->cause = AR_STALL_CAUSE_LOAD_USE;
+    }
+
+    if(op->data)
+    {
+        access->increment = (int32_t)IREG_SLOT(op->operands[1]);
+    }
+}
+
+static void describe(const Operation* restrict op, Access* restrict access)
+{
+    const uint8_t* const operands = op->operands;
+
+    access->readCount = 0;
+    access->writeCount = 0;
+    access->latency = 0;
+    access->cause = AR_STALL_CAUSE_DEPENDENCY;
+    access->increment = -1;
+    access->divide = 0;
+    access->floatDivide = 0;
+
+    if(op->op >= OPCODE_ADD && op->op <= OPCODE_LSRQ)
+    {
+        const uint32_t form = (uint32_t)(op->op - OPCODE_ADD) % 3u; //REG = REG OP REG, REG = REG OP IMM, REG OP= IMM
+
+        uint32_t latency = LATENCY_ALU;
+        if(op->op >= OPCODE_MULS && op->op <= OPCODE_MULUQ)
+        {
+            latency = LATENCY_MUL;
+        }
+        else if(op->op >= OPCODE_DIVS && op->op <= OPCODE_DIVUQ)
+        {
+            latency = LATENCY_DIV;
+            access->divide = 1;
+        }
+
+        if(form == 0)
+        {
+            readSlots(access, IREG_SLOT(operands[0]), 1);
+            readSlots(access, IREG_SLOT(operands[1]), 1);
+        }
+        else
+        {
+            readSlots(access, IREG_SLOT(operands[form]), 1);
+        }
+
+        writeSlots(access, IREG_SLOT(operands[2]), 1, latency);
+        return;
+    }
+
+    switch(op->op)
+    {
+        default: //NOP, XCHG, WAIT, JMP, CALL, JMPR, CALLR
+            break;
+
+        case OPCODE_LDDMA:  //fallthrough
+        case OPCODE_STDMA:  //fallthrough
+        case OPCODE_LDDMAR: //fallthrough
+        case OPCODE_STDMAR: //fallthrough
+        case OPCODE_DMAIR:
+            readSlots(access, IREG_SLOT(operands[0]), 1);
+            readSlots(access, IREG_SLOT(operands[1]), 1);
+            break;
+
+        case OPCODE_LDM:  //fallthrough
+        case OPCODE_LDMX: describeMemory(op, access, IREG_SLOT(operands[2]),       1, 0, LATENCY_LOAD);  break;
+        case OPCODE_STM:  //fallthrough
+        case OPCODE_STMX: describeMemory(op, access, IREG_SLOT(operands[2]),       1, 1, 0);             break;
+        case OPCODE_LDC:  describeMemory(op, access, IREG_SLOT(operands[2]),       1, 0, LATENCY_CACHE); break;
+        case OPCODE_STC:  describeMemory(op, access, IREG_SLOT(operands[2]),       1, 1, 0);             break;
+        case OPCODE_LDMV: describeMemory(op, access, FREG_SLOT(operands[2] * 4u),  4, 0, LATENCY_LOAD);  break;
+        case OPCODE_STMV: describeMemory(op, access, FREG_SLOT(operands[2] * 4u),  4, 1, 0);             break;
+        case OPCODE_LDCV: describeMemory(op, access, FREG_SLOT(operands[2] * 4u),  4, 0, LATENCY_CACHE); break;
+        case OPCODE_STCV: describeMemory(op, access, FREG_SLOT(operands[2] * 4u),  4, 1, 0);             break;
+        case OPCODE_LDMF: describeMemory(op, access, FREG_SLOT(operands[2]),       1, 0, LATENCY_LOAD);  break;
+        case OPCODE_STMF: describeMemory(op, access, FREG_SLOT(operands[2]),       1, 1, 0);             break;
+        case OPCODE_LDCF: describeMemory(op, access, FREG_SLOT(operands[2]),       1, 0, LATENCY_CACHE); break;
+        case OPCODE_STCF: describeMemory(op, access, FREG_SLOT(operands[2]),       1, 1, 0);             break;
+        case OPCODE_LDMD: describeMemory(op, access, FREG_SLOT(operands[2] * 2u),  2, 0, LATENCY_LOAD);  break;
+        case OPCODE_STMD: describeMemory(op, access, FREG_SLOT(operands[2] * 2u),  2, 1, 0);             break;
+        case OPCODE_LDCD: describeMemory(op, access, FREG_SLOT(operands[2] * 2u),  2, 0, LATENCY_CACHE); break;
+        case OPCODE_STCD: describeMemory(op, access, FREG_SLOT(operands[2] * 2u),  2, 1, 0);             break;
+
+        case OPCODE_IN:
+            writeSlots(access, IREG_SLOT(operands[2]), 1, LATENCY_LOAD);
+            access->cause = AR_STALL_CAUSE_LOAD_USE;
+            break;
+
+        case OPCODE_OUT: //fallthrough
+        case OPCODE_OUTI:
+            readSlots(access, IREG_SLOT(operands[2]), 1);
+            break;
+
+        case OPCODE_MOVEI:
+            writeSlots(access, IREG_SLOT(operands[2]), 1, LATENCY_ALU);
+            break;
+
+        case OPCODE_BNE:  //fallthrough
+        case OPCODE_BEQ:  //fallthrough
+        case OPCODE_BL:   //fallthrough
+        case OPCODE_BLE:  //fallthrough
+        case OPCODE_BG:   //fallthrough
+        case OPCODE_BGE:  //fallthrough
+        case OPCODE_BLS:  //fallthrough
+        case OPCODE_BLES: //fallthrough
+        case OPCODE_BGS:  //fallthrough
+        case OPCODE_BGES: //fallthrough
+        case OPCODE_RET:
+            readSlots(access, FLAGS_SLOT, 1);
+            break;
+
+        case OPCODE_CMP:
+            readSlots(access, IREG_SLOT(operands[0]), 1);
+            readSlots(access, IREG_SLOT(operands[1]), 1);
+            writeSlots(access, FLAGS_SLOT, 1, LATENCY_ALU);
+            break;
+
+        case OPCODE_CMPI:
+            readSlots(access, IREG_SLOT(operands[1]), 1);
+            writeSlots(access, FLAGS_SLOT, 1, LATENCY_ALU);
+            break;
+
+        case OPCODE_FCMP:
+            readSlots(access, FREG_SLOT(operands[0]), 1);
+            readSlots(access, FREG_SLOT(operands[1]), 1);
+            writeSlots(access, FLAGS_SLOT, 1, LATENCY_FLOAT);
+            break;
+
+        case OPCODE_FCMPI:
+            readSlots(access, FREG_SLOT(operands[1]), 1);
+            writeSlots(access, FLAGS_SLOT, 1, LATENCY_FLOAT);
+            break;
+
+        case OPCODE_DCMP:
+            readSlots(access, FREG_SLOT(operands[0] * 2u), 2);
+            readSlots(access, FREG_SLOT(operands[1] * 2u), 2);
+            writeSlots(access, FLAGS_SLOT, 1, LATENCY_FLOAT);
+            break;
+
+        case OPCODE_DCMPI:
+            readSlots(access, FREG_SLOT(operands[1] * 2u), 2);
+            writeSlots(access, FLAGS_SLOT, 1, LATENCY_FLOAT);
+            break;
+
+        //VFPU, a vector operation only reads and writes the op->size + 1 first floats of its vector registers
+        case OPCODE_FMULADD:
+            readSlots(access, VREG_SLOT(operands[2]), op->size + 1u);
+            //fallthrough
+        case OPCODE_FADD: //fallthrough
+        case OPCODE_FSUB: //fallthrough
+        case OPCODE_FMUL:
+            readSlots(access, VREG_SLOT(operands[0]), op->size + 1u);
+            readSlots(access, VREG_SLOT(operands[1]), op->size + 1u);
+            writeSlots(access, VREG_SLOT(operands[2]), op->size + 1u, LATENCY_FLOAT);
+            break;
+
+        case OPCODE_FMULADDV:
+            readSlots(access, VREG_SLOT(operands[2]), op->size + 1u);
+            //fallthrough
+        case OPCODE_FADDV: //fallthrough
+        case OPCODE_FSUBV: //fallthrough
+        case OPCODE_FMULV:
+            readSlots(access, FREG_SLOT(operands[0]), 1);
+            readSlots(access, VREG_SLOT(operands[1]), op->size + 1u);
+            writeSlots(access, VREG_SLOT(operands[2]), op->size + 1u, LATENCY_FLOAT);
+            break;
+
+        case OPCODE_FMULADDVA:
+            readSlots(access, ACCUMULATOR_SLOT, 1);
+            //fallthrough
+        case OPCODE_FMULVA:
+            readSlots(access, FREG_SLOT(operands[0]), 1);
+            readSlots(access, VREG_SLOT(operands[1]), op->size + 1u);
+            writeSlots(access, ACCUMULATOR_SLOT, 1, LATENCY_FLOAT);
+            break;
+
+        case OPCODE_FMULADDVAO:
+            readSlots(access, ACCUMULATOR_SLOT, 1);
+            readSlots(access, FREG_SLOT(operands[0]), 1);
+            readSlots(access, VREG_SLOT(operands[1]), op->size + 1u);
+            writeSlots(access, VREG_SLOT(operands[2]), op->size + 1u, LATENCY_FLOAT);
+            break;
+
+        case OPCODE_FIPR:
+            readSlots(access, VREG_SLOT(operands[1]), op->size + 1u);
+            readSlots(access, VREG_SLOT(operands[2]), op->size + 1u);
+            writeSlots(access, FREG_SLOT(operands[0]), 1, LATENCY_FLOAT);
+            break;
+
+        case OPCODE_MOVEV:
+            readSlots(access, VREG_SLOT(operands[1]), op->size + 1u);
+            writeSlots(access, VREG_SLOT(operands[2]), op->size + 1u, LATENCY_FLOAT);
+            break;
+
+        case OPCODE_MOVEFD:
+            readSlots(access, DREG_SLOT(operands[1]), 2);
+            writeSlots(access, FREG_SLOT(operands[2]), 1, LATENCY_FLOAT);
+            break;
+
+        case OPCODE_MOVEDF:
+            readSlots(access, FREG_SLOT(operands[1]), 1);
+            writeSlots(access, DREG_SLOT(operands[2]), 2, LATENCY_FLOAT);
+            break;
+
+        case OPCODE_ITOFV:
+            readSlots(access, IREG_SLOT(operands[1]), 1);
+            writeSlots(access, VREG_SLOT(operands[2]), op->size + 1u, LATENCY_FLOAT);
+            break;
+
+        case OPCODE_FTOIV: //the fixed-point values which are not converted are kept
+            readSlots(access, VREG_SLOT(operands[1]), op->size + 1u);
+            readSlots(access, IREG_SLOT(operands[2]), 1);
+            writeSlots(access, IREG_SLOT(operands[2]), 1, LATENCY_FLOAT);
+            break;
+
+        case OPCODE_ITOF:
+            readSlots(access, IREG_SLOT(operands[1]), 1);
+            writeSlots(access, FREG_SLOT(operands[2]), 1, LATENCY_FLOAT);
+            break;
+
+        case OPCODE_FTOI:
+            readSlots(access, FREG_SLOT(operands[1]), 1);
+            writeSlots(access, IREG_SLOT(operands[2]), 1, LATENCY_FLOAT);
+            break;
+
+        case OPCODE_DMULADD:
+            readSlots(access, DREG_SLOT(operands[2]), 2);
+            //fallthrough
+        case OPCODE_DADD: //fallthrough
+        case OPCODE_DSUB: //fallthrough
+        case OPCODE_DMUL:
+            readSlots(access, DREG_SLOT(operands[0]), 2);
+            readSlots(access, DREG_SLOT(operands[1]), 2);
+            writeSlots(access, DREG_SLOT(operands[2]), 2, LATENCY_FLOAT);
+            break;
+
+        case OPCODE_ITOD:
+            readSlots(access, IREG_SLOT(operands[1]), 1);
+            writeSlots(access, DREG_SLOT(operands[2]), 2, LATENCY_FLOAT);
+            break;
+
+        case OPCODE_DTOI:
+            readSlots(access, DREG_SLOT(operands[1]), 2);
+            writeSlots(access, IREG_SLOT(operands[2]), 1, LATENCY_FLOAT);
+            break;
+
+        case OPCODE_MOVEFI:
+            writeSlots(access, FREG_SLOT(operands[2]), 1, LATENCY_ALU);
+            break;
+
+        case OPCODE_MOVEDI:
+            writeSlots(access, DREG_SLOT(operands[2]), 2, LATENCY_ALU);
+            break;
+
+        case OPCODE_MOVEVI:
+            writeSlots(access, VREG_SLOT(operands[2]), 4, LATENCY_ALU);
+            break;
+
+        //VDIV
+        case OPCODE_FDIV:
+            readSlots(access, FREG_SLOT(operands[0]), 1);
+            //fallthrough
+        case OPCODE_FSQRT:
+            readSlots(access, FREG_SLOT(operands[1]), 1);
+            writeSlots(access, FREG_SLOT(operands[2]), 1, LATENCY_FDIV);
+            access->floatDivide = 1;
+            break;
+
+        case OPCODE_DDIV:
+            readSlots(access, DREG_SLOT(operands[0]), 2);
+            //fallthrough
+        case OPCODE_DSQRT:
+            readSlots(access, DREG_SLOT(operands[1]), 2);
+            writeSlots(access, DREG_SLOT(operands[2]), 2, LATENCY_FDIV);
+            access->floatDivide = 1;
+            break;
+    }
+}
+
+uint64_t pipelineStall(ArProcessor processor, uint32_t pc, const Operation* operations, uint32_t size, uint64_t now)
+{
+    uint64_t ready = now;
+    uint32_t cause = AR_STALL_CAUSE_DEPENDENCY;
+    uint32_t reg = STALL_NO_REGISTER;
+
+    for(uint32_t i = 0; i < size; ++i)
+    {
+        Access access;
+        describe(&operations[i], &access);
+
+        for(uint32_t j = 0; j < access.readCount; ++j)
+        {
+            const uint32_t slot = access.reads[j];
+            if(processor->registerReady[slot] > ready)
+            {
+                ready = processor->registerReady[slot];
+                cause = processor->registerCause[slot];
+                reg = slot;
+            }
+        }
+
+        if(access.divide && processor->dividerReady > ready)
+        {
+            ready = processor->dividerReady;
+            cause = AR_STALL_CAUSE_DIVIDER;
+            reg = STALL_NO_REGISTER;
+        }
+
+        if(access.floatDivide && processor->floatDividerReady > ready)
+        {
+            ready = processor->floatDividerReady;
+            cause = AR_STALL_CAUSE_DIVIDER;
+            reg = STALL_NO_REGISTER;
+        }
+    }
+
+    if(ready == now)
+    {
+        return 0;
+    }
+
+    if(!processor->pipelineStalled)
+    {
+        processor->pipelineStalled = 1;
+        ++processor->pipelineHazards;
+
+        recordStall(processor, pc, (ArStallCause)cause, reg, ready - now);
+    }
+
+    return ready - now;
+}
+
+//Results are written back in order, a later write never makes a register ready earlier
+static void writeBack(ArProcessor restrict processor, uint32_t slot, uint64_t ready, uint32_t cause)
+{
+    if(ready > processor->registerReady[slot])
+    {
+        processor->registerReady[slot] = ready;
+        processor->registerCause[slot] = (uint8_t)cause;
+    }
+}
+
+void pipelineIssue(ArProcessor processor, const Operation* operations, uint32_t size, uint64_t now)
+{
+    for(uint32_t i = 0; i < size; ++i)
+    {
+        Access access;
+        describe(&operations[i], &access);
+
+        for(uint32_t j = 0; j < access.writeCount; ++j)
+        {
+            writeBack(processor, access.writes[j], now + access.latency, access.cause);
+        }
+
+        if(access.increment >= 0)
+        {
+            writeBack(processor, (uint32_t)access.increment, now + LATENCY_ALU, AR_STALL_CAUSE_DEPENDENCY);
+        }
+
+        if(access.divide)
+        {
+            processor->dividerReady = now + DIVIDER_BUSY;
+        }
+
+        if(access.floatDivide)
+        {
+            processor->floatDividerReady = now + FLOAT_DIVIDER_BUSY;
+        }
+    }
+
+    processor->pipelineStalled = 0;
+}
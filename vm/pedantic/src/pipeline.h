@@ -0,0 +1,25 @@
+#ifndef ALTAIR_VM_PIPELINE_H_DEFINED
+#define ALTAIR_VM_PIPELINE_H_DEFINED
+
+#include "vm.h"
+
+//Cycles from the issue of an operation to the first bundle which can read its result, see Pipeline.txt
+#define LATENCY_ALU   (3u) //rr, exe, wb
+#define LATENCY_MUL   (4u) //rr, exe, exe, wb
+#define LATENCY_DIV   (5u) //rr, div, div, div, wb
+#define LATENCY_LOAD  (4u) //rr, exe, mem, wb
+#define LATENCY_CACHE (5u) //rr, exe, mem, mem, wb
+#define LATENCY_FLOAT (5u) //rr, fexe, fexe, fexe, wb
+#define LATENCY_FDIV  (8u) //rr, fdiv x6, wb
+#define LATENCY_DMA   (6u) //rr, exe, mem, dma, ---, edma, the default latency of the DMA engine
+
+/// \brief Get the number of cycles the bundle at pc has to wait in RR for the registers and the dividers it needs
+///
+/// A bundle which has to wait is counted as one hazard and its whole stall is recorded by recordStall, however many
+/// calls it takes to issue it
+uint64_t pipelineStall(ArProcessor processor, uint32_t pc, const Operation* operations, uint32_t size, uint64_t now);
+
+/// \brief Record the results of a bundle issued at the cycle now in the scoreboard
+void pipelineIssue(ArProcessor processor, const Operation* operations, uint32_t size, uint64_t now);
+
+#endif
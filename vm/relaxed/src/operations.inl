@@ -0,0 +1,462 @@
+//Execution of every operation kernel, expanded by the includer through OPERATION(name, body...)
+//
+//The body sees processor, op, operands, index, ireg, freg, dreg, vreg and the masks of executeOperations,
+//and may return an ArResult to stop the bundle
+
+//The program counter already points to the next bundle
+#define DMA_OPERATION(name) OPERATION(name, \
+    processor->dma = 1; \
+    processor->dmaOperation = *op; \
+    processor->dmaPc = processor->pc - opcodeSetSize(processor->flags, processor->pc); \
+)
+
+#define DELAYED_OPERATION(name) OPERATION(name, \
+    processor->delayedBits |= (1u << index); \
+    processor->delayed[index] = *op; \
+)
+
+//Results are computed in U, at least 32 bits wide so that nothing is promoted to int, then truncated to T
+#define ALU_KERNEL(name, T, U, S, W, left, right, expression) OPERATION(name, \
+    const U a = (T)(left); \
+    const U b = (T)(right); \
+    const S sa = (S)a; \
+    const S sb = (S)b; \
+    const uint32_t n = (uint32_t)b & (W - 1u); \
+    (void)sa; (void)sb; (void)n; \
+    ireg[operands[2]] = (T)(expression); \
+)
+
+#define ALU_SIZES(name, left, right, expression) \
+    ALU_KERNEL(name##_B, uint8_t,  uint32_t, int8_t,  8,  left, right, expression) \
+    ALU_KERNEL(name##_W, uint16_t, uint32_t, int16_t, 16, left, right, expression) \
+    ALU_KERNEL(name##_L, uint32_t, uint32_t, int32_t, 32, left, right, expression) \
+    ALU_KERNEL(name##_Q, uint64_t, uint64_t, int64_t, 64, left, right, expression)
+
+//The cache is a scratchpad indexed by the address, unless the processor models it over the physical memory
+#define CACHE_LOAD(output, bytes) \
+    if(processor->cacheTags) \
+    { \
+        const ArResult result = loadCache(processor, op->imm + ireg[operands[1]], output, bytes); \
+        if(result != AR_SUCCESS) \
+        { \
+            return result; \
+        } \
+    } \
+    else \
+    { \
+        memcpy(output, &processor->cache[op->imm + ireg[operands[1]]], bytes); \
+    }
+
+#define CACHE_STORE(input, bytes) \
+    if(processor->cacheTags) \
+    { \
+        const ArResult result = storeCache(processor, op->imm + ireg[operands[1]], input, bytes); \
+        if(result != AR_SUCCESS) \
+        { \
+            return result; \
+        } \
+    } \
+    else \
+    { \
+        memcpy(&processor->cache[op->imm + ireg[operands[1]]], input, bytes); \
+    }
+
+//The includer may define its own ALU_OPERATION(name, expression) to list the ALU operations instead
+#ifndef ALU_OPERATION
+    #define ALU_OPERATION(name, expression) \
+        ALU_SIZES(name,    ireg[operands[1]], ireg[operands[0]], expression) \
+        ALU_SIZES(name##I, ireg[operands[1]], op->imm,           expression) \
+        ALU_SIZES(name##Q, ireg[operands[2]], op->imm,           expression)
+    #define DEFAULT_ALU_OPERATION
+#endif
+
+OPERATION(UNKNOWN,
+    return AR_ERROR_ILLEGAL_INSTRUCTION;
+)
+
+//AGU
+DMA_OPERATION(LDDMA)
+DMA_OPERATION(STDMA)
+DMA_OPERATION(LDDMAR)
+DMA_OPERATION(STDMAR)
+DMA_OPERATION(DMAIR)
+DMA_OPERATION(WAIT)
+
+//LSU
+OPERATION(LDM, //copy data from dsram to register
+    memcpy(&ireg[operands[2]], &processor->dsram[op->imm + ireg[operands[1]]], 1u << op->size);
+    ireg[operands[1]] += op->data; //incr
+)
+
+OPERATION(STM, //copy data from register to dsram
+    memcpy(&processor->dsram[op->imm + ireg[operands[1]]], &ireg[operands[2]], 1u << op->size);
+    ireg[operands[1]] += op->data; //incr
+)
+
+OPERATION(LDC, //copy data from cache to register
+    CACHE_LOAD(&ireg[operands[2]], 1u << op->size)
+    ireg[operands[1]] += op->data; //incr
+)
+
+OPERATION(STC, //copy data from register to cache
+    CACHE_STORE(&ireg[operands[2]], 1u << op->size)
+    ireg[operands[1]] += op->data; //incr
+)
+
+OPERATION(LDMX, //copy data from dsram to register
+    memcpy(&ireg[operands[2]], &processor->dsram[op->imm + ireg[operands[1]]], 1u << op->size);
+    ireg[operands[1]] += op->data; //incr
+)
+
+OPERATION(STMX, //copy data from register to dsram
+    memcpy(&processor->dsram[op->imm + ireg[operands[1]]], &ireg[operands[2]], 1u << op->size);
+    ireg[operands[1]] += op->data; //incr
+)
+
+OPERATION(IN, //copy data from iosram to register
+    memcpy(&ireg[operands[2]], &processor->iosram[op->imm], 1u << op->size);
+)
+
+OPERATION(OUT, //copy data from register to iosram
+    memcpy(&processor->iosram[op->imm], &ireg[operands[2]], 1u << op->size);
+)
+
+OPERATION(OUTI, //write data to iosram
+    memcpy(&processor->iosram[op->imm], &ireg[operands[2]], 1u << op->size);
+)
+
+OPERATION(LDMV, //copy data from dsram to vector register
+    memcpy(&vreg[operands[2]], &processor->dsram[op->imm + ireg[operands[1]]], 16);
+    ireg[operands[1]] += op->data; //incr
+)
+
+OPERATION(STMV, //copy data from vector register to dsram
+    memcpy(&processor->dsram[op->imm + ireg[operands[1]]], &vreg[operands[2]], 16);
+    ireg[operands[1]] += op->data; //incr
+)
+
+OPERATION(LDCV, //copy data from cache to vector register
+    CACHE_LOAD(&vreg[operands[2]], 16)
+    ireg[operands[1]] += op->data; //incr
+)
+
+OPERATION(STCV, //copy data from vector register to cache
+    CACHE_STORE(&vreg[operands[2]], 16)
+    ireg[operands[1]] += op->data; //incr
+)
+
+OPERATION(LDMF, //copy data from dsram to float register
+    memcpy(&freg[operands[2]], &processor->dsram[op->imm + ireg[operands[1]]], 4);
+    ireg[operands[1]] += op->data; //incr
+)
+
+OPERATION(STMF, //copy data from float register to dsram
+    memcpy(&processor->dsram[op->imm + ireg[operands[1]]], &freg[operands[2]], 4);
+    ireg[operands[1]] += op->data; //incr
+)
+
+OPERATION(LDCF, //copy data from cache to float register
+    CACHE_LOAD(&freg[operands[2]], 4)
+    ireg[operands[1]] += op->data; //incr
+)
+
+OPERATION(STCF, //copy data from float register to cache
+    CACHE_STORE(&freg[operands[2]], 4)
+    ireg[operands[1]] += op->data; //incr
+)
+
+OPERATION(LDMD, //copy data from dsram to double register
+    memcpy(&dreg[operands[2]], &processor->dsram[op->imm + ireg[operands[1]]], 8);
+    ireg[operands[1]] += op->data; //incr
+)
+
+OPERATION(STMD, //copy data from double register to dsram
+    memcpy(&processor->dsram[op->imm + ireg[operands[1]]], &dreg[operands[2]], 8);
+    ireg[operands[1]] += op->data; //incr
+)
+
+OPERATION(LDCD, //copy data from cache to double register
+    CACHE_LOAD(&dreg[operands[2]], 8)
+    ireg[operands[1]] += op->data; //incr
+)
+
+OPERATION(STCD, //copy data from double register to cache
+    CACHE_STORE(&dreg[operands[2]], 8)
+    ireg[operands[1]] += op->data; //incr
+)
+
+//ALU
+OPERATION(NOP, //In case of nop.e, we need to delay it
+    if(op->data)
+    {
+        processor->delayedBits |= (1u << index);
+        processor->delayed[index] = *op;
+    }
+)
+
+DELAYED_OPERATION(XCHG) //Flip XCHG bit
+
+OPERATION(MOVEI, //Write a value to a register
+    ireg[operands[2]] = op->imm;
+)
+
+//Each ALU operation is expanded for its REG = REG OP REG, REG = REG OP IMM and REG OP= IMM forms,
+//and for each operation size: NAME_B, NAME_W, NAME_L, NAME_Q, NAMEI_B, ..., NAMEQ_Q
+//
+//The expression sees a and b, the operands truncated to the size, sa and sb, their signed values,
+//and n, b as a shift count modulo the width
+//
+//A division by zero gives all ones, -1 when signed, and the signed minimum divided by -1 gives the signed minimum
+ALU_OPERATION(ADD,  a + b)
+ALU_OPERATION(SUB,  a - b)
+ALU_OPERATION(MULS, a * b) //the low bits of a product do not depend on the signedness
+ALU_OPERATION(MULU, a * b)
+ALU_OPERATION(DIVS, sb == 0 ? ~b : (sb == -1 ? (uint64_t)0 - a : (uint64_t)(sa / sb))) //a is negated unsigned, which wraps
+ALU_OPERATION(DIVU, b == 0 ? ~b : a / b)
+ALU_OPERATION(AND,  a & b)
+ALU_OPERATION(OR,   a | b)
+ALU_OPERATION(XOR,  a ^ b)
+ALU_OPERATION(ASL,  a << n)
+ALU_OPERATION(LSL,  a << n)
+ALU_OPERATION(ASR,  sa >> n)
+ALU_OPERATION(LSR,  a >> n)
+
+//BRU
+DELAYED_OPERATION(BNE)
+DELAYED_OPERATION(BEQ)
+DELAYED_OPERATION(BL)
+DELAYED_OPERATION(BLE)
+DELAYED_OPERATION(BG)
+DELAYED_OPERATION(BGE)
+DELAYED_OPERATION(BLS)
+DELAYED_OPERATION(BLES)
+DELAYED_OPERATION(BGS)
+DELAYED_OPERATION(BGES)
+
+OPERATION(CMP, // REG <=> REG
+    const uint64_t right = ireg[operands[0]] & sizemask[op->size];
+    const uint64_t left  = ireg[operands[1]] & sizemask[op->size];
+
+    processor->flags &= ZSUClearMask;
+    processor->flags |= (left != right) << 1u;
+    processor->flags |= ((int64_t)left < (int64_t)right) << 2u;
+    processor->flags |= (left < right) << 3u;
+    processor->flags &= cmptClearMask;
+)
+
+OPERATION(CMPI, // REG <=> IMM
+    const uint64_t right = op->imm & sizemask[op->size];
+    const uint64_t left  = ireg[operands[1]] & sizemask[op->size];
+
+    processor->flags &= ZSUClearMask;
+    processor->flags |= (left != right) << 1u;
+    processor->flags |= ((int64_t)left < (int64_t)right) << 2u;
+    processor->flags |= (left < right) << 3u;
+    processor->flags &= cmptClearMask;
+)
+
+OPERATION(FCMP, // REG <=> REG
+    const float right = freg[operands[0]];
+    const float left  = freg[operands[1]];
+
+    processor->flags &= ZSUClearMask;
+    processor->flags |= (right != left) << 1u;
+    processor->flags |= (left < right) << 2u;
+    processor->flags &= cmptClearMask;
+    processor->flags |= (0x01u << 30u);
+)
+
+OPERATION(FCMPI,
+    const uint32_t iright = op->imm << 11u;
+    const float    fright = *(const float*)(&iright);
+    const float    fleft  = freg[operands[1]];
+
+    processor->flags &= ZSUClearMask;
+    processor->flags |= (fleft != fright) << 1u;
+    processor->flags |= (fleft < fright) << 2u;
+    processor->flags &= cmptClearMask;
+    processor->flags |= (0x01u << 30u);
+)
+
+OPERATION(DCMP, // REG <=> REG
+    const double right = dreg[operands[0]];
+    const double left  = dreg[operands[1]];
+
+    processor->flags &= ZSUClearMask;
+    processor->flags |= (left != right) << 1u;
+    processor->flags |= (left < right) << 2u;
+    processor->flags &= cmptClearMask;
+    processor->flags |= (0x02u << 30u);
+)
+
+OPERATION(DCMPI,
+    const uint64_t iright = (uint64_t)op->imm << 42u;
+    const double   dright = *(const double*)(&iright);
+    const double   dleft  = dreg[operands[1]];
+
+    processor->flags &= ZSUClearMask;
+    processor->flags |= (dleft != dright) << 1u;
+    processor->flags |= (dleft < dright) << 2u;
+    processor->flags &= cmptClearMask;
+    processor->flags |= (0x01u << 30u);
+)
+
+DELAYED_OPERATION(JMP)
+DELAYED_OPERATION(CALL)
+DELAYED_OPERATION(JMPR)
+DELAYED_OPERATION(CALLR)
+DELAYED_OPERATION(RET)
+
+//VFPU
+//Vector operations only write the op->size + 1 first components of their destination, x, xy, xyz or xyzw
+OPERATION(FADD, // v0 = v1 + v2
+    storeLanes(&vreg[operands[2]], addLanes(loadLanes(&vreg[operands[1]]), loadLanes(&vreg[operands[0]])), op->size);
+)
+
+OPERATION(FSUB, // v0 = v1 - v2
+    storeLanes(&vreg[operands[2]], subLanes(loadLanes(&vreg[operands[1]]), loadLanes(&vreg[operands[0]])), op->size);
+)
+
+OPERATION(FMUL, // v0 = v1 * v2
+    storeLanes(&vreg[operands[2]], mulLanes(loadLanes(&vreg[operands[1]]), loadLanes(&vreg[operands[0]])), op->size);
+)
+
+OPERATION(FMULADD, // v0 += v1 * v2
+    const Lanes product = mulLanes(loadLanes(&vreg[operands[1]]), loadLanes(&vreg[operands[0]]));
+    storeLanes(&vreg[operands[2]], addLanes(loadLanes(&vreg[operands[2]]), product), op->size);
+)
+
+OPERATION(FADDV, // v0 = v1 + f2
+    storeLanes(&vreg[operands[2]], addLanes(loadLanes(&vreg[operands[1]]), splatLanes(freg[operands[0]])), op->size);
+)
+
+OPERATION(FSUBV, // v0 = v1 - f2
+    storeLanes(&vreg[operands[2]], subLanes(loadLanes(&vreg[operands[1]]), splatLanes(freg[operands[0]])), op->size);
+)
+
+OPERATION(FMULV, // v0 = v1 * f2
+    storeLanes(&vreg[operands[2]], mulLanes(loadLanes(&vreg[operands[1]]), splatLanes(freg[operands[0]])), op->size);
+)
+
+OPERATION(FMULADDV, // v0 += v1 * f2
+    const Lanes product = mulLanes(loadLanes(&vreg[operands[1]]), splatLanes(freg[operands[0]]));
+    storeLanes(&vreg[operands[2]], addLanes(loadLanes(&vreg[operands[2]]), product), op->size);
+)
+
+OPERATION(FMULVA, // ACC = v1 * f
+    storeLanes(&processor->accumulator, mulLanes(loadLanes(&vreg[operands[1]]), splatLanes(freg[operands[0]])), op->size);
+)
+
+OPERATION(FMULADDVA, // ACC += v1 * f
+    const Lanes product = mulLanes(loadLanes(&vreg[operands[1]]), splatLanes(freg[operands[0]]));
+    storeLanes(&processor->accumulator, addLanes(loadLanes(&processor->accumulator), product), op->size);
+)
+
+OPERATION(FMULADDVAO, // v2 = ACC + v1 * f
+    const Lanes product = mulLanes(loadLanes(&vreg[operands[1]]), splatLanes(freg[operands[0]]));
+    storeLanes(&vreg[operands[2]], addLanes(loadLanes(&processor->accumulator), product), op->size);
+)
+
+OPERATION(FIPR, // f = v1 . v2
+    freg[operands[0]] = dotLanes(loadLanes(&vreg[operands[1]]), loadLanes(&vreg[operands[2]]), op->size);
+)
+
+OPERATION(MOVEV, //Copy a vector register
+    storeLanes(&vreg[operands[2]], loadLanes(&vreg[operands[1]]), op->size);
+)
+
+OPERATION(MOVEFD, //Convert a double to a float
+    freg[operands[2]] = (float)dreg[operands[1]];
+)
+
+OPERATION(MOVEDF, //Convert a float to a double
+    dreg[operands[2]] = (double)freg[operands[1]];
+)
+
+OPERATION(ITOFV, //Convert the 16 bits fixed-point values of a register to a vector, op->data is the fractional bits
+    storeLanes(&vreg[operands[2]], fixedToLanes(ireg[operands[1]], op->data), op->size);
+)
+
+OPERATION(FTOIV, //Convert a vector to the 16 bits fixed-point values of a register, op->data is the fractional bits
+    ireg[operands[2]] = mergeFixed(ireg[operands[2]], lanesToFixed(loadLanes(&vreg[operands[1]]), op->data), op->size);
+)
+
+OPERATION(ITOF, //Convert a signed integer of op->size to a float
+    const uint32_t shift = 64u - (8u << op->size);
+    freg[operands[2]] = (float)((int64_t)(ireg[operands[1]] << shift) >> shift);
+)
+
+OPERATION(FTOI, //Convert a float to a signed integer of op->size
+    ireg[operands[2]] = floatToInteger(freg[operands[1]], op->size);
+)
+
+OPERATION(DADD, // d0 = d1 + d2
+    dreg[operands[2]] = dreg[operands[1]] + dreg[operands[0]];
+)
+
+OPERATION(DSUB, // d0 = d1 - d2
+    dreg[operands[2]] = dreg[operands[1]] - dreg[operands[0]];
+)
+
+OPERATION(DMUL, // d0 = d1 * d2
+    dreg[operands[2]] = dreg[operands[1]] * dreg[operands[0]];
+)
+
+OPERATION(DMULADD, // d0 += d1 * d2
+    dreg[operands[2]] += dreg[operands[1]] * dreg[operands[0]];
+)
+
+OPERATION(ITOD, //Convert a signed integer of op->size to a double
+    const uint32_t shift = 64u - (8u << op->size);
+    dreg[operands[2]] = (double)((int64_t)(ireg[operands[1]] << shift) >> shift);
+)
+
+OPERATION(DTOI, //Convert a double to a signed integer of op->size
+    ireg[operands[2]] = floatToInteger(dreg[operands[1]], op->size);
+)
+
+OPERATION(MOVEFI, //Write an immediate to a float register, the high bits of the float
+    const uint32_t value = op->imm << 11u;
+    memcpy(&freg[operands[2]], &value, sizeof(value));
+)
+
+OPERATION(MOVEDI, //Write an immediate to a double register, the high bits of the double
+    const uint64_t value = (uint64_t)op->imm << 42u;
+    memcpy(&dreg[operands[2]], &value, sizeof(value));
+)
+
+OPERATION(MOVEVI, //Write an immediate to every component of a vector register, the high bits of the floats
+    const uint32_t bits = op->imm << 9u;
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    storeLanes(&vreg[operands[2]], splatLanes(value), 3u);
+)
+
+//VDIV
+OPERATION(FDIV, // f0 = f1 / f2
+    freg[operands[2]] = freg[operands[1]] / freg[operands[0]];
+)
+
+OPERATION(FSQRT, // f0 = sqrt(f1)
+    freg[operands[2]] = sqrtf(freg[operands[1]]);
+)
+
+OPERATION(DDIV, // d0 = d1 / d2
+    dreg[operands[2]] = dreg[operands[1]] / dreg[operands[0]];
+)
+
+OPERATION(DSQRT, // d0 = sqrt(d1)
+    dreg[operands[2]] = sqrt(dreg[operands[1]]);
+)
+
+#ifdef DEFAULT_ALU_OPERATION
+    #undef ALU_OPERATION
+    #undef DEFAULT_ALU_OPERATION
+#endif
+
+#undef CACHE_LOAD
+#undef CACHE_STORE
+#undef ALU_SIZES
+#undef ALU_KERNEL
+#undef DELAYED_OPERATION
+#undef DMA_OPERATION
@@ -1,1109 +1,596 @@
 #include "vm.h"
 
+#ifdef AR_JIT
+    #include "jit.h"
+#endif
+
+#ifdef AR_PEDANTIC
+    #include "pipeline.h"
+#endif
+
+#include <stdlib.h>
 #include <assert.h>
 #include <string.h>
 #include <math.h>
 
+//The VFPU kernels use SSE2, which every x86-64 host has, and plain C elsewhere
+#if defined(__SSE2__) || defined(_M_X64)
+    #include <emmintrin.h>
+    #define AR_SSE2
+#endif
+
 #define MIN(x, y) (x < y ? x : y)
 
-static int32_t extend_sign(uint32_t value, uint32_t bits)
+//Direct threading relies on GCC's labels as values, other compilers use a switch
+#if (defined(__GNUC__) || defined(__clang__)) && !defined(AR_SWITCH_DISPATCH)
+    #define AR_THREADED_DISPATCH
+#endif
+
+#ifdef AR_THREADED_DISPATCH
+static ArResult executeOperations(ArProcessor restrict processor, uint32_t size);
+
+static const int32_t* dispatchTable; //handler offset of each Kernel, published by executeOperations
+
+static void storeDispatchTable(void)
+{
+    executeOperations(NULL, 0);
+}
+
+//Processors may be created concurrently by several host threads, the first one publishes the table
+static void publishDispatchTable(void)
+{
+#ifdef AR_THREADS
+    static pthread_once_t published = PTHREAD_ONCE_INIT;
+    pthread_once(&published, storeDispatchTable);
+#else
+    if(!dispatchTable)
+    {
+        storeDispatchTable();
+    }
+#endif
+}
+#endif
+
+static void retireTransfers(ArProcessor restrict processor, uint64_t now);
+static ArResult loadCache(ArProcessor restrict processor, uint64_t address, void* restrict output, uint32_t size);
+static ArResult storeCache(ArProcessor restrict processor, uint64_t address, const void* restrict input, uint32_t size);
+static uint32_t writtenRegister(const Operation* restrict op, uint32_t* restrict pBytes);
+static uint16_t traceOffset(const Operation* restrict op);
+
+static uint32_t opcodeSetSize(uint32_t flags, uint32_t pc)
 {
-    if(value > (1u << (bits - 1)))
+    uint32_t size;
+    if(flags & 0x01)
     {
-        return (int32_t)((0xFFFFFFFFu << bits) | value);
+        const uint32_t available = pc - (ISRAM_SIZE / 4u); //we may overflow otherwise
+        size = MIN(available, 4u);
     }
     else
     {
-        return (int32_t)value;
+        size = 2;
     }
-}
 
-static const Opcode BRUComparators[16] =
-{
-    OPCODE_BNE,
-    OPCODE_BEQ,
-    OPCODE_BL,
-    OPCODE_BLE,
-    OPCODE_BG,
-    OPCODE_BGE,
-    OPCODE_BLS,
-    OPCODE_BLES,
-    OPCODE_BGS,
-    OPCODE_BGES,
-    OPCODE_UNKNOWN,
-    OPCODE_UNKNOWN,
-    OPCODE_UNKNOWN,
-    OPCODE_UNKNOWN,
-    OPCODE_UNKNOWN,
-    OPCODE_UNKNOWN
-};
+    return size;
+}
 
-static const Opcode BRUJumpsCalls[4] =
+//The kernel of every opcode for each operation size, only the ALU operations depend on the size
+#define OPERATION(name, ...) [OPCODE_##name] = {KERNEL_##name, KERNEL_##name, KERNEL_##name, KERNEL_##name},
+#define ALU_OPERATION(name, expression) \
+    [OPCODE_##name]    = {KERNEL_##name##_B,  KERNEL_##name##_W,  KERNEL_##name##_L,  KERNEL_##name##_Q}, \
+    [OPCODE_##name##I] = {KERNEL_##name##I_B, KERNEL_##name##I_W, KERNEL_##name##I_L, KERNEL_##name##I_Q}, \
+    [OPCODE_##name##Q] = {KERNEL_##name##Q_B, KERNEL_##name##Q_W, KERNEL_##name##Q_L, KERNEL_##name##Q_Q},
+static const uint16_t kernels[][4] =
 {
-    OPCODE_CALL,
-    OPCODE_JMP,
-    OPCODE_CALLR,
-    OPCODE_JMPR
+    #include "operations.inl"
 };
+#undef ALU_OPERATION
+#undef OPERATION
 
-static int decodeBRU(uint32_t pc, uint32_t opcode, Operation* restrict output)
+static void decodeBundle(ArProcessor restrict processor, uint32_t pc)
 {
-    const uint32_t type = (opcode >> 2u) & 0x03u;
+    DecodedBundle* restrict const output = &processor->decodedBundles[pc / 2u];
+    uint32_t legal = 0; //the number of legal operations before the first illegal one
 
-    if(type == 0) //REG-REG comparison or Branch
+    for(uint32_t i = 0; i < MAX_OPCODE; ++i)
     {
-        const uint32_t instruction = (opcode >> 4u) & 0x03u;
+        Operation* restrict const op = &output->operations[i];
 
-        if(instruction == 0) //CMP
-        {
-            const uint32_t size  = (opcode >> 8u ) & 0x03;
-            const uint32_t right = (opcode >> 20u) & 0x3F;
-            const uint32_t left  = (opcode >> 26u) & 0x3F;
-
-            output->op = OPCODE_CMP;
-            output->size = size;
-            output->operands[0] = right;
-            output->operands[1] = left;
-        }
-        else if(instruction == 1) //FCMP
+        if(pc + i < ISRAM_SIZE / 4u)
         {
-            const uint32_t right = (opcode >> 18u) & 0x7F;
-            const uint32_t left  = (opcode >> 25u) & 0x7F;
+            uint32_t opcode;
+            memcpy(&opcode, processor->isram + (pc + i) * 4u, sizeof(uint32_t));
 
-            output->op = OPCODE_FCMP;
-            output->operands[0] = right;
-            output->operands[1] = left;
+            if(isaDecodeOperation(i, pc, opcode, op) && legal == i)
+            {
+                ++legal;
+            }
         }
-        else if(instruction == 2) //DCMP
+        else
         {
-            const uint32_t right = (opcode >> 20u) & 0x3F;
-            const uint32_t left  = (opcode >> 26u) & 0x3F;
-
-            output->op = OPCODE_DCMP;
-            output->operands[0] = right;
-            output->operands[1] = left;
+            memset(op, 0, sizeof(Operation));
+            op->op = OPCODE_UNKNOWN;
         }
-        else //Branching
-        {
-            const uint32_t category = (opcode >> 6u) & 0x03u;
 
-            if(category == 0) //Branch (BCC, BCCS, FBCC, DBCC)
-            {
-                const uint32_t comp  = (opcode >> 8u ) & 0x0Fu;
-                const uint32_t label = (opcode >> 12u) & 0x3FFFu;
-
-                output->op = BRUComparators[comp];
-                output->operands[0] = pc + extend_sign(label, 14) * 2;
+        op->kernel = kernels[op->op][op->size & 0x03u];
 
-                if(output->op == OPCODE_UNKNOWN)
-                {
-                    return 0;
-                }
-            }
-            else if(category == 1) //Illegal
-            {
-                return 0;
-            }
-            else if(category == 2) //Jumps or calls
-            {
-                const uint32_t subtype = (opcode >> 8u ) & 0x03u;
-                const uint32_t label   = (opcode >> 12u) & 0x3FFFu;
+        processor->decodedTraceOffsets[pc / 2u][i] = traceOffset(op);
 
-                output->op = BRUJumpsCalls[subtype];
-                output->operands[0] = subtype > 1 ? pc + extend_sign(label, 14) * 2 //relative
-                                                  : label * 2u; //absolute
-            }
-            else //Ret
-            {
-                output->op = OPCODE_RET;
-            }
-        }
+#ifdef AR_THREADED_DISPATCH
+        op->handler = dispatchTable[op->kernel];
+#endif
     }
-    else if(type == 1) //CMPI
-    {
-        const uint32_t size  = (opcode >> 4u ) & 0x000003;
-        const uint32_t value = (opcode >> 6u ) & 0x0FFFFF;
-        const uint32_t reg   = (opcode >> 26u) & 0x00003F;
 
-        output->op = OPCODE_CMPI;
-        output->size = size;
-        output->operands[0] = value;
-        output->operands[1] = reg;
-    }
-    else if(type == 2) //FCMPI
-    {
-        const uint32_t value = (opcode >> 4u ) & 0x1FFFFF;
-        const uint32_t reg   = (opcode >> 25u) & 0x00007F;
+    processor->decodedSizes[pc / 2u] = legal == MAX_OPCODE ? 4u : (legal >= 2u ? 2u : 0u);
+}
 
-        output->op = OPCODE_FCMPI;
-        output->operands[0] = value;
-        output->operands[1] = reg;
-    }
-    else //DCMPI
-    {
-        const uint32_t value = (opcode >> 4u ) & 0x3FFFFF;
-        const uint32_t reg   = (opcode >> 26u) & 0x00003F;
+typedef struct DecodeRange
+{
+    ArProcessor processor;
+    uint32_t first; //< the index of the first bundle
+    uint32_t last;  //< the index past the last bundle
+} DecodeRange;
 
-        output->op = OPCODE_DCMPI;
-        output->operands[0] = value;
-        output->operands[1] = reg;
+static int isZeroBundle(ArProcessor restrict processor, uint32_t pc)
+{
+    if(pc + MAX_OPCODE > ISRAM_SIZE / 4u)
+    {
+        return 0;
     }
 
-    return 1;
+    uint64_t words[2];
+    memcpy(words, processor->isram + pc * 4u, sizeof(words));
+
+    return (words[0] | words[1]) == 0;
 }
 
-static int decodeLSU(uint32_t opcode, Operation* restrict output)
+//Most of the ISRAM past the boot code is zeros, their bundles are copied once two of them decoded the same
+static void* decodeBundles(void* pRange)
 {
-    const uint32_t type = (opcode >> 2u) & 0x03u;
+    const DecodeRange* const range = pRange;
+    const ArProcessor processor = range->processor;
 
-    if(type == 0) //LDM/STM
-    {
-        const uint32_t incr  = (opcode >> 4u ) & 0x0001u;
-        const uint32_t store = (opcode >> 5u ) & 0x0001u;
-        const uint32_t size  = (opcode >> 6u ) & 0x0003u;
-        const uint32_t value = (opcode >> 8u ) & 0x0FFFu;
-        const uint32_t src   = (opcode >> 20u) & 0x003Fu;
-        const uint32_t reg   = (opcode >> 26u) & 0x003Fu;
+    const DecodedBundle* zero = NULL;
+    uint32_t zeroIndex = 0;
+    int zeroChecked = 0;
 
-        output->data = incr;
-        output->op   = store ? OPCODE_STM : OPCODE_LDM;
-        output->size = size;
-        output->operands[0] = value;
-        output->operands[1] = src;
-        output->operands[2] = reg;
-    }
-    else if(type == 1) //Subtypes
+    for(uint32_t i = range->first; i < range->last; ++i)
     {
-        const uint32_t subtype = (opcode >> 4u) & 0x03u;
-
-        if(subtype == 0) // LDMX/STMX
-        {
-            const uint32_t store = (opcode >> 6u ) & 0x0001u;
-            const uint32_t size  = (opcode >> 7u ) & 0x0003u;
-            const uint32_t value = (opcode >> 9u ) & 0xFFFFu;
-            const uint32_t src   = (opcode >> 25u) & 0x0001u;
-            const uint32_t dest  = (opcode >> 26u) & 0x003Fu;
-
-            output->op   = store ? OPCODE_STMX : OPCODE_LDMX;
-            output->size = size;
-            output->operands[0] = value;
-            output->operands[1] = src + 62;
-            output->operands[2] = dest;
-        }
-        else if(subtype == 1) //IN/OUT
-        {
-            const uint32_t store = (opcode >> 6u ) & 0x01u;
-            const uint32_t size  = (opcode >> 7u ) & 0x03u;
-            const uint32_t value = (opcode >> 16u) & 0xFFu;
-            const uint32_t dest  = (opcode >> 26u) & 0x3Fu;
-
-            output->op   = store ? OPCODE_OUT : OPCODE_IN;
-            output->size = size;
-            output->operands[0] = value;
-            output->operands[2] = dest;
-        }
-        else if(subtype == 2) //OUTI
+        if(!isZeroBundle(processor, i * 2u))
         {
-            const uint32_t size  = (opcode >> 7u ) & 0x0001u;
-            const uint32_t value = (opcode >> 16u) & 0xFFFFu;
-            const uint32_t dest  = (opcode >> 26u) & 0x00FFu;
-
-            output->op   = OPCODE_OUTI;
-            output->size = size;
-            output->operands[0] = value;
-            output->operands[2] = dest;
+            decodeBundle(processor, i * 2u);
         }
-        else //LDMV/STMV or LDCV/STCV
+        else if(zeroChecked)
         {
-            const uint32_t store = (opcode >> 6u ) & 0x0001u;
-            const uint32_t cache = (opcode >> 7u ) & 0x0001u;
-            const uint32_t incr  = (opcode >> 8u ) & 0x0001u;
-            const uint32_t value = (opcode >> 9u ) & 0x7FFFu;
-            const uint32_t src   = (opcode >> 25u) & 0x0007u;
-            const uint32_t dest  = (opcode >> 26u) & 0x003Fu;
-
-            if(cache)
-            {
-                output->data = incr;
-                output->op = store ? OPCODE_STCV : OPCODE_LDCV;
-                output->operands[0] = value;
-                output->operands[1] = src + 56;
-                output->operands[2] = dest;
-            }
-            else
+            uint32_t end = i + 1u;
+            while(end < range->last && isZeroBundle(processor, end * 2u))
             {
-                output->data = incr;
-                output->op = store ? OPCODE_STMV : OPCODE_LDMV;
-                output->operands[0] = value;
-                output->operands[1] = src + 56;
-                output->operands[2] = dest;
+                ++end;
             }
-        }
-    }
-    else if(type == 2) //LDC/STC
-    {
-        const uint32_t incr  = (opcode >> 4u ) & 0x0001u;
-        const uint32_t store = (opcode >> 5u ) & 0x0001u;
-        const uint32_t size  = (opcode >> 6u ) & 0x0003u;
-        const uint32_t value = (opcode >> 8u ) & 0x0FFFu;
-        const uint32_t src   = (opcode >> 20u) & 0x003Fu;
-        const uint32_t dest  = (opcode >> 26u) & 0x003Fu;
-
-        output->data = incr;
-        output->op   = store ? OPCODE_STC : OPCODE_LDC;
-        output->size = size;
-        output->operands[0] = value;
-        output->operands[1] = src;
-        output->operands[2] = dest;
-    }
-    else //LDMF/STMF or LDCF/STCF and LDMD/STMD or LDCD/STCD
-    {
-        const uint64_t size  = (opcode >> 4u) & 0x01u;
-        const uint32_t cache = (opcode >> 5u) & 0x01u;
-        const uint32_t store = (opcode >> 6u) & 0x01u;
-        const uint32_t incr  = (opcode >> 7u) & 0x01u;
 
-        if(size == 0) //LDMF/STMF or LDCF/STCF
-        {
-            const uint32_t value = (opcode >> 8u ) & 0x7FFFu;
-            const uint32_t src   = (opcode >> 23u) & 0x0003u;
-            const uint32_t dest  = (opcode >> 25u) & 0x007Fu;
-
-            if(cache)
+            //Each copy doubles the bundles copied
+            processor->decodedBundles[i] = *zero;
+            for(uint32_t copied = 1; copied < end - i; copied *= 2u)
             {
-                output->data = incr;
-                output->op = store ? OPCODE_STCF : OPCODE_LDCF;
-                output->operands[0] = value;
-                output->operands[1] = src + 60;
-                output->operands[2] = dest;
+                const uint32_t count = MIN(copied, end - i - copied);
+                memcpy(&processor->decodedBundles[i + copied], &processor->decodedBundles[i], count * sizeof(DecodedBundle));
             }
-            else
+
+            memset(&processor->decodedSizes[i], processor->decodedSizes[zeroIndex], end - i);
+            for(uint32_t j = i; j < end; ++j)
             {
-                output->data = incr;
-                output->op = store ? OPCODE_STMF : OPCODE_LDMF;
-                output->operands[0] = value;
-                output->operands[1] = src + 60;
-                output->operands[2] = dest;
+                memcpy(processor->decodedTraceOffsets[j], processor->decodedTraceOffsets[zeroIndex], sizeof(processor->decodedTraceOffsets[j]));
             }
+
+            i = end - 1u;
         }
         else
         {
-            const uint32_t value = (opcode >> 8u ) & 0xFFFFu;
-            const uint32_t src   = (opcode >> 24u) & 0x0003u;
-            const uint32_t dest  = (opcode >> 26u) & 0x003Fu;
+            decodeBundle(processor, i * 2u);
 
-            if(cache)
+            if(zero)
             {
-                output->data = incr;
-                output->op = store ? OPCODE_STCD : OPCODE_LDCD;
-                output->operands[0] = value;
-                output->operands[1] = src + 60;
-                output->operands[2] = dest;
+                zeroChecked = memcmp(zero, &processor->decodedBundles[i], sizeof(DecodedBundle)) == 0;
             }
             else
             {
-                output->data = incr;
-                output->op = store ? OPCODE_STMD : OPCODE_LDMD;
-                output->operands[0] = value;
-                output->operands[1] = src + 60;
-                output->operands[2] = dest;
+                zero = &processor->decodedBundles[i];
+                zeroIndex = i;
             }
         }
     }
 
-    return 1;
+    return NULL;
 }
 
-static const Opcode ALURegRegRegOpcodes[16] =
-{
-    OPCODE_ADD,
-    OPCODE_SUB,
-    OPCODE_MULS,
-    OPCODE_MULU,
-    OPCODE_DIVS,
-    OPCODE_DIVU,
-    OPCODE_AND,
-    OPCODE_OR,
-    OPCODE_XOR,
-    OPCODE_ASL,
-    OPCODE_LSL,
-    OPCODE_ASR,
-    OPCODE_LSR,
-    OPCODE_UNKNOWN,
-    OPCODE_UNKNOWN,
-    OPCODE_UNKNOWN,
-};
-
-static const Opcode ALURegRegImmOpcodes[16] =
-{
-    OPCODE_ADDI,
-    OPCODE_SUBI,
-    OPCODE_MULSI,
-    OPCODE_MULUI,
-    OPCODE_DIVSI,
-    OPCODE_DIVUI,
-    OPCODE_ANDI,
-    OPCODE_ORI,
-    OPCODE_XORI,
-    OPCODE_ASLI,
-    OPCODE_LSLI,
-    OPCODE_ASRI,
-    OPCODE_LSRI,
-    OPCODE_UNKNOWN,
-    OPCODE_UNKNOWN,
-    OPCODE_UNKNOWN,
-};
-
-static const Opcode ALURegImmOpcodes[16] =
-{
-    OPCODE_ADDQ,
-    OPCODE_SUBQ,
-    OPCODE_MULSQ,
-    OPCODE_MULUQ,
-    OPCODE_DIVSQ,
-    OPCODE_DIVUQ,
-    OPCODE_ANDQ,
-    OPCODE_ORQ,
-    OPCODE_XORQ,
-    OPCODE_ASLQ,
-    OPCODE_LSLQ,
-    OPCODE_ASRQ,
-    OPCODE_LSRQ,
-    OPCODE_UNKNOWN,
-    OPCODE_UNKNOWN,
-    OPCODE_UNKNOWN,
-};
-
-static int decodeALU(uint32_t opcode, Operation* restrict output)
+void decodeInstructionMemory(ArProcessor processor, uint32_t first, uint32_t last)
 {
-    const uint32_t category = (opcode >> 2u) & 0x03u;
+    assert(first <= last && last <= ISRAM_SIZE / 4u);
 
-    if(category == 0)
-    {
-        const uint32_t type = (opcode >> 4u) & 0x07u;
-
-        if(type == 0) // ALU REG-REG-REG (ADD, SUB, ...)
-        {
-            const uint32_t op   = (opcode >> 8u ) & 0x0Fu;
-            const uint32_t size = (opcode >> 12u) & 0x03u;
-            const uint32_t src1 = (opcode >> 14u) & 0x3Fu;
-            const uint32_t src2 = (opcode >> 20u) & 0x3Fu;
-            const uint32_t dest = (opcode >> 26u) & 0x3Fu;
-
-            output->op   = ALURegRegRegOpcodes[op];
-            output->size = size;
-            output->operands[0] = src1;
-            output->operands[1] = src2;
-            output->operands[2] = dest;
-
-            if(output->op == OPCODE_UNKNOWN)
-            {
-                return 0;
-            }
-        }
-        else if(type == 2) // XCHG
-        {
-            output->op = OPCODE_XCHG;
-        }
-        else if(type == 6) // NOP NOP.E
-        {
-            const uint32_t end = (opcode >> 7u) & 0x01u;
+    //A bundle starting up to MAX_OPCODE - 1 words before the range reads it
+    const uint32_t begin = (first > MAX_OPCODE - 1u ? first - (MAX_OPCODE - 1u) : 0u) / 2u;
+    const uint32_t end = (last + 1u) / 2u;
 
-            output->data = end;
-            output->op   = OPCODE_NOP;
-        }
-        else
-        {
-            return 0;
-        }
-    }
-    else if(category == 1) // ALU REG-REG-IMM (ADDI, SUBI, ...)
+    //The zero bundles at the end of the range are copies, only the bundles before them are split across threads.
+    //The last bundle of the ISRAM reads past its end and is never zeros
+    uint32_t zeros = end == DECODED_BUNDLES ? end - 1u : end;
+    while(zeros > begin && isZeroBundle(processor, (zeros - 1u) * 2u))
     {
-        const uint32_t op    = (opcode >> 4u ) & 0x000Fu;
-        const uint32_t size  = (opcode >> 8u ) & 0x0003u;
-        const uint32_t value = (opcode >> 10u) & 0x03FFu;
-        const uint32_t src   = (opcode >> 20u) & 0x003Fu;
-        const uint32_t dest  = (opcode >> 26u) & 0x003Fu;
-
-        output->op   = ALURegRegImmOpcodes[op];
-        output->size = size;
-        output->operands[0] = value;
-        output->operands[1] = src;
-        output->operands[2] = dest;
-
-        if(output->op == OPCODE_UNKNOWN)
-        {
-            return 0;
-        }
+        --zeros;
     }
-    else if(category == 2) // ALU REG-IMM (ADDQ, SUBQ, ...)
-    {
-        const uint32_t op    = (opcode >> 4u ) & 0x000Fu;
-        const uint32_t size  = (opcode >> 8u ) & 0x0003u;
-        const uint32_t value = (opcode >> 10u) & 0xFFFFu;
-        const uint32_t dest  = (opcode >> 26u) & 0x003Fu;
 
-        output->op   = ALURegImmOpcodes[op];
-        output->size = size;
-        output->operands[0] = value;
-        output->operands[2] = dest;
+#ifdef AR_THREADED_DISPATCH
+    publishDispatchTable();
+#endif
 
-        if(output->op == OPCODE_UNKNOWN)
-        {
-            return 0;
-        }
-    }
-    else // MOVEI
+    //Most DMAIR overwrite a few bundles, which the calling thread decodes on its own
+    const uint32_t count = MIN((zeros - begin) / PARALLEL_DECODE_BUNDLES, processor->parent->decodeThreads);
+    if(count < 2u)
     {
-        const uint32_t value = (opcode >> 4u ) & 0x3FFFFFu;
-        const uint32_t dest  = (opcode >> 26u) & 0x00003Fu;
+        DecodeRange range = {processor, begin, end};
+        decodeBundles(&range);
+        return;
+    }
 
-        output->op = OPCODE_MOVEI;
-        output->operands[0] = value;
-        output->operands[2] = dest;
+#ifdef AR_THREADS
+    DecodeRange ranges[MAX_DECODE_THREADS];
+    for(uint32_t i = 0; i < count; ++i)
+    {
+        ranges[i].processor = processor;
+        ranges[i].first = begin + (uint32_t)((uint64_t)(zeros - begin) * i / count);
+        ranges[i].last = begin + (uint32_t)((uint64_t)(zeros - begin) * (i + 1u) / count);
     }
 
-    return 1;
-}
+    DecodeRange tail = {processor, zeros, end};
 
-static int decodeAGU(uint32_t opcode, Operation* restrict output)
-{
-    const uint32_t category = (opcode >> 2u) & 0x01u;
+    //The calling thread decodes the first range and the zeros, a range without a thread is decoded after them
+    pthread_t threads[MAX_DECODE_THREADS];
+    int started[MAX_DECODE_THREADS] = {0};
 
-    if(category == 0) //LDDMA/STDMA
+    for(uint32_t i = 1; i < count; ++i)
     {
-        const uint32_t store = (opcode >> 3u ) & 0x0001u;
-        const uint32_t size  = (opcode >> 4u ) & 0x0001u;
-        const uint32_t sram  = (opcode >> 5u ) & 0x0003u;
-        const uint32_t ram   = (opcode >> 7u ) & 0x0001u;
-        const uint32_t sramb = (opcode >> 8u ) & 0x0FFFu;
-        const uint32_t ramb  = (opcode >> 20u) & 0x0FFFu;
-
-        output->op = store ? OPCODE_STDMA : OPCODE_LDDMA;
-        output->size = size;
-        output->operands[0] = sram + 60;
-        output->operands[1] = ram + 58;
-        output->data = (ramb << 12u) | sramb;
+        started[i] = pthread_create(&threads[i], NULL, decodeBundles, &ranges[i]) == 0;
     }
-    else //Load/store list
-    {
-        const uint32_t store = (opcode >> 3u ) & 0x01u;
-        const uint32_t type  = (opcode >> 4u ) & 0x0Fu;
 
-        if(type == 0) //LDDMAR/STDMAR
-        {
-            const uint32_t size = (opcode >> 8u ) & 0x0FFFu;
-            const uint32_t ram  = (opcode >> 8u ) & 0x003Fu;
-            const uint32_t sram = (opcode >> 20u) & 0x003Fu;
-
-            output->op = store ? OPCODE_STDMAR : OPCODE_LDDMAR;
-            output->size = size;
-            output->operands[0] = ram;
-            output->operands[1] = sram;
-        }
-        else if(type == 1) //DMAIR
-        {
-            const uint32_t size = (opcode >> 8u ) & 0x0FFFu;
-            const uint32_t ram  = (opcode >> 8u ) & 0x003Fu;
-            const uint32_t sram = (opcode >> 20u) & 0x003Fu;
-
-            output->op = OPCODE_DMAIR;
-            output->size = size;
-            output->operands[0] = ram;
-            output->operands[1] = sram;
-        }
-        else if(type == 15) //WAIT
+    decodeBundles(&ranges[0]);
+    decodeBundles(&tail);
+
+    for(uint32_t i = 1; i < count; ++i)
+    {
+        if(started[i])
         {
-            output->op = OPCODE_WAIT;
+            pthread_join(threads[i], NULL);
         }
         else
         {
-            return 0;
+            decodeBundles(&ranges[i]);
         }
     }
-
-    return 1;
+#endif
 }
 
-static int decodeVFPU(uint32_t opcode, Operation* restrict output)
+static const DecodedBundle* fetchBundle(ArProcessor restrict processor, uint32_t pc, uint32_t size)
 {
-    (void)opcode;
-    (void)output;
+    //Branch targets and return addresses are even, only a wild program counter misses the decoded bundles
+    if((pc & 0x01u) || pc >= ISRAM_SIZE / 4u || size > processor->decodedSizes[pc / 2u])
+    {
+        return NULL;
+    }
 
-    return 1;
+    return &processor->decodedBundles[pc / 2u];
 }
 
-static int decode(uint32_t index, uint32_t pc, uint32_t opcode, Operation* restrict output)
+static ArResult decodeInstruction(ArProcessor restrict processor)
 {
-#ifndef NDEBUG
-    memset(output, 0, sizeof(Operation)); //simplify debug
-#endif
-
-    const uint32_t compute_unit = opcode & 0x03;
+    const uint32_t size = opcodeSetSize(processor->flags, processor->pc);
 
-    if(index == 0)
-    {
-        if(compute_unit == 0) //BRU
-        {
-            return decodeBRU(pc, opcode, output);
-        }
-        else if(compute_unit == 1) //LSU
-        {
-            return decodeLSU(opcode, output);
-        }
-        else if(compute_unit == 2) //ALU
-        {
-            return decodeALU(opcode, output);
-        }
-        else //VFPU/VDIV
-        {
-            return decodeVFPU(opcode, output);
-        }
-    }
-    else if(index == 1)
-    {
-        if(compute_unit == 0) //AGU
-        {
-            return decodeAGU(opcode, output);
-        }
-        else if(compute_unit == 1) //LSU
-        {
-            return decodeLSU(opcode, output);
-        }
-        else if(compute_unit == 2) //ALU
-        {
-            return decodeALU(opcode, output);
-        }
-        else //VFPU
-        {
-            return decodeVFPU(opcode, output);
-        }
-    }
-    else //2 or 3
+    const DecodedBundle* restrict const bundle = fetchBundle(processor, processor->pc, size);
+    if(!bundle)
     {
-        if(compute_unit == 2) //ALU
-        {
-            return decodeALU(opcode, output);
-        }
-        else //VFPU
-        {
-            return 0;
-        }
+        return AR_ERROR_ILLEGAL_INSTRUCTION;
     }
+
+    processor->operations = bundle->operations;
+    processor->pc += size;
+
+    return AR_SUCCESS;
 }
 
-static uint32_t opcodeSetSize(ArProcessor restrict processor)
+ArResult arDecodeInstruction(ArProcessor processor)
 {
-    uint32_t size;
-    if(processor->flags & 0x01)
-    {
-        const uint32_t available = processor->pc - (ISRAM_SIZE / 4u); //we may overflow otherwise
-        size = MIN(available, 4u);
-    }
-    else
-    {
-        size = 2;
-    }
+    assert(processor);
 
-    return size;
+    return decodeInstruction(processor);
 }
 
-ArResult arDecodeInstruction(ArProcessor processor)
+ArResult arDisassembleBundle(ArProcessor processor, uint32_t pc, uint32_t size, uint32_t textSize, char* pText)
 {
     assert(processor);
+    assert(size == 2 || size == 4);
+    assert(textSize > 0 && pText);
 
-    const uint32_t size = opcodeSetSize(processor);
-    memcpy(processor->opcodes, processor->isram + (processor->pc * 4), size * sizeof(uint32_t));
+    pText[0] = '\0';
 
-    for(uint32_t i = 0; i < size; ++i)
+    if(((uint64_t)pc + size) * 4u > ISRAM_SIZE)
     {
-        if(!decode(i, processor->pc, processor->opcodes[i], &processor->operations[i]))
-        {
-            return AR_ERROR_ILLEGAL_INSTRUCTION;
-        }
+        return AR_ERROR_MEMORY_OUT_OF_RANGE;
     }
 
-    processor->pc += size;
+    uint32_t opcodes[MAX_OPCODE];
+    memcpy(opcodes, processor->isram + (pc * 4), size * sizeof(uint32_t));
 
-    return AR_SUCCESS;
+    return isaDisassembleBundle(pc, opcodes, size, pText, textSize) ? AR_SUCCESS : AR_ERROR_ILLEGAL_INSTRUCTION;
 }
 
-static ArResult executeInstruction(ArProcessor restrict processor, uint32_t index)
+//Mask to trunc results base on size (8 bits, 16 bits, 32 bits or 64 bits)
+static const uint64_t sizemask[4] =
 {
-    //Mask to trunc results base on size (8 bits, 16 bits, 32 bits or 64 bits)
-    static const uint64_t sizemask[4] =
-    {
-        0x00000000000000FFull,
-        0x000000000000FFFFull,
-        0x00000000FFFFFFFFull,
-        0xFFFFFFFFFFFFFFFFull,
-    };
+    0x00000000000000FFull,
+    0x000000000000FFFFull,
+    0x00000000FFFFFFFFull,
+    0xFFFFFFFFFFFFFFFFull,
+};
 
-    static const uint32_t ZSUClearMask  = ~(Z_MASK | S_MASK | U_MASK);
-    static const uint32_t cmptClearMask = ~CMPT_MASK;
+static const uint32_t ZSUClearMask  = ~(Z_MASK | S_MASK | U_MASK);
+static const uint32_t cmptClearMask = ~CMPT_MASK;
 
-    uint64_t* restrict const ireg = processor->ireg;
-    
-    float*    const freg = (float*)processor->freg;
-    double*   const dreg = (double*)processor->freg;
-    Vector4f* const vreg = (Vector4f*)processor->freg;
+//VFPU lanes: a vector operation of size 0, 1, 2 or 3 only writes the x, xy, xyz or xyzw components of its destination
+#ifdef AR_SSE2
+typedef __m128 Lanes;
 
-    const Operation* restrict const op = &processor->operations[index];
-    const uint32_t* restrict const operands = op->operands;
+static const union
+{
+    uint32_t bits[4];
+    __m128 lanes;
+} laneMasks[4] =
+{
+    {{0xFFFFFFFFu, 0x00000000u, 0x00000000u, 0x00000000u}},
+    {{0xFFFFFFFFu, 0xFFFFFFFFu, 0x00000000u, 0x00000000u}},
+    {{0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0x00000000u}},
+    {{0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu}},
+};
 
-    switch(op->op)
-    {
-        case OPCODE_UNKNOWN:
-            return AR_ERROR_ILLEGAL_INSTRUCTION;
+static inline Lanes loadLanes(const Vector4f* vector)
+{
+    return _mm_loadu_ps(&vector->x);
+}
 
-        //AGU
-        case OPCODE_LDDMA:  //fallthrough
-        case OPCODE_STDMA:  //fallthrough
-        case OPCODE_LDDMAR: //fallthrough
-        case OPCODE_STDMAR: //fallthrough
-        case OPCODE_DMAIR:  //fallthrough
-        case OPCODE_WAIT:
-            processor->dma = 1;
-            processor->dmaOperation = *op;
-            break;
+static inline Lanes splatLanes(float value)
+{
+    return _mm_set1_ps(value);
+}
 
-        //LSU
-        case OPCODE_LDM: //copy data from dsram to register
-            memcpy(&ireg[operands[2]], &processor->dsram[operands[0] + ireg[operands[1]]], 1u << op->size);
-            ireg[operands[1]] += op->data; //incr
-            break;
+static inline Lanes addLanes(Lanes left, Lanes right)
+{
+    return _mm_add_ps(left, right);
+}
 
-        case OPCODE_STM: //copy data from register to dsram
-            memcpy(&processor->dsram[operands[0] + ireg[operands[1]]], &ireg[operands[2]], 1u << op->size);
-            ireg[operands[1]] += op->data; //incr
-            break;
+static inline Lanes subLanes(Lanes left, Lanes right)
+{
+    return _mm_sub_ps(left, right);
+}
 
-        case OPCODE_LDC: //copy data from cache to register
-            memcpy(&ireg[operands[2]], &processor->cache[operands[0] + ireg[operands[1]]], 1u << op->size);
-            ireg[operands[1]] += op->data; //incr
-            break;
+static inline Lanes mulLanes(Lanes left, Lanes right)
+{
+    return _mm_mul_ps(left, right);
+}
 
-        case OPCODE_STC: //copy data from register to cache
-            memcpy(&processor->cache[operands[0] + ireg[operands[1]]], &ireg[operands[2]], 1u << op->size);
-            ireg[operands[1]] += op->data; //incr
-            break;
+static inline void storeLanes(Vector4f* vector, Lanes value, uint32_t size)
+{
+    const __m128 mask = laneMasks[size & 0x03u].lanes;
+    const __m128 previous = _mm_loadu_ps(&vector->x);
 
-        case OPCODE_LDMX: //copy data from dsram to register
-            memcpy(&ireg[operands[2]], &processor->dsram[operands[0] + ireg[operands[1]]], 1u << op->size);
-            ireg[operands[1]] += op->data; //incr
-            break;
+    _mm_storeu_ps(&vector->x, _mm_or_ps(_mm_and_ps(mask, value), _mm_andnot_ps(mask, previous)));
+}
 
-        case OPCODE_STMX: //copy data from register to dsram
-            memcpy(&processor->dsram[operands[0] + ireg[operands[1]]], &ireg[operands[2]], 1u << op->size);
-            ireg[operands[1]] += op->data; //incr
-            break;
+//The products are summed as (x + z) + (y + w), the scalar version keeps the same order
+static inline float dotLanes(Lanes left, Lanes right, uint32_t size)
+{
+    __m128 sum = _mm_and_ps(_mm_mul_ps(left, right), laneMasks[size & 0x03u].lanes);
+    sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+    sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, _MM_SHUFFLE(1, 1, 1, 1)));
 
-        case OPCODE_IN: //copy data from iosram to register
-            memcpy(&ireg[operands[2]], &processor->iosram[operands[0]], 1u << op->size);
-            break;
+    return _mm_cvtss_f32(sum);
+}
 
-        case OPCODE_OUT: //copy data from register to iosram
-            memcpy(&processor->iosram[operands[0]], &ireg[operands[2]], 1u << op->size);
-            break;
+//Converts the four signed 16 bits fixed-point values of a register, with point fractional bits
+static inline Lanes fixedToLanes(uint64_t value, uint32_t point)
+{
+    const __m128i fixed = _mm_loadl_epi64((const __m128i*)&value);
+    const __m128i wide  = _mm_srai_epi32(_mm_unpacklo_epi16(fixed, fixed), 16);
 
-        case OPCODE_OUTI: //write data to iosram
-            memcpy(&processor->iosram[operands[0]], &ireg[operands[2]], 1u << op->size);
-            break;
+    return _mm_mul_ps(_mm_cvtepi32_ps(wide), _mm_set1_ps(1.0f / (float)(1u << point)));
+}
 
-        case OPCODE_LDMV: //copy data from dsram to vector register
-            memcpy(&vreg[operands[2]], &processor->dsram[operands[0] + ireg[operands[1]]], 16);
-            ireg[operands[1]] += op->data; //incr
-            break;
+//Converts to four signed 16 bits fixed-point values, rounded toward zero and saturated
+static inline uint64_t lanesToFixed(Lanes value, uint32_t point)
+{
+    __m128 scaled = _mm_mul_ps(value, _mm_set1_ps((float)(1u << point)));
+    scaled = _mm_min_ps(_mm_max_ps(scaled, _mm_set1_ps(-32768.0f)), _mm_set1_ps(32767.0f)); //NaN gives -32768
 
-        case OPCODE_STMV: //copy data from vector register to dsram
-            memcpy(&processor->dsram[operands[0] + ireg[operands[1]]], &vreg[operands[2]], 16);
-            ireg[operands[1]] += op->data; //incr
-            break;
+    uint64_t output;
+    _mm_storel_epi64((__m128i*)&output, _mm_packs_epi32(_mm_cvttps_epi32(scaled), _mm_setzero_si128()));
 
-        case OPCODE_LDCV: //copy data from cache to vector register
-            memcpy(&vreg[operands[2]], &processor->cache[operands[0] + ireg[operands[1]]], 16);
-            ireg[operands[1]] += op->data; //incr
-            break;
+    return output;
+}
+#else
+typedef Vector4f Lanes;
 
-        case OPCODE_STCV: //copy data from vector register to cache
-            memcpy(&processor->cache[operands[0] + ireg[operands[1]]], &vreg[operands[2]], 16);
-            ireg[operands[1]] += op->data; //incr
-            break;
+static inline Lanes loadLanes(const Vector4f* vector)
+{
+    return *vector;
+}
 
-        case OPCODE_LDMF: //copy data from dsram to float register
-            memcpy(&freg[operands[2]], &processor->dsram[operands[0] + ireg[operands[1]]], 4);
-            ireg[operands[1]] += op->data; //incr
-            break;
+static inline Lanes splatLanes(float value)
+{
+    return (Lanes){value, value, value, value};
+}
 
-        case OPCODE_STMF: //copy data from float register to dsram
-            memcpy(&processor->dsram[operands[0] + ireg[operands[1]]], &freg[operands[2]], 4);
-            ireg[operands[1]] += op->data; //incr
-            break;
+static inline Lanes addLanes(Lanes left, Lanes right)
+{
+    return (Lanes){left.x + right.x, left.y + right.y, left.z + right.z, left.w + right.w};
+}
 
-        case OPCODE_LDCF: //copy data from cache to float register
-            memcpy(&freg[operands[2]], &processor->cache[operands[0] + ireg[operands[1]]], 4);
-            ireg[operands[1]] += op->data; //incr
-            break;
+static inline Lanes subLanes(Lanes left, Lanes right)
+{
+    return (Lanes){left.x - right.x, left.y - right.y, left.z - right.z, left.w - right.w};
+}
 
-        case OPCODE_STCF: //copy data from float register to cache
-            memcpy(&processor->cache[operands[0] + ireg[operands[1]]], &freg[operands[2]], 4);
-            ireg[operands[1]] += op->data; //incr
-            break;
+static inline Lanes mulLanes(Lanes left, Lanes right)
+{
+    return (Lanes){left.x * right.x, left.y * right.y, left.z * right.z, left.w * right.w};
+}
 
-        case OPCODE_LDMD: //copy data from dsram to double register
-            memcpy(&dreg[operands[2]], &processor->dsram[operands[0] + ireg[operands[1]]], 8);
-            ireg[operands[1]] += op->data; //incr
-            break;
+static inline void storeLanes(Vector4f* vector, Lanes value, uint32_t size)
+{
+    memcpy(vector, &value, ((size & 0x03u) + 1u) * sizeof(float)); //the components are contiguous
+}
 
-        case OPCODE_STMD: //copy data from double register to dsram
-            memcpy(&processor->dsram[operands[0] + ireg[operands[1]]], &dreg[operands[2]], 8);
-            ireg[operands[1]] += op->data; //incr
-            break;
+static inline float dotLanes(Lanes left, Lanes right, uint32_t size)
+{
+    const Lanes product = mulLanes(left, right);
+    const float y = size > 0 ? product.y : 0.0f;
+    const float z = size > 1 ? product.z : 0.0f;
+    const float w = size > 2 ? product.w : 0.0f;
 
-        case OPCODE_LDCD: //copy data from cache to double register
-            memcpy(&dreg[operands[2]], &processor->cache[operands[0] + ireg[operands[1]]], 8);
-            ireg[operands[1]] += op->data; //incr
-            break;
+    return (product.x + z) + (y + w);
+}
 
-        case OPCODE_STCD: //copy data from double register to cache
-            memcpy(&processor->cache[operands[0] + ireg[operands[1]]], &dreg[operands[2]], 8);
-            ireg[operands[1]] += op->data; //incr
-            break;
+static inline Lanes fixedToLanes(uint64_t value, uint32_t point)
+{
+    const float scale = 1.0f / (float)(1u << point);
 
-        //ALU
-        case OPCODE_NOP: //In case of nop.e, we need to delay it
-            if(op->data)
-            {
-                processor->delayedBits |= (1u << index);
-                processor->delayed[index] = *op;
-            }
-            break;
-
-        case OPCODE_XCHG: //Flip XCHG bit
-            processor->delayedBits |= (1u << index);
-            processor->delayed[index] = *op;
-            break;
-
-        case OPCODE_MOVEI: //Write a value to a register
-            ireg[operands[2]] = operands[0];
-            break;
-
-        case OPCODE_ADD: //REG = REG + REG
-            ireg[operands[2]] = ireg[operands[1]] + ireg[operands[0]];
-            ireg[operands[2]] &= sizemask[op->size];
-            break;
-
-        case OPCODE_ADDI: //REG = REG + IMM
-            ireg[operands[2]] = ireg[operands[1]] + operands[0];
-            ireg[operands[2]] &= sizemask[op->size];
-            break;
-
-        case OPCODE_ADDQ: //REG += IMM
-            ireg[operands[2]] += operands[0];
-            ireg[operands[2]] &= sizemask[op->size];
-            break;
-
-        case OPCODE_SUB: //REG = REG - REG
-            ireg[operands[2]] = ireg[operands[1]] - ireg[operands[0]];
-            ireg[operands[2]] &= sizemask[op->size];
-            break;
-
-        case OPCODE_SUBI: //REG = REG - IMM
-            ireg[operands[2]] = ireg[operands[1]] - operands[0];
-            ireg[operands[2]] &= sizemask[op->size];
-            break;
-
-        case OPCODE_SUBQ: //REG -= IMM
-            ireg[operands[2]] -= operands[0];
-            ireg[operands[2]] &= sizemask[op->size];
-            break;
-
-        case OPCODE_MULS: //REG = REG * REG (signed)
-            (*(int64_t*)ireg[operands[2]]) = (int64_t)ireg[operands[1]] * (int64_t)ireg[operands[0]];
-            ireg[operands[2]] &= sizemask[op->size];
-            break;
-
-        case OPCODE_MULSI: //REG = REG * IMM (signed)
-            (*(int64_t*)ireg[operands[2]]) = (int64_t)ireg[operands[1]] * (int64_t)operands[0];
-            ireg[operands[2]] &= sizemask[op->size];
-            break;
-
-        case OPCODE_MULSQ: //REG *= IMM (signed)
-            (*(int64_t*)ireg[operands[2]]) *= (int64_t)operands[0];
-            ireg[operands[2]] &= sizemask[op->size];
-            break;
-
-        case OPCODE_MULU: //REG = REG * REG
-            ireg[operands[2]] = ireg[operands[1]] * ireg[operands[0]];
-            ireg[operands[2]] &= sizemask[op->size];
-            break;
-
-        case OPCODE_MULUI: //REG = REG * IMM
-            ireg[operands[2]] = ireg[operands[1]] * operands[0];
-            ireg[operands[2]] &= sizemask[op->size];
-            break;
-
-        case OPCODE_MULUQ: //REG *= IMM
-            ireg[operands[2]] *= operands[0];
-            ireg[operands[2]] &= sizemask[op->size];
-            break;
-
-        case OPCODE_DIVS: //REG = REG / REG (signed)
-            (*(int64_t*)ireg[operands[2]]) = (int64_t)ireg[operands[1]] / (int64_t)ireg[operands[0]];
-            ireg[operands[2]] &= sizemask[op->size];
-            break;
-
-        case OPCODE_DIVSI: //REG = REG / IMM (signed)
-            (*(int64_t*)ireg[operands[2]]) = (int64_t)ireg[operands[1]] / (int64_t)operands[0];
-            ireg[operands[2]] &= sizemask[op->size];
-            break;
-
-        case OPCODE_DIVSQ: //REG /= IMM (signed)
-            (*(int64_t*)ireg[operands[2]]) /= (int64_t)operands[0];
-            ireg[operands[2]] &= sizemask[op->size];
-            break;
-
-        case OPCODE_DIVU: //REG = REG / REG
-            ireg[operands[2]] = ireg[operands[1]] / ireg[operands[0]];
-            ireg[operands[2]] &= sizemask[op->size];
-            break;
-
-        case OPCODE_DIVUI: //REG = REG / IMM
-            ireg[operands[2]] = ireg[operands[1]] / operands[0];
-            ireg[operands[2]] &= sizemask[op->size];
-            break;
-
-        case OPCODE_DIVUQ: //REG /= IMM
-            ireg[operands[2]] /= operands[0];
-            ireg[operands[2]] &= sizemask[op->size];
-            break;
-
-        case OPCODE_AND: //REG = REG & REG
-            ireg[operands[2]] = ireg[operands[1]] & ireg[operands[0]];
-            ireg[operands[2]] &= sizemask[op->size];
-            break;
-
-        case OPCODE_ANDI: //REG = REG & IMM
-            ireg[operands[2]] = ireg[operands[1]] & operands[0];
-            ireg[operands[2]] &= sizemask[op->size];
-            break;
-
-        case OPCODE_ANDQ: //REG &= IMM
-            ireg[operands[2]] &= operands[0];
-            ireg[operands[2]] &= sizemask[op->size];
-            break;
-
-        case OPCODE_OR: //REG = REG | REG
-            ireg[operands[2]] = ireg[operands[1]] | ireg[operands[0]];
-            ireg[operands[2]] &= sizemask[op->size];
-            break;
-
-        case OPCODE_ORI: //REG = REG | IMM
-            ireg[operands[2]] = ireg[operands[1]] | operands[0];
-            ireg[operands[2]] &= sizemask[op->size];
-            break;
-
-        case OPCODE_ORQ: //REG |= IMM
-            ireg[operands[2]] |= operands[0];
-            ireg[operands[2]] &= sizemask[op->size];
-            break;
-
-        case OPCODE_XOR: //REG = REG ^ REG
-            ireg[operands[2]] = ireg[operands[1]] ^ ireg[operands[0]];
-            ireg[operands[2]] &= sizemask[op->size];
-            break;
-
-        case OPCODE_XORI: //REG = REG ^ IMM
-            ireg[operands[2]] = ireg[operands[1]] ^ operands[0];
-            ireg[operands[2]] &= sizemask[op->size];
-            break;
-
-        case OPCODE_XORQ: //REG ^= IMM
-            ireg[operands[2]] ^= operands[0];
-            ireg[operands[2]] &= sizemask[op->size];
-            break;
-
-        case OPCODE_ASL: //REG = REG << REG (signed)
-            (*(int64_t*)ireg[operands[2]]) = (int64_t)ireg[operands[1]] << (int64_t)ireg[operands[0]];
-            ireg[operands[2]] &= sizemask[op->size];
-            break;
-
-        case OPCODE_ASLI: //REG = REG << IMM (signed)
-            (*(int64_t*)ireg[operands[2]]) = (int64_t)ireg[operands[1]] << (int64_t)operands[0];
-            ireg[operands[2]] &= sizemask[op->size];
-            break;
-
-        case OPCODE_ASLQ: //REG <<= IMM (signed)
-            (*(int64_t*)ireg[operands[2]]) <<= (int64_t)operands[0];
-            ireg[operands[2]] &= sizemask[op->size];
-            break;
-
-        case OPCODE_LSL: //REG = REG << REG
-            ireg[operands[2]] = ireg[operands[1]] << ireg[operands[0]];
-            ireg[operands[2]] &= sizemask[op->size];
-            break;
-
-        case OPCODE_LSLI: //REG = REG << IMM
-            ireg[operands[2]] = ireg[operands[1]] << operands[0];
-            ireg[operands[2]] &= sizemask[op->size];
-            break;
-
-        case OPCODE_LSLQ: //REG <<= IMM
-            ireg[operands[2]] <<= operands[0];
-            ireg[operands[2]] &= sizemask[op->size];
-            break;
-
-        case OPCODE_ASR: //REG = REG >> REG (signed)
-            (*(int64_t*)ireg[operands[2]]) = (int64_t)ireg[operands[1]] >> (int64_t)ireg[operands[0]];
-            ireg[operands[2]] &= sizemask[op->size];
-            break;
-
-        case OPCODE_ASRI: //REG = REG >> IMM (signed)
-            (*(int64_t*)ireg[operands[2]]) = (int64_t)ireg[operands[1]] >> (int64_t)operands[0];
-            ireg[operands[2]] &= sizemask[op->size];
-            break;
-
-        case OPCODE_ASRQ: //REG >>= IMM (signed)
-            (*(int64_t*)ireg[operands[2]]) >>= (int64_t)operands[0];
-            ireg[operands[2]] &= sizemask[op->size];
-            break;
-
-        case OPCODE_LSR: //REG = REG >> REG
-            ireg[operands[2]] = ireg[operands[1]] >> ireg[operands[0]];
-            ireg[operands[2]] &= sizemask[op->size];
-            break;
-
-        case OPCODE_LSRI: //REG = REG >> IMM
-            ireg[operands[2]] = ireg[operands[1]] >> operands[0];
-            ireg[operands[2]] &= sizemask[op->size];
-            break;
-
-        case OPCODE_LSRQ: //REG >>= IMM
-            ireg[operands[2]] >>= operands[0];
-            ireg[operands[2]] &= sizemask[op->size];
-            break;
-
-        //BRU
-        case OPCODE_BNE:  // fallthrough
-        case OPCODE_BEQ:  // fallthrough
-        case OPCODE_BL:   // fallthrough
-        case OPCODE_BLE:  // fallthrough
-        case OPCODE_BG:   // fallthrough
-        case OPCODE_BGE:  // fallthrough
-        case OPCODE_BLS:  // fallthrough
-        case OPCODE_BLES: // fallthrough
-        case OPCODE_BGS:  // fallthrough
-        case OPCODE_BGES:
-            processor->delayedBits |= (1u << index);
-            processor->delayed[index] = *op;
-            break;
-
-        case OPCODE_CMP: // REG <=> REG
-        {
-            const uint64_t right = ireg[operands[0]] & sizemask[op->size];
-            const uint64_t left  = ireg[operands[1]] & sizemask[op->size];
-
-            processor->flags &= ZSUClearMask;
-            processor->flags |= (left != right) << 1u;
-            processor->flags |= ((int64_t)left < (int64_t)right) << 2u;
-            processor->flags |= (left < right) << 3u;
-            processor->flags &= cmptClearMask;
+    return (Lanes)
+    {
+        (float)(int16_t)(value       ) * scale,
+        (float)(int16_t)(value >> 16u) * scale,
+        (float)(int16_t)(value >> 32u) * scale,
+        (float)(int16_t)(value >> 48u) * scale,
+    };
+}
 
-            break;
-        }
+static inline uint64_t fixedComponent(float value, uint32_t point)
+{
+    const float scaled = value * (float)(1u << point);
+    const float clamped = scaled > -32768.0f ? (scaled < 32767.0f ? scaled : 32767.0f) : -32768.0f; //NaN gives -32768
 
-        case OPCODE_CMPI: // REG <=> IMM
-        {
-            const uint64_t right = operands[0] & sizemask[op->size];
-            const uint64_t left  = ireg[operands[1]] & sizemask[op->size];
+    return (uint16_t)(int16_t)clamped;
+}
 
-            processor->flags &= ZSUClearMask;
-            processor->flags |= (left != right) << 1u;
-            processor->flags |= ((int64_t)left < (int64_t)right) << 2u;
-            processor->flags |= (left < right) << 3u;
-            processor->flags &= cmptClearMask;
+static inline uint64_t lanesToFixed(Lanes value, uint32_t point)
+{
+    return fixedComponent(value.x, point)
+         | fixedComponent(value.y, point) << 16u
+         | fixedComponent(value.z, point) << 32u
+         | fixedComponent(value.w, point) << 48u;
+}
+#endif
 
-            break;
-        }
+//Only the size + 1 first 16 bits values of a fixed-point register are written
+static inline uint64_t mergeFixed(uint64_t previous, uint64_t value, uint32_t size)
+{
+    const uint64_t mask = (size & 0x03u) == 3u ? UINT64_MAX : (1ull << (16u * ((size & 0x03u) + 1u))) - 1u;
 
-        case OPCODE_FCMP: // REG <=> REG
-        {
-            const float right = freg[operands[0]];
-            const float left  = freg[operands[1]];
+    return (previous & ~mask) | (value & mask);
+}
 
-            processor->flags &= ZSUClearMask;
-            processor->flags |= (right != left) << 1u;
-            processor->flags |= (left < right) << 2u;
-            processor->flags &= cmptClearMask;
-            processor->flags |= (0x01u << 30u);
+//Converts to a signed integer of 1, 2, 4 or 8 bytes, rounded toward zero and saturated, NaN gives 0
+static inline uint64_t floatToInteger(double value, uint32_t size)
+{
+    const int64_t high = (int64_t)(sizemask[size & 0x03u] >> 1u);
+    const int64_t low  = -high - 1;
 
-            break;
-        }
+    int64_t output = 0;
+    if(value >= (double)high)
+    {
+        output = high;
+    }
+    else if(value <= (double)low)
+    {
+        output = low;
+    }
+    else if(value == value)
+    {
+        output = (int64_t)value;
+    }
 
-        case OPCODE_FCMPI:
-        {
-            const uint32_t iright = operands[0] << 11u;
-            const float    fright = *(const float*)(&iright);
-            const float    fleft  = freg[operands[1]];
+    return (uint64_t)output & sizemask[size & 0x03u];
+}
 
-            processor->flags &= ZSUClearMask;
-            processor->flags |= (fleft != fright) << 1u;
-            processor->flags |= (fleft < fright) << 2u;
-            processor->flags &= cmptClearMask;
-            processor->flags |= (0x01u << 30u);
+static ArResult executeOperations(ArProcessor restrict processor, uint32_t size)
+{
+#ifdef AR_THREADED_DISPATCH
+    //Handlers are stored as offsets from the first one, LABEL_UNKNOWN, to fit in an Operation
+    #define OPERATION(name, ...) [KERNEL_##name] = (int32_t)(&&LABEL_##name - &&LABEL_UNKNOWN),
+    static const int32_t handlers[] =
+    {
+        #include "operations.inl"
+    };
+    #undef OPERATION
 
-            break;
-        }
+    if(!processor) //Only publish the handlers for the decoder
+    {
+        dispatchTable = handlers;
+        return AR_SUCCESS;
+    }
+#endif
 
-        case OPCODE_DCMP: // REG <=> REG
-        {
-            const double right = dreg[operands[0]];
-            const double left  = dreg[operands[1]];
+    uint64_t* restrict const ireg = processor->ireg;
 
-            processor->flags &= ZSUClearMask;
-            processor->flags |= (left != right) << 1u;
-            processor->flags |= (left < right) << 2u;
-            processor->flags &= cmptClearMask;
-            processor->flags |= (0x02u << 30u);
+    float*    const freg = (float*)processor->freg;
+    double*   const dreg = (double*)processor->freg;
+    Vector4f* const vreg = (Vector4f*)processor->freg;
 
-            break;
-        }
+    const Operation* restrict op = processor->operations;
+    const uint8_t* restrict operands = op->operands;
+    uint32_t index = 0;
+
+#ifdef AR_THREADED_DISPATCH
+    //Each handler jumps directly to the next operation of the bundle
+    #define OPERATION(name, ...) \
+        LABEL_##name: \
+        { \
+            __VA_ARGS__ \
+        } \
+        if(++index == size) \
+        { \
+            return AR_SUCCESS; \
+        } \
+        ++op; \
+        operands = op->operands; \
+        goto *(&&LABEL_UNKNOWN + op->handler);
+
+    goto *(&&LABEL_UNKNOWN + op->handler);
+
+    #include "operations.inl"
+    #undef OPERATION
+#else
+    #define OPERATION(name, ...) \
+        case KERNEL_##name: \
+        { \
+            __VA_ARGS__ \
+        } \
+        break;
+
+    for(; index < size; ++index, ++op)
+    {
+        operands = op->operands;
 
-        case OPCODE_DCMPI:
+        switch(op->kernel)
         {
-            const uint64_t iright = (uint64_t)operands[0] << 42u;
-            const double   dright = *(const double*)(&iright);
-            const double   dleft  = dreg[operands[1]];
-
-            processor->flags &= ZSUClearMask;
-            processor->flags |= (dleft != dright) << 1u;
-            processor->flags |= (dleft < dright) << 2u;
-            processor->flags &= cmptClearMask;
-            processor->flags |= (0x01u << 30u);
-
-            break;
+            #include "operations.inl"
         }
-
-        case OPCODE_JMP:   //fallthrough
-        case OPCODE_CALL:  //fallthrough
-        case OPCODE_JMPR:  //fallthrough
-        case OPCODE_CALLR: //fallthrough
-        case OPCODE_RET:
-            processor->delayedBits |= (1u << index);
-            processor->delayed[index] = *op;
-            break;
     }
+    #undef OPERATION
 
     return AR_SUCCESS;
+#endif
 }
 
 static ArResult executeDelayedInstruction(ArProcessor restrict processor, uint32_t index)
 {
-    static const uint32_t ZSUClearMask = ~(Z_MASK | S_MASK | U_MASK);
     static const uint32_t retClearMask = ~R_MASK;
 
     const Operation* restrict op = &processor->delayed[index];
-    const uint32_t* restrict const operands = op->operands;
 
     switch(op->op)
     {
@@ -1120,7 +607,7 @@ static ArResult executeDelayedInstruction(ArProcessor restrict processor, uint32
         case OPCODE_BNE: // !=
             if(processor->flags & Z_MASK)
             {
-                processor->pc = (int32_t)operands[0];
+                processor->pc = (int32_t)op->imm;
             }
 
             processor->flags &= ZSUClearMask;
@@ -1129,7 +616,7 @@ static ArResult executeDelayedInstruction(ArProcessor restrict processor, uint32
         case OPCODE_BEQ: // ==
             if(!(processor->flags & Z_MASK))
             {
-                processor->pc = (int32_t)operands[0];
+                processor->pc = (int32_t)op->imm;
             }
 
             processor->flags &= ZSUClearMask;
@@ -1138,7 +625,7 @@ static ArResult executeDelayedInstruction(ArProcessor restrict processor, uint32
         case OPCODE_BL: // <
             if(processor->flags & U_MASK)
             {
-                processor->pc = (int32_t)operands[0];
+                processor->pc = (int32_t)op->imm;
             }
 
             processor->flags &= ZSUClearMask;
@@ -1147,7 +634,7 @@ static ArResult executeDelayedInstruction(ArProcessor restrict processor, uint32
         case OPCODE_BLE: // <=
             if((processor->flags & U_MASK) || !(processor->flags & Z_MASK))
             {
-                processor->pc = (int32_t)operands[0];
+                processor->pc = (int32_t)op->imm;
             }
 
             processor->flags &= ZSUClearMask;
@@ -1156,7 +643,7 @@ static ArResult executeDelayedInstruction(ArProcessor restrict processor, uint32
         case OPCODE_BG: // >
             if(!(processor->flags & U_MASK))
             {
-                processor->pc = (int32_t)operands[0];
+                processor->pc = (int32_t)op->imm;
             }
 
             processor->flags &= ZSUClearMask;
@@ -1165,7 +652,7 @@ static ArResult executeDelayedInstruction(ArProcessor restrict processor, uint32
         case OPCODE_BGE: // >=
             if(!(processor->flags & U_MASK) || !(processor->flags & Z_MASK))
             {
-                processor->pc = (int32_t)operands[0];
+                processor->pc = (int32_t)op->imm;
             }
 
             processor->flags &= ZSUClearMask;
@@ -1174,7 +661,7 @@ static ArResult executeDelayedInstruction(ArProcessor restrict processor, uint32
         case OPCODE_BLS: // <
             if(processor->flags & S_MASK)
             {
-                processor->pc = (int32_t)operands[0];
+                processor->pc = (int32_t)op->imm;
             }
 
             processor->flags &= ZSUClearMask;
@@ -1183,7 +670,7 @@ static ArResult executeDelayedInstruction(ArProcessor restrict processor, uint32
         case OPCODE_BLES: // <=
             if((processor->flags & S_MASK) || !(processor->flags & Z_MASK))
             {
-                processor->pc = (int32_t)operands[0];
+                processor->pc = (int32_t)op->imm;
             }
 
             processor->flags &= ZSUClearMask;
@@ -1192,7 +679,7 @@ static ArResult executeDelayedInstruction(ArProcessor restrict processor, uint32
         case OPCODE_BGS: // >
             if(!(processor->flags & S_MASK))
             {
-                processor->pc = (int32_t)operands[0];
+                processor->pc = (int32_t)op->imm;
             }
 
             processor->flags &= ZSUClearMask;
@@ -1201,30 +688,30 @@ static ArResult executeDelayedInstruction(ArProcessor restrict processor, uint32
         case OPCODE_BGES: // >=
             if(!(processor->flags & S_MASK) || !(processor->flags & Z_MASK))
             {
-                processor->pc = (int32_t)operands[0];
+                processor->pc = (int32_t)op->imm;
             }
 
             processor->flags &= ZSUClearMask;
             break;
 
         case OPCODE_JMP:
-            processor->pc = operands[0];
+            processor->pc = op->imm;
             break;
 
         case OPCODE_CALL:
             processor->flags &= retClearMask;
             processor->flags |= (processor->pc << 4u);
-            processor->pc = operands[0];
+            processor->pc = op->imm;
             break;
 
         case OPCODE_JMPR:
-            processor->pc = (int32_t)operands[0];
+            processor->pc = (int32_t)op->imm;
             break;
 
         case OPCODE_CALLR:
             processor->flags &= retClearMask;
             processor->flags |= (processor->pc << 4u);
-            processor->pc = (int32_t)operands[0];
+            processor->pc = (int32_t)op->imm;
             break;
 
         case OPCODE_RET:
@@ -1235,11 +722,9 @@ static ArResult executeDelayedInstruction(ArProcessor restrict processor, uint32
     return AR_SUCCESS;
 }
 
-ArResult arExecuteInstruction(ArProcessor processor)
+static ArResult executeBundle(ArProcessor restrict processor)
 {
-    assert(processor);
-
-    const uint32_t size = opcodeSetSize(processor);
+    const uint32_t size = opcodeSetSize(processor->flags, processor->pc);
 
     for(uint32_t i = 0; i < size; ++i)
     {
@@ -1255,163 +740,1738 @@ ArResult arExecuteInstruction(ArProcessor processor)
         }
     }
 
-    for(uint32_t i = 0; i < size; ++i)
-    {
-        ArResult result = executeInstruction(processor, i);
-        if(result != AR_SUCCESS)
-        {
-            return result;
-        }
-    }
-
-    return AR_SUCCESS;
+    return executeOperations(processor, size);
 }
 
-static ArResult copyFromRAM(ArProcessor restrict processor, uint64_t ramAddress, uint8_t* restrict output, size_t size)
+/// \brief Get the register an operation writes, numbered as ArStallRecord::reg, and its number of bytes
+///
+/// Delayed operations write theirs in a later bundle, and the base register incremented by a load is not reported
+static uint32_t writtenRegister(const Operation* restrict op, uint32_t* restrict pBytes)
 {
-    ArPhysicalMemory memory = processor->parent->memory; //First memory
-    if(!memory)
-    {
-        return AR_ERROR_ILLEGAL_INSTRUCTION;
-    }
+    const uint8_t* const operands = op->operands;
+    *pBytes = sizeof(uint64_t);
 
-    if(ramAddress + size > memory->size)
+    if(op->op >= OPCODE_ADD && op->op <= OPCODE_LSRQ)
     {
-        return AR_ERROR_PHYSICAL_MEMORY_OUT_OF_RANGE;
+        return operands[2] & (IREG_COUNT - 1u);
     }
 
-    memcpy(output, memory->memory + ramAddress, size);
+    switch(op->op)
+    {
+        default:
+            return AR_TRACE_REGISTER_NONE;
+
+        case OPCODE_LDM:   //fallthrough
+        case OPCODE_LDMX:  //fallthrough
+        case OPCODE_LDC:   //fallthrough
+        case OPCODE_IN:    //fallthrough
+        case OPCODE_MOVEI: //fallthrough
+        case OPCODE_FTOIV: //fallthrough
+        case OPCODE_FTOI:  //fallthrough
+        case OPCODE_DTOI:
+            return operands[2] & (IREG_COUNT - 1u);
+
+        case OPCODE_LDMF:   //fallthrough
+        case OPCODE_LDCF:   //fallthrough
+        case OPCODE_MOVEFD: //fallthrough
+        case OPCODE_ITOF:   //fallthrough
+        case OPCODE_MOVEFI: //fallthrough
+        case OPCODE_FDIV:   //fallthrough
+        case OPCODE_FSQRT:
+            *pBytes = sizeof(float);
+            return IREG_COUNT + (operands[2] & (FREG_COUNT - 1u));
+
+        case OPCODE_FIPR:
+            *pBytes = sizeof(float);
+            return IREG_COUNT + (operands[0] & (FREG_COUNT - 1u));
+
+        case OPCODE_LDMD:    //fallthrough
+        case OPCODE_LDCD:    //fallthrough
+        case OPCODE_MOVEDF:  //fallthrough
+        case OPCODE_DADD:    //fallthrough
+        case OPCODE_DSUB:    //fallthrough
+        case OPCODE_DMUL:    //fallthrough
+        case OPCODE_DMULADD: //fallthrough
+        case OPCODE_ITOD:    //fallthrough
+        case OPCODE_MOVEDI:  //fallthrough
+        case OPCODE_DDIV:    //fallthrough
+        case OPCODE_DSQRT:
+            return IREG_COUNT + ((operands[2] * 2u) & (FREG_COUNT - 1u));
+
+        case OPCODE_LDMV:       //fallthrough
+        case OPCODE_LDCV:       //fallthrough
+        case OPCODE_FADD:       //fallthrough
+        case OPCODE_FSUB:       //fallthrough
+        case OPCODE_FMUL:       //fallthrough
+        case OPCODE_FMULADD:    //fallthrough
+        case OPCODE_FADDV:      //fallthrough
+        case OPCODE_FSUBV:      //fallthrough
+        case OPCODE_FMULV:      //fallthrough
+        case OPCODE_FMULADDV:   //fallthrough
+        case OPCODE_FMULADDVAO: //fallthrough
+        case OPCODE_MOVEV:      //fallthrough
+        case OPCODE_ITOFV:      //fallthrough
+        case OPCODE_MOVEVI:
+            return IREG_COUNT + ((operands[2] * 4u) & (FREG_COUNT - 1u));
+
+        case OPCODE_CMP:   //fallthrough
+        case OPCODE_CMPI:  //fallthrough
+        case OPCODE_FCMP:  //fallthrough
+        case OPCODE_FCMPI: //fallthrough
+        case OPCODE_DCMP:  //fallthrough
+        case OPCODE_DCMPI:
+            *pBytes = sizeof(uint32_t);
+            return AR_STALL_REGISTER_FLAGS;
 
-    return AR_SUCCESS;
+        case OPCODE_FMULVA: //fallthrough
+        case OPCODE_FMULADDVA:
+            return AR_STALL_REGISTER_ACCUMULATOR;
+    }
 }
 
-static ArResult copyToRAM(ArProcessor restrict processor, uint64_t ramAddress, const uint8_t* restrict input, size_t size)
+/// \brief Get the offset in ArProcessor_T of a register numbered as ArStallRecord::reg
+static uint32_t registerOffset(uint32_t reg)
 {
-    ArPhysicalMemory memory = processor->parent->memory; //First memory
-    if(!memory)
+    if(reg < IREG_COUNT)
     {
-        return AR_ERROR_ILLEGAL_INSTRUCTION;
+        return (uint32_t)(offsetof(ArProcessor_T, ireg) + reg * sizeof(uint64_t));
     }
-
-    if(ramAddress + size > memory->size)
+    else if(reg < IREG_COUNT + FREG_COUNT)
     {
-        return AR_ERROR_PHYSICAL_MEMORY_OUT_OF_RANGE;
+        return (uint32_t)(offsetof(ArProcessor_T, freg) + (reg - IREG_COUNT) * sizeof(float));
+    }
+    else if(reg == AR_STALL_REGISTER_FLAGS)
+    {
+        return (uint32_t)offsetof(ArProcessor_T, flags);
     }
 
-    memcpy(memory->memory + ramAddress, input, size);
-
-    return AR_SUCCESS;
+    return (uint32_t)offsetof(ArProcessor_T, accumulator);
 }
 
-static ArResult executeDMA(ArProcessor restrict processor, int store)
-{
-    //RAM -> SDRAM
-    uint64_t* restrict const ireg = processor->ireg;
+//The trace records runs of bundles at consecutive program counters: the values of the registers each bundle wrote, the
+//op-codes of the bundles two per word, the cycle of the first one, then a header word, the last one so that the records
+//are read back from the most recent one. Which registers the values belong to is decoded from the op-codes
+#define TRACE_HEADER(pc, size, count, faulted, slots) \
+    ((uint64_t)(pc) | (uint64_t)(size) << 16u | (uint64_t)(count) << 19u | (uint64_t)(faulted) << 24u | (uint64_t)(slots) << 25u)
 
-    const Operation* restrict      op       = &processor->dmaOperation;
-    const uint32_t* restrict const operands = op->operands;
+#define TRACE_HEADER_PC(header)      ((uint32_t)(header) & 0xFFFFu)
+#define TRACE_HEADER_SIZE(header)    ((uint32_t)((header) >> 16u) & 0x7u)
+#define TRACE_HEADER_COUNT(header)   ((uint32_t)((header) >> 19u) & 0x1Fu)
+#define TRACE_HEADER_FAULTED(header) ((uint32_t)((header) >> 24u) & 0x1u) //the last bundle faulted
+#define TRACE_HEADER_SLOTS(header)   ((uint32_t)((header) >> 25u) & 0xFu) //the slots of the last bundle which recorded their register
 
-    const uint64_t sramb = (op->data)        & 0x0FFFu;
-    const uint64_t ramb  = (op->data >> 12u) & 0x0FFFu;
-    const uint64_t sram  = (ireg[operands[0]] + sramb) * 32ull;
-    const uint64_t ram   = (ireg[operands[1]] + ramb)  * 32ull;
-    const size_t   size  = (op->size + 1u) * 32u;
+#define TRACE_OFFSET_WORD (0x8000u) //the register recorded is 32 bits wide
 
-    if(sram + size > DSRAM_SIZE)
+_Static_assert(offsetof(ArProcessor_T, accumulator) < TRACE_OFFSET_WORD, "the registers must lie below TRACE_OFFSET_WORD");
+
+/// \brief Get the offset in ArProcessor_T of the register an operation writes, tagged with TRACE_OFFSET_WORD, 0 if none
+static uint16_t traceOffset(const Operation* restrict op)
+{
+    uint32_t bytes;
+    const uint32_t reg = writtenRegister(op, &bytes);
+
+    if(reg == AR_TRACE_REGISTER_NONE)
     {
-        return AR_ERROR_MEMORY_OUT_OF_RANGE;
+        return 0;
     }
 
-    if(store)
+    return (uint16_t)(registerOffset(reg) | (bytes == sizeof(uint32_t) ? TRACE_OFFSET_WORD : 0u));
+}
+
+/// \brief Record at out the register of a traceOffset
+static inline _Atomic uint64_t* traceValue(ArProcessor restrict processor, _Atomic uint64_t* restrict out, uint32_t offset)
+{
+    //The flags and the floats are read as they were written, a wider load would wait for the store to retire
+    const uint8_t* const address = (const uint8_t*)processor + (offset & ~TRACE_OFFSET_WORD);
+    uint64_t value;
+
+    if(offset & TRACE_OFFSET_WORD)
     {
-        return copyToRAM(processor, ram, processor->dsram + sram, size);
+        uint32_t word;
+        memcpy(&word, address, sizeof(word));
+        value = word;
     }
     else
     {
-        return copyFromRAM(processor, ram, processor->dsram + sram, size);
+        memcpy(&value, address, sizeof(value));
     }
+
+    atomic_store_explicit(out, value, memory_order_relaxed);
+
+    return out + 1;
 }
 
-static ArResult executeDMAR(ArProcessor restrict processor, int store)
+/// \brief Complete at out the record of the count bundles from pc begun at the published head, after the values of
+/// their registers, and make it visible to arGetProcessorTrace
+static inline void traceBundles(ArProcessor restrict processor, _Atomic uint64_t* restrict out, uint32_t pc, uint32_t size,
+                                uint32_t count, uint64_t cycle, int faulted, uint32_t slots)
 {
-    //RAM -> SDRAM
-    uint64_t* restrict const ireg = processor->ireg;
+    _Atomic uint64_t* const trace = processor->trace;
+    const uint32_t words = count * (size > 2 ? 2u : 1u);
+    const uint8_t* restrict const opcodes = processor->isram + pc * 4u;
 
-    const Operation* restrict      op       = &processor->dmaOperation;
-    const uint32_t* restrict const operands = op->operands;
+    //A bundle which faulted may lie past the instruction memory, its missing op-codes are 0
+    const uint32_t valid = pc < ISRAM_SIZE / 4u ? MIN(words, (ISRAM_SIZE - pc * 4u) / (uint32_t)sizeof(uint64_t)) : 0u;
 
-    const uint64_t sram = ireg[operands[0]] * 32ull;
-    const uint64_t ram  = ireg[operands[1]] * 32ull;
-    const size_t   size = op->size * 32u;
+    for(uint32_t i = 0; i < valid; ++i)
+    {
+        uint64_t word;
+        memcpy(&word, opcodes + i * sizeof(uint64_t), sizeof(uint64_t));
+        atomic_store_explicit(out++, word, memory_order_relaxed);
+    }
 
-    if(sram + size > DSRAM_SIZE)
+    for(uint32_t i = valid; i < words; ++i)
     {
-        return AR_ERROR_MEMORY_OUT_OF_RANGE;
+        atomic_store_explicit(out++, 0u, memory_order_relaxed);
     }
 
-    if(store)
+    atomic_store_explicit(out++, cycle, memory_order_relaxed);
+    atomic_store_explicit(out++, TRACE_HEADER(pc, size, count, faulted, slots), memory_order_relaxed);
+
+    //The words written past the ring are its first ones
+    const uint32_t ringSize = processor->traceMask + 1u;
+    for(_Atomic uint64_t* spare = trace + ringSize; spare < out; ++spare)
     {
-        return copyToRAM(processor, ram, processor->dsram + sram, size);
+        atomic_store_explicit(spare - ringSize, atomic_load_explicit(spare, memory_order_relaxed), memory_order_relaxed);
     }
-    else
+
+    const uint64_t head = atomic_load_explicit(&processor->traceHead, memory_order_relaxed);
+    const _Atomic uint64_t* const first = &trace[head & processor->traceMask];
+    atomic_store_explicit(&processor->traceHead, head + (uint64_t)(out - first), memory_order_release);
+}
+
+/// \brief Write the record left open by the last superblock, if any
+static inline void closeTrace(ArProcessor restrict processor)
+{
+    if(processor->traceCount)
     {
-        return copyFromRAM(processor, ram, processor->dsram + sram, size);
+        traceBundles(processor, processor->traceOut, processor->tracePc, processor->traceSize, processor->traceCount, processor->traceCycle, 0, 0xFu);
+        processor->traceCount = 0;
     }
 }
 
-static ArResult executeDMAIR(ArProcessor restrict processor)
+/// \brief Record the bundle at pc, whose operations ran with result, operations is NULL if it could not be decoded
+///
+/// The bundle joins the record left open by the superblock it follows, usually the delay slot of its branch
+static void traceOperations(ArProcessor restrict processor, uint32_t pc, uint32_t size, const Operation* restrict operations, uint64_t cycle, ArResult result)
 {
-    //RAM -> SDRAM
-    uint64_t* restrict const ireg = processor->ireg;
+    _Atomic uint64_t* out;
+    uint32_t count = processor->traceCount;
 
-    const Operation* restrict      op       = &processor->dmaOperation;
-    const uint32_t* restrict const operands = op->operands;
+    if(count && operations && size == processor->traceSize && pc == processor->tracePc + count * size && cycle == processor->traceCycle + count)
+    {
+        out = processor->traceOut;
+        pc = processor->tracePc;
+        cycle = processor->traceCycle;
+        processor->traceCount = 0;
+    }
+    else
+    {
+        closeTrace(processor);
 
-    const uint64_t sram = ireg[operands[0]] * 32ull;
-    const uint64_t ram  = ireg[operands[1]] * 32ull;
-    const size_t   size = op->size * 32u;
+        const uint64_t head = atomic_load_explicit(&processor->traceHead, memory_order_relaxed);
+        out = &processor->trace[head & processor->traceMask];
+        count = 0;
+    }
 
-    if(sram + size > ISRAM_SIZE)
+    //The operations are those of a decoded bundle, whose registers were found when it was decoded
+    const uint16_t* const offsets = operations ? processor->decodedTraceOffsets[(const DecodedBundle*)operations - processor->decodedBundles] : NULL;
+
+    for(uint32_t i = 0; offsets && i < size; ++i)
     {
-        return AR_ERROR_MEMORY_OUT_OF_RANGE;
+        const uint32_t offset = offsets[i];
+        if(offset)
+        {
+            out = traceValue(processor, out, offset);
+        }
     }
 
-    return copyFromRAM(processor, ram, processor->isram + sram, size);
+    traceBundles(processor, out, pc, size, count + 1u, cycle, result < AR_SUCCESS, operations ? 0xFu : 0u);
 }
 
-ArResult arExecuteDirectMemoryAccess(ArProcessor processor)
+/// \brief Read the bundles of the trace record which ends at position end into entries, oldest first
+///
+/// \return The position the record begins at, greater than end if the trace has no record there
+static uint64_t readTraceRecord(ArProcessor processor, uint64_t end, ArTraceEntry entries[TRACE_RECORD_BUNDLES], uint32_t* restrict pCount)
 {
-    assert(processor);
+    const _Atomic uint64_t* const trace = processor->trace;
+    const uint32_t mask = processor->traceMask;
 
-    if(processor->dma)
+    if(end < 2u)
     {
-        processor->dma = 0;
+        return ~0ull;
+    }
 
-        switch(processor->dmaOperation.op)
-        {
-            default:
-                return AR_ERROR_ILLEGAL_INSTRUCTION;
+    //The header may be overwritten by a running processor, it is checked before the record is indexed
+    const uint64_t header = atomic_load_explicit(&trace[(end - 1u) & mask], memory_order_relaxed);
+    const uint64_t cycle = atomic_load_explicit(&trace[(end - 2u) & mask], memory_order_relaxed);
+    const uint32_t size = TRACE_HEADER_SIZE(header);
+    const uint32_t count = TRACE_HEADER_COUNT(header);
+    const uint32_t words = size > 2 ? 2u : 1u;
 
-            case OPCODE_LDDMA:
-                return executeDMA(processor, 0);
+    if(count == 0 || count > TRACE_RECORD_BUNDLES || end < 2u + count * words)
+    {
+        return ~0ull;
+    }
 
-            case OPCODE_STDMA:
-                return executeDMA(processor, 1);
+    uint64_t position = end - 2u - count * words;
+    uint32_t values = 0;
+
+    for(uint32_t i = 0; i < count; ++i)
+    {
+        ArTraceEntry* restrict const entry = &entries[i];
+        const int last = i + 1u == count;
 
-            case OPCODE_LDDMAR:
-                return executeDMAR(processor, 0);
+        entry->cycle = cycle + i;
+        entry->pc = (uint16_t)(TRACE_HEADER_PC(header) + i * size);
+        entry->size = (uint8_t)size;
+        entry->faulted = (uint8_t)(last && TRACE_HEADER_FAULTED(header));
 
-            case OPCODE_STDMAR:
-                return executeDMAR(processor, 1);
+        uint64_t opcodes[2] = {atomic_load_explicit(&trace[(position + i * words) & mask], memory_order_relaxed), 0};
+        if(words > 1)
+        {
+            opcodes[1] = atomic_load_explicit(&trace[(position + i * words + 1u) & mask], memory_order_relaxed);
+        }
 
-            case OPCODE_DMAIR:
-                return executeDMAIR(processor);
+        memcpy(entry->opcodes, opcodes, sizeof(entry->opcodes));
 
-            case OPCODE_WAIT:
-                //We don't have anything to wait since we emulate it based on C memory model
-                break;
+        for(uint32_t j = 0; j < MAX_OPCODE; ++j)
+        {
+            const uint32_t slots = last ? TRACE_HEADER_SLOTS(header) : 0xFu;
+
+            Operation op;
+            uint32_t bytes;
+            const int decoded = j < size && (slots & (1u << j)) && isaDecodeOperation(j, entry->pc, entry->opcodes[j], &op);
+
+            entry->registers[j] = (uint8_t)(decoded ? writtenRegister(&op, &bytes) : AR_TRACE_REGISTER_NONE);
+            values += entry->registers[j] != AR_TRACE_REGISTER_NONE;
         }
     }
 
-    return AR_SUCCESS;
+    if(position < values)
+    {
+        return ~0ull;
+    }
+
+    position -= values;
+    const uint64_t begin = position;
+
+    for(uint32_t i = 0; i < count; ++i)
+    {
+        for(uint32_t j = 0; j < MAX_OPCODE; ++j)
+        {
+            const int written = entries[i].registers[j] != AR_TRACE_REGISTER_NONE;
+            entries[i].values[j] = written ? atomic_load_explicit(&trace[position & mask], memory_order_relaxed) : 0;
+            position += written;
+        }
+    }
+
+    *pCount = count;
+
+    return begin;
+}
+
+void arGetProcessorTrace(ArProcessor processor, uint32_t* pEntryCount, ArTraceEntry* pEntries)
+{
+    assert(processor);
+    assert(pEntryCount);
+
+    if(!processor->trace)
+    {
+        *pEntryCount = 0;
+        return;
+    }
+
+    const uint32_t capacity = pEntries ? MIN(*pEntryCount, processor->traceEntryCount) : processor->traceEntryCount;
+    const uint64_t words = processor->traceMask + 1u;
+
+    //The records are read from the most recent one, and stored from the end of pEntries
+    uint64_t end = atomic_load_explicit(&processor->traceHead, memory_order_acquire);
+    uint32_t count = 0;
+
+    while(count < capacity)
+    {
+        ArTraceEntry entries[TRACE_RECORD_BUNDLES];
+        uint32_t recordCount;
+        const uint64_t begin = readTraceRecord(processor, end, entries, &recordCount);
+
+        //A running processor may have overwritten the record while it was read, up to a whole record past its head
+        atomic_thread_fence(memory_order_acquire);
+        const uint64_t head = atomic_load_explicit(&processor->traceHead, memory_order_relaxed);
+
+        if(begin > end || head + TRACE_RECORD_WORDS - begin > words)
+        {
+            break;
+        }
+
+        for(uint32_t i = recordCount; i-- && count < capacity; ++count)
+        {
+            if(pEntries)
+            {
+                pEntries[capacity - 1u - count] = entries[i];
+            }
+        }
+
+        end = begin;
+    }
+
+    if(pEntries)
+    {
+        memmove(pEntries, pEntries + (capacity - count), count * sizeof(ArTraceEntry));
+    }
+
+    *pEntryCount = count;
+}
+
+//Whether a delayed branch is pending, it was issued by the last bundle run and the next bundle resolves it
+static int pendingBranch(ArProcessor restrict processor)
+{
+    for(uint32_t i = 0; i < MAX_OPCODE; ++i)
+    {
+        const uint32_t op = processor->delayed[i].op;
+
+        if((processor->delayedBits & (1u << i)) && ((op >= OPCODE_BNE && op <= OPCODE_BGES) || (op >= OPCODE_JMP && op <= OPCODE_RET)))
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/// \brief Count the bundle at pc, which resolved the delayed branch of the previous bundle if branch is 1
+static void profileBundle(ArProcessor restrict processor, uint32_t pc, uint32_t size, int branch)
+{
+    ProfileCounters* restrict const profile = processor->profile;
+
+    if(branch)
+    {
+        ProfileCounters* restrict const counters = &profile[processor->profilePc];
+
+        if(processor->pc != pc + size)
+        {
+            ++counters->branchesTaken;
+        }
+        else
+        {
+            ++counters->branchesNotTaken;
+        }
+    }
+
+    ++profile[pc].executions;
+    profile[pc].size = size;
+    processor->profilePc = pc;
+}
+
+void arGetProcessorProfile(ArProcessor processor, uint32_t* pRecordCount, ArProfileRecord* pRecords)
+{
+    assert(processor);
+    assert(pRecordCount);
+
+    const ProfileCounters* restrict const profile = processor->profile;
+    uint32_t count = 0;
+
+    for(uint32_t pc = 0; profile && pc < PROFILE_SIZE; ++pc)
+    {
+        if(!profile[pc].executions)
+        {
+            continue;
+        }
+
+        if(pRecords)
+        {
+            if(count == *pRecordCount)
+            {
+                break;
+            }
+
+            ArProfileRecord* restrict const record = &pRecords[count];
+            record->pc = pc;
+            record->size = profile[pc].size;
+            record->executions = profile[pc].executions;
+            record->branchesTaken = profile[pc].branchesTaken;
+            record->branchesNotTaken = profile[pc].branchesNotTaken;
+            record->dmaBytes = profile[pc].dmaBytes;
+        }
+
+        ++count;
+    }
+
+    *pRecordCount = count;
+}
+
+ArResult arExecuteInstruction(ArProcessor processor)
+{
+    assert(processor);
+
+    const uint32_t pc = processor->pc;
+    const uint32_t size = opcodeSetSize(processor->flags, pc);
+
+#ifdef AR_PEDANTIC
+    //Without a cycle budget, the bundle waits for its operands at once
+    const uint64_t stall = pipelineStall(processor, processor->pc - size, processor->operations, size, processor->cycle);
+    processor->pipelineStallCycles += stall;
+    processor->cycle += stall;
+
+    pipelineIssue(processor, processor->operations, size, processor->cycle);
+#endif
+
+    const int branch = processor->profile && pendingBranch(processor);
+
+    const ArResult result = executeBundle(processor);
+
+    if(processor->trace)
+    {
+        traceOperations(processor, pc - size, size, processor->operations, processor->cycle, result);
+    }
+
+    if(processor->profile)
+    {
+        profileBundle(processor, pc - size, size, branch);
+    }
+
+    ++processor->cycle;
+
+    //A halted processor still completes its transfers
+    if(result == AR_END_OF_CODE)
+    {
+        retireTransfers(processor, UINT64_MAX);
+    }
+
+    return result;
+}
+
+#ifndef AR_PEDANTIC //the pedantic pipeline issues every bundle on its own
+
+//Micro-op closures: one function per operation, called with the operation it was translated from
+#define OPERATION(name, ...) \
+    static ArResult microOp##name(ArProcessor restrict processor, const Operation* restrict op, uint32_t index) \
+    { \
+        uint64_t* restrict const ireg = processor->ireg; \
+        float*    const freg = (float*)processor->freg; \
+        double*   const dreg = (double*)processor->freg; \
+        Vector4f* const vreg = (Vector4f*)processor->freg; \
+        const uint8_t* restrict const operands = op->operands; \
+        (void)ireg; (void)freg; (void)dreg; (void)vreg; (void)operands; (void)index; \
+        { \
+            __VA_ARGS__ \
+        } \
+        return AR_SUCCESS; \
+    }
+
+#include "operations.inl"
+#undef OPERATION
+
+#define OPERATION(name, ...) [KERNEL_##name] = microOp##name,
+static const MicroOpHandler microOpHandlers[] =
+{
+    #include "operations.inl"
+};
+#undef OPERATION
+
+//Whether the operation has to be resolved by the per-bundle path after the bundle it belongs to
+static int endsSuperblock(const Operation* restrict op)
+{
+    switch(op->op)
+    {
+        default:
+            return 0;
+
+        case OPCODE_NOP:
+            return op->data != 0; //nop.e
+
+        case OPCODE_UNKNOWN: //fallthrough
+        case OPCODE_LDDMA:   //fallthrough
+        case OPCODE_STDMA:   //fallthrough
+        case OPCODE_LDDMAR:  //fallthrough
+        case OPCODE_STDMAR:  //fallthrough
+        case OPCODE_DMAIR:   //fallthrough
+        case OPCODE_WAIT:    //fallthrough
+        case OPCODE_XCHG:    //fallthrough
+        case OPCODE_BNE:     //fallthrough
+        case OPCODE_BEQ:     //fallthrough
+        case OPCODE_BL:      //fallthrough
+        case OPCODE_BLE:     //fallthrough
+        case OPCODE_BG:      //fallthrough
+        case OPCODE_BGE:     //fallthrough
+        case OPCODE_BLS:     //fallthrough
+        case OPCODE_BLES:    //fallthrough
+        case OPCODE_BGS:     //fallthrough
+        case OPCODE_BGES:    //fallthrough
+        case OPCODE_JMP:     //fallthrough
+        case OPCODE_CALL:    //fallthrough
+        case OPCODE_JMPR:    //fallthrough
+        case OPCODE_CALLR:   //fallthrough
+        case OPCODE_RET:
+            return 1;
+    }
+}
+
+/// \brief Get the registers an operation may write while its superblock runs, the integer ones as bits of pIntegers
+///
+/// \return 0 if the operation may write other registers than the integer ones and the flags
+static int superblockWrites(const Operation* restrict op, uint64_t* restrict pIntegers, int* restrict pFlags)
+{
+    const uint8_t* const operands = op->operands;
+    *pIntegers = 0;
+    *pFlags = 0;
+
+    if((op->op >= OPCODE_ADD && op->op <= OPCODE_LSRQ) || op->op == OPCODE_MOVEI)
+    {
+        *pIntegers = 1ull << (operands[2] & (IREG_COUNT - 1u));
+        return 1;
+    }
+
+    switch(op->op)
+    {
+        default:
+            return 0;
+
+        case OPCODE_LDM: //fallthrough
+        case OPCODE_LDC: //fallthrough
+        case OPCODE_LDMX:
+            *pIntegers = 1ull << (operands[2] & (IREG_COUNT - 1u));
+            //fallthrough
+
+        case OPCODE_STM: //fallthrough
+        case OPCODE_STC: //fallthrough
+        case OPCODE_STMX:
+            *pIntegers |= op->data ? 1ull << (operands[1] & (IREG_COUNT - 1u)) : 0u; //the incremented base
+            return 1;
+
+        case OPCODE_CMP:   //fallthrough
+        case OPCODE_CMPI:  //fallthrough
+        case OPCODE_FCMP:  //fallthrough
+        case OPCODE_FCMPI: //fallthrough
+        case OPCODE_DCMP:  //fallthrough
+        case OPCODE_DCMPI:
+            *pFlags = 1;
+            return 1;
+
+        case OPCODE_NOP:   //fallthrough
+        case OPCODE_XCHG:  //fallthrough
+        case OPCODE_BNE:   //fallthrough
+        case OPCODE_BEQ:   //fallthrough
+        case OPCODE_BL:    //fallthrough
+        case OPCODE_BLE:   //fallthrough
+        case OPCODE_BG:    //fallthrough
+        case OPCODE_BGE:   //fallthrough
+        case OPCODE_BLS:   //fallthrough
+        case OPCODE_BLES:  //fallthrough
+        case OPCODE_BGS:   //fallthrough
+        case OPCODE_BGES:  //fallthrough
+        case OPCODE_JMP:   //fallthrough
+        case OPCODE_CALL:  //fallthrough
+        case OPCODE_JMPR:  //fallthrough
+        case OPCODE_CALLR: //fallthrough
+        case OPCODE_RET:
+            return 1; //delayed, they run after the superblock
+    }
+}
+
+/// \brief Translate the bundles from pc up to the first one with a delayed, DMA or illegal operation
+///
+/// Plain nop are dropped, every bundle has the same issue width
+static int translateSuperblock(ArProcessor restrict processor, uint32_t pc, uint32_t size, Superblock* restrict output)
+{
+    uint32_t bundleCount = 0;
+    uint32_t microOpCount = 0;
+    uint32_t traceCount = 0;
+    int end = 0;
+
+    //The registers written by the bundles before the current one
+    uint64_t writtenIntegers = 0;
+    int writtenFlags = 0;
+    int traceAtEnd = 1;
+
+    while(!end && bundleCount < MAX_SUPERBLOCK_BUNDLES && opcodeSetSize(processor->flags, pc) == size)
+    {
+        const DecodedBundle* restrict const bundle = fetchBundle(processor, pc, size);
+        if(!bundle)
+        {
+            break; //the per-bundle path reports the illegal instruction
+        }
+
+        uint64_t bundleIntegers = 0;
+        int bundleFlags = 0;
+
+        for(uint32_t i = 0; i < size; ++i)
+        {
+            const Operation* restrict const op = &bundle->operations[i];
+            end |= endsSuperblock(op);
+
+            if(op->op == OPCODE_NOP && !op->data)
+            {
+                continue;
+            }
+
+            uint64_t integers;
+            int flags;
+            traceAtEnd &= superblockWrites(op, &integers, &flags) && !(integers & writtenIntegers) && !(flags && writtenFlags);
+            bundleIntegers |= integers;
+            bundleFlags |= flags;
+
+            MicroOp* restrict const microOp = &output->microOps[microOpCount++];
+            microOp->execute = microOpHandlers[op->kernel];
+            microOp->index = i;
+            microOp->operation = *op;
+
+            const uint16_t offset = processor->decodedTraceOffsets[pc / 2u][i];
+            if(offset)
+            {
+                output->traceOffsets[traceCount++] = offset;
+            }
+        }
+
+        output->traceEnds[bundleCount] = (uint8_t)traceCount;
+        output->bundleEnds[bundleCount++] = (uint8_t)microOpCount;
+        pc += size;
+
+        writtenIntegers |= bundleIntegers;
+        writtenFlags |= bundleFlags;
+    }
+
+    output->bundleCount = bundleCount;
+    output->microOpCount = microOpCount;
+    output->traceAtEnd = traceAtEnd;
+
+#ifdef AR_JIT
+    output->code = NULL;
+    output->executions = 0;
+#endif
+
+    return bundleCount != 0;
+}
+
+static Superblock* fetchSuperblock(ArProcessor restrict processor)
+{
+    const uint32_t pc = processor->pc;
+    const uint32_t size = opcodeSetSize(processor->flags, pc);
+
+    Superblock* restrict const block = &processor->superblocks[pc & (SUPERBLOCK_CACHE_SIZE - 1u)];
+
+    if(block->pc != pc || block->size != size || !block->bundleCount)
+    {
+        block->pc = pc;
+        block->size = size;
+
+        if(!translateSuperblock(processor, pc, size, block))
+        {
+            return NULL;
+        }
+    }
+
+    return block;
+}
+
+/// \brief Execute the bundles of a superblock
+///
+/// Must only be entered without pending delayed operation nor DMA, which the superblock itself
+/// can only leave after its last bundle
+static ArResult executeSuperblock(ArProcessor restrict processor, const Superblock* restrict block, uint64_t* restrict pCycles)
+{
+    const MicroOp* restrict microOp = block->microOps;
+
+    for(uint32_t i = 0; i < block->bundleCount; ++i)
+    {
+        processor->pc += block->size;
+
+        const MicroOp* const end = block->microOps + block->bundleEnds[i];
+        for(; microOp != end; ++microOp)
+        {
+            const ArResult result = microOp->execute(processor, &microOp->operation, microOp->index);
+            if(result != AR_SUCCESS)
+            {
+                *pCycles += i + 1u; //the bundle which stopped ran too
+                return result;
+            }
+        }
+    }
+
+    *pCycles += block->bundleCount;
+
+    return AR_SUCCESS;
+}
+
+/// \brief Count the first count bundles of a superblock, which left its last bundle run as the issuer of the pending operations
+static void profileSuperblock(ArProcessor restrict processor, const Superblock* restrict block, uint32_t count)
+{
+    ProfileCounters* restrict const profile = processor->profile;
+    uint32_t pc = block->pc;
+
+    for(uint32_t i = 0; i < count; ++i, pc += block->size)
+    {
+        ++profile[pc].executions;
+        profile[pc].size = block->size;
+    }
+
+    processor->profilePc = pc - block->size;
+}
+
+/// \brief Execute the bundles of a superblock like executeSuperblock, and record them in the trace
+static ArResult executeTracedSuperblock(ArProcessor restrict processor, const Superblock* restrict block, uint64_t* restrict pCycles)
+{
+    closeTrace(processor);
+
+    const uint64_t head = atomic_load_explicit(&processor->traceHead, memory_order_relaxed);
+    _Atomic uint64_t* out = &processor->trace[head & processor->traceMask];
+
+    const MicroOp* restrict microOp = block->microOps;
+    const uint16_t* restrict offset = block->traceOffsets;
+
+    ArResult result = AR_SUCCESS;
+    uint32_t count = 0;
+
+    while(count < block->bundleCount)
+    {
+        processor->pc += block->size;
+
+        const MicroOp* const end = block->microOps + block->bundleEnds[count];
+        for(; microOp != end && result == AR_SUCCESS; ++microOp)
+        {
+            result = microOp->execute(processor, &microOp->operation, microOp->index);
+        }
+
+        if(result != AR_SUCCESS)
+        {
+            break;
+        }
+
+        ++count;
+
+        if(!block->traceAtEnd)
+        {
+            for(const uint16_t* const last = block->traceOffsets + block->traceEnds[count - 1u]; offset != last; ++offset)
+            {
+                out = traceValue(processor, out, *offset);
+            }
+        }
+    }
+
+    //Unless a bundle overwrote a register an earlier one wrote, the values are read once after the last bundle
+    if(block->traceAtEnd && count)
+    {
+        for(const uint16_t* const last = block->traceOffsets + block->traceEnds[count - 1u]; offset != last; ++offset)
+        {
+            out = traceValue(processor, out, *offset);
+        }
+    }
+
+    //The last bundle records the registers of the operations it ran before it stopped
+    uint32_t slots = 0xFu;
+    if(result != AR_SUCCESS)
+    {
+        slots = 0;
+        for(const MicroOp* traced = block->microOps + (count ? block->bundleEnds[count - 1u] : 0u); traced != microOp; ++traced)
+        {
+            const uint32_t written = traceOffset(&traced->operation);
+            if(written)
+            {
+                out = traceValue(processor, out, written);
+            }
+
+            slots |= 1u << traced->index;
+        }
+
+        ++count;
+    }
+
+    if(result == AR_SUCCESS)
+    {
+        //The record stays open for the next bundle, the delay slot of the branch which usually ends the superblock
+        processor->traceOut = out;
+        processor->traceCycle = processor->cycle + *pCycles;
+        processor->tracePc = block->pc;
+        processor->traceSize = block->size;
+        processor->traceCount = count;
+    }
+    else
+    {
+        traceBundles(processor, out, block->pc, block->size, count, processor->cycle + *pCycles, result < AR_SUCCESS, slots);
+    }
+
+    *pCycles += count;
+
+    return result;
+}
+
+#endif
+
+static void invalidateSuperblocks(ArProcessor restrict processor, uint64_t address, size_t size)
+{
+    const uint32_t maxLength = MAX_SUPERBLOCK_BUNDLES * MAX_OPCODE;
+
+    const uint32_t last  = (uint32_t)((address + size + 3u) / 4u);
+    const uint32_t first = (uint32_t)(address / 4u);
+    const uint32_t begin = first > (maxLength - 1u) ? first - (maxLength - 1u) : 0u;
+
+#ifdef AR_JIT
+    int compiled = 0;
+#endif
+
+    for(uint32_t i = 0; i < SUPERBLOCK_CACHE_SIZE; ++i)
+    {
+        Superblock* restrict const block = &processor->superblocks[i];
+#ifdef AR_JIT
+        const uint32_t length = (block->bundleCount + 1u) * block->size; //compiled code includes the delay slot
+#else
+        const uint32_t length = block->bundleCount * block->size;
+#endif
+
+        if(block->pc >= begin && block->pc < last && block->pc + length > first)
+        {
+#ifdef AR_JIT
+            compiled |= block->code != NULL;
+#endif
+            block->bundleCount = 0;
+        }
+    }
+
+#ifdef AR_JIT
+    //Other compiled superblocks may continue into the stale code
+    if(compiled)
+    {
+        jitFlush(processor);
+    }
+#endif
+}
+
+//DMA transfers are atomic when processors run concurrently
+static void lockPhysicalMemory(ArVirtualMachine virtualMachine)
+{
+#ifdef AR_THREADS
+    if(virtualMachine->parallel)
+    {
+        pthread_mutex_lock(&virtualMachine->memoryLock);
+    }
+#else
+    (void)virtualMachine;
+#endif
+}
+
+static void unlockPhysicalMemory(ArVirtualMachine virtualMachine)
+{
+#ifdef AR_THREADS
+    if(virtualMachine->parallel)
+    {
+        pthread_mutex_unlock(&virtualMachine->memoryLock);
+    }
+#else
+    (void)virtualMachine;
+#endif
+}
+
+/// \brief Get the physical memory of the size bytes at ramAddress, which must all belong to it
+///
+/// The physical memory of the last transfer is tried first, the others are looked up by a binary search on their addresses
+static ArResult checkRAM(ArProcessor restrict processor, uint64_t ramAddress, size_t size, ArPhysicalMemory* restrict pMemory)
+{
+    const ArVirtualMachine virtualMachine = processor->parent;
+    if(!virtualMachine->memoryCount)
+    {
+        return AR_ERROR_ILLEGAL_INSTRUCTION;
+    }
+
+    ArPhysicalMemory memory = processor->dmaMemory;
+    if(!memory || ramAddress - memory->address >= memory->size) //wraps around below the memory
+    {
+        const uint32_t index = findPhysicalMemory(virtualMachine, ramAddress);
+        if(index == 0)
+        {
+            return AR_ERROR_PHYSICAL_MEMORY_OUT_OF_RANGE;
+        }
+
+        memory = virtualMachine->memories[index - 1u];
+        if(ramAddress - memory->address >= memory->size)
+        {
+            return AR_ERROR_PHYSICAL_MEMORY_OUT_OF_RANGE;
+        }
+
+        processor->dmaMemory = memory;
+    }
+
+    const uint64_t offset = ramAddress - memory->address;
+    if(size > memory->size - offset)
+    {
+        return AR_ERROR_PHYSICAL_MEMORY_OUT_OF_RANGE;
+    }
+
+    *pMemory = memory;
+
+    return AR_SUCCESS;
+}
+
+static void copyFromRAM(ArProcessor restrict processor, ArPhysicalMemory memory, uint64_t offset, uint8_t* restrict output, size_t size)
+{
+    lockPhysicalMemory(processor->parent);
+    readPhysicalMemory(memory, offset, output, size);
+    unlockPhysicalMemory(processor->parent);
+}
+
+static void copyToRAM(ArProcessor restrict processor, ArPhysicalMemory memory, uint64_t offset, const uint8_t* restrict input, size_t size)
+{
+    lockPhysicalMemory(processor->parent);
+    markPhysicalMemoryDirty(memory, offset, size);
+    memcpy(writablePhysicalMemory(memory, offset, size), input, size);
+    unlockPhysicalMemory(processor->parent);
+}
+
+/// \brief Write a dirty line back to the physical memory it was filled from
+static ArResult writeBackCacheLine(ArProcessor restrict processor, uint32_t index)
+{
+    const uint32_t shift = processor->cacheLineShift;
+    const uint64_t tag = processor->cacheTags[index];
+
+    const uint64_t lineAddress = tag & ~(uint64_t)(CACHE_LINE_VALID | CACHE_LINE_DIRTY);
+
+    ArPhysicalMemory memory;
+    const ArResult result = checkRAM(processor, lineAddress, 1u << shift, &memory);
+    if(result != AR_SUCCESS)
+    {
+        return result;
+    }
+
+    copyToRAM(processor, memory, lineAddress - memory->address, processor->cache + ((size_t)index << shift), 1u << shift);
+
+    processor->cacheTags[index] = tag & ~(uint64_t)CACHE_LINE_DIRTY;
+    ++processor->cacheWritebacks;
+
+    return AR_SUCCESS;
+}
+
+/// \brief Get the cache bytes of the physical address, up to the end of its line, filling the line on a miss
+static ArResult fetchCacheLine(ArProcessor restrict processor, uint64_t address, uint32_t dirty, uint8_t** restrict pData)
+{
+    const uint32_t shift = processor->cacheLineShift;
+    const uint64_t lineAddress = address & ~(((uint64_t)1u << shift) - 1u);
+    const uint32_t index = (uint32_t)(address >> shift) & ((CACHE_SIZE >> shift) - 1u);
+
+    uint64_t* restrict const tag = &processor->cacheTags[index];
+    uint8_t* restrict const line = processor->cache + ((size_t)index << shift);
+
+    if((*tag | CACHE_LINE_DIRTY) == (lineAddress | CACHE_LINE_VALID | CACHE_LINE_DIRTY))
+    {
+        ++processor->cacheHits;
+    }
+    else
+    {
+        //The fill is checked first so that a faulting access leaves the line it would replace
+        ArPhysicalMemory memory;
+        const ArResult result = checkRAM(processor, lineAddress, 1u << shift, &memory);
+        if(result != AR_SUCCESS)
+        {
+            return result;
+        }
+
+        if(*tag & CACHE_LINE_VALID)
+        {
+            if(*tag & CACHE_LINE_DIRTY)
+            {
+                const ArResult writeBack = writeBackCacheLine(processor, index);
+                if(writeBack != AR_SUCCESS)
+                {
+                    return writeBack;
+                }
+            }
+
+            ++processor->cacheEvictions;
+        }
+
+        copyFromRAM(processor, memory, lineAddress - memory->address, line, 1u << shift);
+
+        *tag = lineAddress | CACHE_LINE_VALID;
+        ++processor->cacheMisses;
+    }
+
+    *tag |= dirty;
+    *pData = line + (address - lineAddress);
+
+    return AR_SUCCESS;
+}
+
+//An access crossing lines is split between them
+static ArResult loadCache(ArProcessor restrict processor, uint64_t address, void* restrict output, uint32_t size)
+{
+    uint8_t* restrict bytes = output;
+    const uint32_t lineSize = 1u << processor->cacheLineShift;
+
+    while(size)
+    {
+        uint8_t* data;
+        const ArResult result = fetchCacheLine(processor, address, 0, &data);
+        if(result != AR_SUCCESS)
+        {
+            return result;
+        }
+
+        const uint32_t left = lineSize - (uint32_t)(address & (lineSize - 1u));
+        const uint32_t count = size < left ? size : left;
+
+        memcpy(bytes, data, count);
+
+        bytes += count;
+        address += count;
+        size -= count;
+    }
+
+    return AR_SUCCESS;
+}
+
+static ArResult storeCache(ArProcessor restrict processor, uint64_t address, const void* restrict input, uint32_t size)
+{
+    const uint8_t* restrict bytes = input;
+    const uint32_t lineSize = 1u << processor->cacheLineShift;
+
+    while(size)
+    {
+        uint8_t* data;
+        const ArResult result = fetchCacheLine(processor, address, CACHE_LINE_DIRTY, &data);
+        if(result != AR_SUCCESS)
+        {
+            return result;
+        }
+
+        const uint32_t left = lineSize - (uint32_t)(address & (lineSize - 1u));
+        const uint32_t count = size < left ? size : left;
+
+        memcpy(data, bytes, count);
+
+        bytes += count;
+        address += count;
+        size -= count;
+    }
+
+    return AR_SUCCESS;
+}
+
+static void completeTransfer(ArProcessor restrict processor, const DmaTransfer* restrict transfer)
+{
+    switch(transfer->op)
+    {
+        default:
+            copyFromRAM(processor, transfer->memory, transfer->ram, processor->dsram + transfer->sram, transfer->size);
+            break;
+
+        case OPCODE_STDMA:  //fallthrough
+        case OPCODE_STDMAR:
+            copyToRAM(processor, transfer->memory, transfer->ram, processor->dsram + transfer->sram, transfer->size);
+            break;
+
+        case OPCODE_DMAIR:
+            copyFromRAM(processor, transfer->memory, transfer->ram, processor->isram + transfer->sram, transfer->size);
+            decodeInstructionMemory(processor, (uint32_t)(transfer->sram / 4u), (uint32_t)((transfer->sram + transfer->size + 3u) / 4u));
+            invalidateSuperblocks(processor, transfer->sram, transfer->size);
+            break;
+    }
+}
+
+/// \brief Complete, in issue order, the transfers due at the cycle now
+static void retireTransfers(ArProcessor restrict processor, uint64_t now)
+{
+    while(processor->dmaCount)
+    {
+        const DmaTransfer* restrict const transfer = &processor->dmaQueue[processor->dmaHead];
+        if(transfer->completion > now)
+        {
+            break;
+        }
+
+        completeTransfer(processor, transfer);
+
+        processor->dmaHead = (processor->dmaHead + 1u) & (DMA_QUEUE_SIZE - 1u);
+        --processor->dmaCount;
+    }
+}
+
+void retireMemoryTransfers(ArProcessor processor, ArPhysicalMemory memory)
+{
+    uint32_t count = 0;
+    for(uint32_t i = 0; i < processor->dmaCount; ++i)
+    {
+        if(processor->dmaQueue[(processor->dmaHead + i) & (DMA_QUEUE_SIZE - 1u)].memory == memory)
+        {
+            count = i + 1u;
+        }
+    }
+
+    for(; count; --count)
+    {
+        completeTransfer(processor, &processor->dmaQueue[processor->dmaHead]);
+
+        processor->dmaHead = (processor->dmaHead + 1u) & (DMA_QUEUE_SIZE - 1u);
+        --processor->dmaCount;
+    }
+}
+
+/// \brief Queue a validated transfer, the engine moves bandwidth bytes per cycle and the copy happens latency cycles later
+static void issueTransfer(ArProcessor restrict processor, uint32_t op, ArPhysicalMemory memory, uint64_t ram, uint64_t sram, size_t size, uint64_t now)
+{
+    if(processor->dmaCount == DMA_QUEUE_SIZE)
+    {
+        //The queue accepts the transfer once its oldest one has completed, the processor stalls meanwhile
+        const uint64_t completion = processor->dmaQueue[processor->dmaHead].completion;
+        if(completion > now)
+        {
+            recordStall(processor, processor->dmaPc, AR_STALL_CAUSE_DMA_WAIT, STALL_NO_REGISTER, completion - now);
+            now = completion;
+            processor->stallUntil = completion > processor->stallUntil ? completion : processor->stallUntil;
+        }
+
+        retireTransfers(processor, now);
+    }
+
+    const uint64_t bandwidth = processor->dmaBandwidth;
+    const uint64_t duration  = bandwidth ? (size + bandwidth - 1u) / bandwidth : 0u;
+    const uint64_t start     = now > processor->dmaBusyUntil ? now : processor->dmaBusyUntil;
+
+    processor->dmaBusyUntil = start + duration;
+
+    DmaTransfer* restrict const transfer = &processor->dmaQueue[(processor->dmaHead + processor->dmaCount) & (DMA_QUEUE_SIZE - 1u)];
+    transfer->completion = processor->dmaBusyUntil + processor->dmaLatency;
+    transfer->memory = memory;
+    transfer->ram = ram;
+    transfer->sram = (uint32_t)sram;
+    transfer->size = (uint32_t)size;
+    transfer->op = op;
+
+    ++processor->dmaCount;
+    ++processor->dmaTransfers;
+    processor->dmaBytes += size;
+
+    if(processor->profile)
+    {
+        processor->profile[processor->profilePc].dmaBytes += size;
+    }
+}
+
+static ArResult executeDMA(ArProcessor restrict processor, uint64_t now)
+{
+    //RAM -> SDRAM
+    uint64_t* restrict const ireg = processor->ireg;
+
+    const Operation* restrict      op       = &processor->dmaOperation;
+    const uint8_t* restrict const operands = op->operands;
+
+    const uint64_t sramb = (op->imm)        & 0x0FFFu;
+    const uint64_t ramb  = (op->imm >> 12u) & 0x0FFFu;
+    const uint64_t sram  = (ireg[operands[0]] + sramb) * 32ull;
+    const uint64_t ram   = (ireg[operands[1]] + ramb)  * 32ull;
+    const size_t   size  = (op->size + 1u) * 32u;
+
+    if(sram + size > DSRAM_SIZE)
+    {
+        return AR_ERROR_MEMORY_OUT_OF_RANGE;
+    }
+
+    ArPhysicalMemory memory;
+    const ArResult result = checkRAM(processor, ram, size, &memory);
+    if(result == AR_SUCCESS)
+    {
+        issueTransfer(processor, op->op, memory, ram - memory->address, sram, size, now);
+    }
+
+    return result;
+}
+
+static ArResult executeDMAR(ArProcessor restrict processor, uint64_t now)
+{
+    //RAM -> SDRAM
+    uint64_t* restrict const ireg = processor->ireg;
+
+    const Operation* restrict      op       = &processor->dmaOperation;
+    const uint8_t* restrict const operands = op->operands;
+
+    const uint64_t sram = ireg[operands[0]] * 32ull;
+    const uint64_t ram  = ireg[operands[1]] * 32ull;
+    const size_t   size = op->imm * 32u;
+
+    if(sram + size > DSRAM_SIZE)
+    {
+        return AR_ERROR_MEMORY_OUT_OF_RANGE;
+    }
+
+    ArPhysicalMemory memory;
+    const ArResult result = checkRAM(processor, ram, size, &memory);
+    if(result == AR_SUCCESS)
+    {
+        issueTransfer(processor, op->op, memory, ram - memory->address, sram, size, now);
+    }
+
+    return result;
+}
+
+static ArResult executeDMAIR(ArProcessor restrict processor, uint64_t now)
+{
+    //RAM -> SDRAM
+    uint64_t* restrict const ireg = processor->ireg;
+
+    const Operation* restrict      op       = &processor->dmaOperation;
+    const uint8_t* restrict const operands = op->operands;
+
+    const uint64_t sram = ireg[operands[0]] * 32ull;
+    const uint64_t ram  = ireg[operands[1]] * 32ull;
+    const size_t   size = op->imm * 32u;
+
+    if(sram + size > ISRAM_SIZE)
+    {
+        return AR_ERROR_MEMORY_OUT_OF_RANGE;
+    }
+
+    ArPhysicalMemory memory;
+    const ArResult result = checkRAM(processor, ram, size, &memory);
+    if(result == AR_SUCCESS)
+    {
+        issueTransfer(processor, op->op, memory, ram - memory->address, sram, size, now);
+    }
+
+    return result;
+}
+
+/// \brief Issue the DMA operation of the last bundle, then complete the transfers due at the cycle now
+static ArResult executeDirectMemoryAccess(ArProcessor restrict processor, uint64_t now)
+{
+    ArResult result = AR_SUCCESS;
+
+    if(processor->dma)
+    {
+        processor->dma = 0;
+
+        switch(processor->dmaOperation.op)
+        {
+            default:
+                return AR_ERROR_ILLEGAL_INSTRUCTION;
+
+            case OPCODE_LDDMA:  //fallthrough
+            case OPCODE_STDMA:
+                result = executeDMA(processor, now);
+                break;
+
+            case OPCODE_LDDMAR: //fallthrough
+            case OPCODE_STDMAR:
+                result = executeDMAR(processor, now);
+                break;
+
+            case OPCODE_DMAIR:
+                result = executeDMAIR(processor, now);
+                break;
+
+            case OPCODE_WAIT:
+                if(processor->dmaCount)
+                {
+                    const uint32_t last = (processor->dmaHead + processor->dmaCount - 1u) & (DMA_QUEUE_SIZE - 1u);
+                    const uint64_t completion = processor->dmaQueue[last].completion;
+                    if(completion > now)
+                    {
+                        recordStall(processor, processor->dmaPc, AR_STALL_CAUSE_DMA_WAIT, STALL_NO_REGISTER, completion - now);
+                    }
+
+                    processor->stallUntil = completion > processor->stallUntil ? completion : processor->stallUntil;
+                }
+                break;
+        }
+    }
+
+    if(processor->dmaCount)
+    {
+        retireTransfers(processor, now);
+    }
+
+    return result;
+}
+
+ArResult arExecuteDirectMemoryAccess(ArProcessor processor)
+{
+    assert(processor);
+
+    const ArResult result = executeDirectMemoryAccess(processor, processor->cycle);
+
+    //Without a cycle budget, a stall is run at once
+    if(processor->stallUntil > processor->cycle)
+    {
+        processor->dmaStallCycles += processor->stallUntil - processor->cycle;
+        processor->cycle = processor->stallUntil;
+
+        retireTransfers(processor, processor->cycle);
+    }
+
+    return result;
+}
+
+//An even word is the first op-code of its bundle or the third of the bundle before, an odd word the second or the fourth
+static uint64_t countIllegalOpcodes(ArProcessor restrict processor)
+{
+    uint64_t count = 0;
+
+    for(uint32_t i = 0; i < DECODED_BUNDLES; ++i)
+    {
+        const Operation* restrict const operations = processor->decodedBundles[i].operations;
+        const Operation* restrict const previous = i > 0 ? processor->decodedBundles[i - 1u].operations : NULL;
+
+        for(uint32_t j = 0; j < 2u; ++j)
+        {
+            if(operations[j].op == OPCODE_UNKNOWN && (!previous || previous[j + 2u].op == OPCODE_UNKNOWN))
+            {
+                ++count;
+            }
+        }
+    }
+
+    return count;
+}
+
+void arGetProcessorStatistics(ArProcessor processor, ArProcessorStatistics* pStatistics)
+{
+    assert(processor);
+    assert(pStatistics);
+    assert(pStatistics->sType == AR_STRUCTURE_TYPE_PROCESSOR_STATISTICS);
+
+    pStatistics->cycles = processor->cycle;
+    pStatistics->dmaTransfers = processor->dmaTransfers;
+    pStatistics->dmaBytes = processor->dmaBytes;
+    pStatistics->dmaStallCycles = processor->dmaStallCycles;
+
+#ifdef AR_PEDANTIC
+    pStatistics->pipelineHazards = processor->pipelineHazards;
+    pStatistics->pipelineStallCycles = processor->pipelineStallCycles;
+#else
+    pStatistics->pipelineHazards = 0;
+    pStatistics->pipelineStallCycles = 0;
+#endif
+
+    pStatistics->cacheHits = processor->cacheHits;
+    pStatistics->cacheMisses = processor->cacheMisses;
+    pStatistics->cacheEvictions = processor->cacheEvictions;
+    pStatistics->cacheWritebacks = processor->cacheWritebacks;
+    pStatistics->illegalOpcodes = countIllegalOpcodes(processor);
+}
+
+ArResult arFlushProcessorCache(ArProcessor processor)
+{
+    assert(processor);
+
+    if(!processor->cacheTags)
+    {
+        return AR_SUCCESS;
+    }
+
+    const uint32_t lineCount = CACHE_SIZE >> processor->cacheLineShift;
+    for(uint32_t i = 0; i < lineCount; ++i)
+    {
+        if(processor->cacheTags[i] & CACHE_LINE_DIRTY)
+        {
+            const ArResult result = writeBackCacheLine(processor, i);
+            if(result != AR_SUCCESS)
+            {
+                return result;
+            }
+        }
+    }
+
+    return AR_SUCCESS;
+}
+
+static uint32_t hashStall(uint32_t pc, uint32_t cause, uint32_t reg)
+{
+    return (pc * 0x9E3779B1u) ^ (cause * 0x85EBCA77u) ^ (reg * 0xC2B2AE3Du);
+}
+
+static StallEntry* findStall(StallEntry* restrict entries, uint32_t capacity, uint32_t pc, uint32_t cause, uint32_t reg)
+{
+    uint32_t i = hashStall(pc, cause, reg) & (capacity - 1u);
+
+    while(entries[i].used && (entries[i].pc != pc || entries[i].cause != cause || entries[i].reg != reg))
+    {
+        i = (i + 1u) & (capacity - 1u);
+    }
+
+    return &entries[i];
+}
+
+//Keeps the table at most half full, a failed allocation drops the stall
+static int reserveStall(ArProcessor restrict processor)
+{
+    if((processor->stallCount + 1u) * 2u <= processor->stallCapacity)
+    {
+        return 1;
+    }
+
+    const uint32_t capacity = processor->stallCapacity ? processor->stallCapacity * 2u : STALL_TABLE_MIN_CAPACITY;
+
+    StallEntry* const entries = calloc(capacity, sizeof(StallEntry));
+    if(!entries)
+    {
+        return 0;
+    }
+
+    for(uint32_t i = 0; i < processor->stallCapacity; ++i)
+    {
+        const StallEntry* const entry = &processor->stalls[i];
+        if(entry->used)
+        {
+            *findStall(entries, capacity, entry->pc, entry->cause, entry->reg) = *entry;
+        }
+    }
+
+    free(processor->stalls);
+    processor->stalls = entries;
+    processor->stallCapacity = capacity;
+
+    return 1;
+}
+
+void recordStall(ArProcessor processor, uint32_t pc, ArStallCause cause, uint32_t reg, uint64_t cycles)
+{
+    if(!reserveStall(processor))
+    {
+        return;
+    }
+
+    StallEntry* const entry = findStall(processor->stalls, processor->stallCapacity, pc, (uint32_t)cause, reg);
+    if(!entry->used)
+    {
+        entry->pc = pc;
+        entry->reg = (uint16_t)reg;
+        entry->cause = (uint8_t)cause;
+        entry->used = 1;
+        ++processor->stallCount;
+    }
+
+    ++entry->count;
+    entry->cycles += cycles;
+}
+
+static int compareStallRecords(const void* pLeft, const void* pRight)
+{
+    const ArStallRecord* const left = pLeft;
+    const ArStallRecord* const right = pRight;
+
+    if(left->cycles != right->cycles)
+    {
+        return left->cycles > right->cycles ? -1 : 1;
+    }
+
+    if(left->pc != right->pc)
+    {
+        return left->pc < right->pc ? -1 : 1;
+    }
+
+    if(left->cause != right->cause)
+    {
+        return left->cause < right->cause ? -1 : 1;
+    }
+
+    return left->reg < right->reg ? -1 : left->reg > right->reg;
+}
+
+ArResult arGetProcessorStallReport(ArProcessor processor, uint32_t* pRecordCount, ArStallRecord* pRecords)
+{
+    assert(processor);
+    assert(pRecordCount);
+
+    if(!pRecords)
+    {
+        *pRecordCount = processor->stallCount;
+        return AR_SUCCESS;
+    }
+
+    ArStallRecord* const records = malloc((processor->stallCount ? processor->stallCount : 1u) * sizeof(ArStallRecord));
+    if(!records)
+    {
+        return AR_ERROR_HOST_OUT_OF_MEMORY;
+    }
+
+    uint32_t count = 0;
+    for(uint32_t i = 0; i < processor->stallCapacity; ++i)
+    {
+        const StallEntry* const entry = &processor->stalls[i];
+        if(entry->used)
+        {
+            ArStallRecord* const record = &records[count++];
+            record->pc = entry->pc;
+            record->cause = (ArStallCause)entry->cause;
+            record->reg = entry->reg == STALL_NO_REGISTER ? AR_STALL_REGISTER_NONE : entry->reg;
+            record->count = entry->count;
+            record->cycles = entry->cycles;
+        }
+    }
+
+    qsort(records, count, sizeof(ArStallRecord), compareStallRecords);
+
+    *pRecordCount = count < *pRecordCount ? count : *pRecordCount;
+    memcpy(pRecords, records, *pRecordCount * sizeof(ArStallRecord));
+
+    free(records);
+
+    return AR_SUCCESS;
+}
+
+ArResult arRunProcessor(ArProcessor processor, uint64_t maxCycles, uint64_t* pExecutedCycles)
+{
+    assert(processor);
+
+    ArResult result = AR_SUCCESS;
+    uint64_t cycles = 0;
+
+    while(cycles < maxCycles)
+    {
+        uint64_t budget = maxCycles - cycles;
+
+        if(processor->dmaCount)
+        {
+            const uint64_t now = processor->cycle + cycles;
+
+            if(processor->stallUntil > now)
+            {
+                const uint64_t stall = processor->stallUntil - now < budget ? processor->stallUntil - now : budget;
+                processor->dmaStallCycles += stall;
+                cycles += stall;
+
+                continue;
+            }
+
+            retireTransfers(processor, now);
+
+            //Superblocks must not run past the completion of a transfer
+            if(processor->dmaCount)
+            {
+                const uint64_t completion = processor->dmaQueue[processor->dmaHead].completion - now;
+                budget = completion < budget ? completion : budget;
+            }
+        }
+
+#ifdef AR_PEDANTIC
+        //The bundle waits in RR until the registers it reads are written back
+        const uint32_t size = opcodeSetSize(processor->flags, processor->pc);
+        const DecodedBundle* restrict const bundle = fetchBundle(processor, processor->pc, size);
+        if(bundle)
+        {
+            const uint64_t stall = pipelineStall(processor, processor->pc, bundle->operations, size, processor->cycle + cycles);
+            if(stall)
+            {
+                const uint64_t wait = stall < budget ? stall : budget;
+                processor->pipelineStallCycles += wait;
+                cycles += wait;
+
+                continue;
+            }
+        }
+#else
+        //Straight-line code runs as a whole superblock when nothing is pending from the previous bundle
+        if(!processor->delayedBits)
+        {
+            Superblock* restrict const block = fetchSuperblock(processor);
+
+#ifdef AR_JIT
+            //Compiled code does not trace nor profile
+            if(block && !block->code && !processor->trace && !processor->profile && ++block->executions == JIT_THRESHOLD)
+            {
+                const uint32_t next = block->pc + block->bundleCount * block->size;
+                jitCompileSuperblock(processor, block, fetchBundle(processor, next, block->size));
+            }
+
+            if(block && block->code && block->codeBundles <= budget)
+            {
+                result = block->code(processor, &cycles, cycles + budget);
+                if(result != AR_SUCCESS)
+                {
+                    break;
+                }
+
+                continue;
+            }
+#endif
+
+            if(block && block->bundleCount <= budget)
+            {
+                const uint64_t start = cycles;
+
+                result = processor->trace ? executeTracedSuperblock(processor, block, &cycles) : executeSuperblock(processor, block, &cycles);
+
+                if(processor->profile)
+                {
+                    profileSuperblock(processor, block, (uint32_t)(cycles - start));
+                }
+
+                if(result != AR_SUCCESS)
+                {
+                    break;
+                }
+
+                result = executeDirectMemoryAccess(processor, processor->cycle + cycles);
+                if(result != AR_SUCCESS)
+                {
+                    break;
+                }
+
+                continue;
+            }
+        }
+#endif
+
+        const uint32_t pc = processor->pc;
+
+        result = decodeInstruction(processor);
+        if(result != AR_SUCCESS)
+        {
+            if(processor->trace)
+            {
+                traceOperations(processor, pc, opcodeSetSize(processor->flags, pc), NULL, processor->cycle + cycles, result);
+            }
+
+            break;
+        }
+
+        const uint32_t bundleSize = processor->pc - pc; //branches overwrite the program counter
+        const int branch = processor->profile && pendingBranch(processor);
+
+#ifdef AR_PEDANTIC
+        pipelineIssue(processor, processor->operations, size, processor->cycle + cycles);
+#endif
+
+        result = executeBundle(processor);
+
+        if(processor->trace)
+        {
+            traceOperations(processor, pc, bundleSize, processor->operations, processor->cycle + cycles, result);
+        }
+
+        if(processor->profile)
+        {
+            profileBundle(processor, pc, bundleSize, branch);
+        }
+
+        //A bundle which ends the code or fails takes its cycle, as in arExecuteInstruction
+        ++cycles;
+
+        if(result != AR_SUCCESS)
+        {
+            break;
+        }
+
+        result = executeDirectMemoryAccess(processor, processor->cycle + cycles);
+        if(result != AR_SUCCESS)
+        {
+            break;
+        }
+    }
+
+    if(processor->trace)
+    {
+        closeTrace(processor);
+    }
+
+    processor->cycle += cycles;
+
+    //A halted processor still completes its transfers
+    if(result == AR_END_OF_CODE)
+    {
+        retireTransfers(processor, UINT64_MAX);
+    }
+
+    if(pExecutedCycles)
+    {
+        *pExecutedCycles = cycles;
+    }
+
+    return result;
 }
@@ -0,0 +1,634 @@
+#include "vm.h"
+
+#ifdef AR_JIT
+    #include "jit.h"
+#endif
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <assert.h>
+#include <string.h>
+
+#define STATE_MAGIC   (0x54535241u) //"ARST"
+#define STATE_VERSION (3u)
+
+typedef struct StateHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t processorSize; //< sizeof(ArProcessor_T), which tells the implementations apart
+    uint32_t processorCount;
+    uint32_t memoryCount;
+    uint32_t reserved;
+} StateHeader;
+
+//The members of ArProcessor_T from first to last included, saved as one block
+#define MEMBERS_SIZE(first, last) (offsetof(ArProcessor_T, last) + sizeof(((ArProcessor_T*)0)->last) - offsetof(ArProcessor_T, first))
+
+typedef struct Writer
+{
+    uint8_t* data; //< NULL while the size of the state is measured
+    uint64_t size;
+} Writer;
+
+typedef struct Reader
+{
+    const uint8_t* data;
+    uint64_t size;
+    uint64_t offset;
+    int apply; //< 0 while the state is validated, 1 while it is loaded
+} Reader;
+
+static void writeValue(Writer* restrict writer, const void* restrict value, uint64_t size)
+{
+    if(writer->data && size)
+    {
+        memcpy(writer->data + writer->size, value, size);
+    }
+
+    writer->size += size;
+}
+
+//Always copies the next size bytes to value, fails past the end of the state
+static int readValue(Reader* restrict reader, void* restrict value, uint64_t size)
+{
+    if(size > reader->size - reader->offset)
+    {
+        return 0;
+    }
+
+    memcpy(value, reader->data + reader->offset, size);
+    reader->offset += size;
+
+    return 1;
+}
+
+//Only copies the next size bytes to value while the state is loaded, fails past the end of the state
+static int loadValue(Reader* restrict reader, void* restrict value, uint64_t size)
+{
+    if(size > reader->size - reader->offset)
+    {
+        return 0;
+    }
+
+    if(reader->apply)
+    {
+        memcpy(value, reader->data + reader->offset, size);
+    }
+
+    reader->offset += size;
+
+    return 1;
+}
+
+static uint64_t pageBytes(ArPhysicalMemory memory, uint64_t page)
+{
+    const uint64_t offset = page << MEMORY_PAGE_SHIFT;
+
+    return memory->size - offset < MEMORY_PAGE_SIZE ? memory->size - offset : MEMORY_PAGE_SIZE;
+}
+
+static int isPageDirty(ArPhysicalMemory memory, uint64_t page)
+{
+    return (memory->dirtyPages[page / 64u] >> (page % 64u)) & 1u;
+}
+
+static PristinePage* findPristine(PristinePage* restrict entries, uint32_t capacity, uint64_t page)
+{
+    uint32_t i = (uint32_t)((page * 0x9E3779B97F4A7C15ull) >> 32u) & (capacity - 1u);
+
+    while(entries[i].bytes && entries[i].page != page)
+    {
+        i = (i + 1u) & (capacity - 1u);
+    }
+
+    return &entries[i];
+}
+
+//Keeps the table at most half full
+static int reservePristine(ArPhysicalMemory memory)
+{
+    if((memory->pristineCount + 1u) * 2u <= memory->pristineCapacity)
+    {
+        return 1;
+    }
+
+    const uint32_t capacity = memory->pristineCapacity ? memory->pristineCapacity * 2u : PRISTINE_TABLE_MIN_CAPACITY;
+
+    PristinePage* const entries = calloc(capacity, sizeof(PristinePage));
+    if(!entries)
+    {
+        return 0;
+    }
+
+    for(uint32_t i = 0; i < memory->pristineCapacity; ++i)
+    {
+        const PristinePage* const entry = &memory->pristinePages[i];
+        if(entry->bytes)
+        {
+            *findPristine(entries, capacity, entry->page) = *entry;
+        }
+    }
+
+    free(memory->pristinePages);
+    memory->pristinePages = entries;
+    memory->pristineCapacity = capacity;
+
+    return 1;
+}
+
+//A page reverted by arLoadState keeps the pristine content it already has
+static void keepPristinePage(ArPhysicalMemory memory, uint64_t page)
+{
+    if(!reservePristine(memory))
+    {
+        memory->pristineLost = 1;
+        return;
+    }
+
+    PristinePage* const entry = findPristine(memory->pristinePages, memory->pristineCapacity, page);
+    if(entry->bytes)
+    {
+        return;
+    }
+
+    entry->bytes = malloc(MEMORY_PAGE_SIZE);
+    if(!entry->bytes)
+    {
+        memory->pristineLost = 1;
+        return;
+    }
+
+    entry->page = page;
+    readPhysicalMemory(memory, page << MEMORY_PAGE_SHIFT, entry->bytes, pageBytes(memory, page));
+    ++memory->pristineCount;
+}
+
+void markPhysicalMemoryDirty(ArPhysicalMemory memory, uint64_t offset, uint64_t size)
+{
+    if(!size)
+    {
+        return;
+    }
+
+    const uint64_t last = (offset + size - 1u) >> MEMORY_PAGE_SHIFT;
+    for(uint64_t page = offset >> MEMORY_PAGE_SHIFT; page <= last; ++page)
+    {
+        if(!isPageDirty(memory, page))
+        {
+            if(memory->parent->pristine)
+            {
+                keepPristinePage(memory, page);
+            }
+
+            memory->dirtyPages[page / 64u] |= 1ull << (page % 64u);
+        }
+    }
+}
+
+void freePristinePages(ArPhysicalMemory memory)
+{
+    for(uint32_t i = 0; i < memory->pristineCapacity; ++i)
+    {
+        free(memory->pristinePages[i].bytes);
+    }
+
+    free(memory->pristinePages);
+}
+
+//Operations which are not pending are left over from earlier bundles, they are saved as zeros
+static void writeOperation(Writer* restrict writer, const Operation* restrict op, uint32_t pending)
+{
+    static const Operation none;
+
+    writeValue(writer, pending ? op : &none, sizeof(Operation));
+}
+
+static void saveProcessor(Writer* restrict writer, ArVirtualMachine virtualMachine, ArProcessor processor)
+{
+    //Member by member, the hot state holds host pointers and padding
+    writeValue(writer, &processor->pc, sizeof(processor->pc));
+    writeValue(writer, &processor->flags, sizeof(processor->flags));
+    writeValue(writer, &processor->delayedBits, sizeof(processor->delayedBits));
+    writeValue(writer, &processor->dma, sizeof(processor->dma));
+    writeOperation(writer, &processor->dmaOperation, processor->dma);
+    writeValue(writer, &processor->dmaPc, sizeof(processor->dmaPc));
+    writeValue(writer, &processor->cycle, sizeof(processor->cycle));
+    writeValue(writer, &processor->stallUntil, sizeof(processor->stallUntil));
+
+    for(uint32_t i = 0; i < MAX_OPCODE; ++i)
+    {
+        writeOperation(writer, &processor->delayed[i], processor->delayedBits & (1u << i));
+    }
+
+    writeValue(writer, processor->ireg, MEMBERS_SIZE(ireg, accumulator));
+    writeValue(writer, processor->dsram, MEMBERS_SIZE(dsram, iosram));
+    writeValue(writer, &processor->status, sizeof(processor->status));
+
+    //In-flight transfers, oldest first, refer to their physical memory by index
+    writeValue(writer, &processor->dmaCount, sizeof(processor->dmaCount));
+    for(uint32_t i = 0; i < processor->dmaCount; ++i)
+    {
+        const DmaTransfer* const transfer = &processor->dmaQueue[(processor->dmaHead + i) & (DMA_QUEUE_SIZE - 1u)];
+        const uint32_t memory = findPhysicalMemory(virtualMachine, transfer->memory->address) - 1u;
+
+        writeValue(writer, &transfer->completion, sizeof(transfer->completion));
+        writeValue(writer, &memory, sizeof(memory));
+        writeValue(writer, &transfer->ram, sizeof(transfer->ram));
+        writeValue(writer, &transfer->sram, sizeof(transfer->sram));
+        writeValue(writer, &transfer->size, sizeof(transfer->size));
+        writeValue(writer, &transfer->op, sizeof(transfer->op));
+    }
+
+    writeValue(writer, &processor->dmaLatency, sizeof(processor->dmaLatency));
+    writeValue(writer, &processor->dmaBandwidth, sizeof(processor->dmaBandwidth));
+    writeValue(writer, &processor->dmaBusyUntil, sizeof(processor->dmaBusyUntil));
+    writeValue(writer, &processor->dmaTransfers, sizeof(processor->dmaTransfers));
+    writeValue(writer, &processor->dmaBytes, sizeof(processor->dmaBytes));
+    writeValue(writer, &processor->dmaStallCycles, sizeof(processor->dmaStallCycles));
+
+    const uint32_t cacheModel = processor->cacheTags != NULL;
+    writeValue(writer, &cacheModel, sizeof(cacheModel));
+    writeValue(writer, &processor->cacheLineShift, sizeof(processor->cacheLineShift));
+    if(cacheModel)
+    {
+        writeValue(writer, processor->cacheTags, (CACHE_SIZE >> processor->cacheLineShift) * sizeof(uint64_t));
+    }
+
+    writeValue(writer, &processor->cacheHits, MEMBERS_SIZE(cacheHits, cacheWritebacks));
+
+    writeValue(writer, &processor->stallCapacity, sizeof(processor->stallCapacity));
+    writeValue(writer, &processor->stallCount, sizeof(processor->stallCount));
+    writeValue(writer, processor->stalls, processor->stallCapacity * sizeof(StallEntry));
+
+#ifdef AR_PEDANTIC
+    writeValue(writer, processor->registerReady, MEMBERS_SIZE(registerReady, pipelineStalled));
+#endif
+}
+
+static ArResult loadProcessor(Reader* restrict reader, ArVirtualMachine virtualMachine, ArProcessor processor)
+{
+    if(!loadValue(reader, &processor->pc, sizeof(processor->pc)) ||
+       !loadValue(reader, &processor->flags, sizeof(processor->flags)) ||
+       !loadValue(reader, &processor->delayedBits, sizeof(processor->delayedBits)) ||
+       !loadValue(reader, &processor->dma, sizeof(processor->dma)) ||
+       !loadValue(reader, &processor->dmaOperation, sizeof(processor->dmaOperation)) ||
+       !loadValue(reader, &processor->dmaPc, sizeof(processor->dmaPc)) ||
+       !loadValue(reader, &processor->cycle, sizeof(processor->cycle)) ||
+       !loadValue(reader, &processor->stallUntil, sizeof(processor->stallUntil)) ||
+       !loadValue(reader, processor->delayed, sizeof(processor->delayed)) ||
+       !loadValue(reader, processor->ireg, MEMBERS_SIZE(ireg, accumulator)) ||
+       !loadValue(reader, processor->dsram, MEMBERS_SIZE(dsram, iosram)) ||
+       !loadValue(reader, &processor->status, sizeof(processor->status)))
+    {
+        return AR_ERROR_INVALID_STATE;
+    }
+
+    uint32_t dmaCount;
+    if(!readValue(reader, &dmaCount, sizeof(dmaCount)) || dmaCount > DMA_QUEUE_SIZE)
+    {
+        return AR_ERROR_INVALID_STATE;
+    }
+
+    for(uint32_t i = 0; i < dmaCount; ++i)
+    {
+        DmaTransfer transfer;
+        uint32_t memory;
+
+        if(!readValue(reader, &transfer.completion, sizeof(transfer.completion)) ||
+           !readValue(reader, &memory, sizeof(memory)) ||
+           !readValue(reader, &transfer.ram, sizeof(transfer.ram)) ||
+           !readValue(reader, &transfer.sram, sizeof(transfer.sram)) ||
+           !readValue(reader, &transfer.size, sizeof(transfer.size)) ||
+           !readValue(reader, &transfer.op, sizeof(transfer.op)) ||
+           memory >= virtualMachine->memoryCount ||
+           transfer.ram > virtualMachine->memories[memory]->size ||
+           transfer.size > virtualMachine->memories[memory]->size - transfer.ram)
+        {
+            return AR_ERROR_INVALID_STATE;
+        }
+
+        transfer.memory = virtualMachine->memories[memory];
+        if(reader->apply)
+        {
+            processor->dmaQueue[i] = transfer;
+        }
+    }
+
+    if(!loadValue(reader, &processor->dmaLatency, sizeof(processor->dmaLatency)) ||
+       !loadValue(reader, &processor->dmaBandwidth, sizeof(processor->dmaBandwidth)) ||
+       !loadValue(reader, &processor->dmaBusyUntil, sizeof(processor->dmaBusyUntil)) ||
+       !loadValue(reader, &processor->dmaTransfers, sizeof(processor->dmaTransfers)) ||
+       !loadValue(reader, &processor->dmaBytes, sizeof(processor->dmaBytes)) ||
+       !loadValue(reader, &processor->dmaStallCycles, sizeof(processor->dmaStallCycles)))
+    {
+        return AR_ERROR_INVALID_STATE;
+    }
+
+    //The cache has to be modelled with the same lines
+    uint32_t cacheModel;
+    uint32_t cacheLineShift;
+    if(!readValue(reader, &cacheModel, sizeof(cacheModel)) ||
+       !readValue(reader, &cacheLineShift, sizeof(cacheLineShift)) ||
+       cacheModel != (processor->cacheTags != NULL) ||
+       cacheLineShift != processor->cacheLineShift ||
+       (cacheModel && !loadValue(reader, processor->cacheTags, (CACHE_SIZE >> cacheLineShift) * sizeof(uint64_t))) ||
+       !loadValue(reader, &processor->cacheHits, MEMBERS_SIZE(cacheHits, cacheWritebacks)))
+    {
+        return AR_ERROR_INVALID_STATE;
+    }
+
+    uint32_t stallCapacity;
+    uint32_t stallCount;
+    if(!readValue(reader, &stallCapacity, sizeof(stallCapacity)) ||
+       !readValue(reader, &stallCount, sizeof(stallCount)) ||
+       (stallCapacity & (stallCapacity - 1u)) || stallCount * 2u > stallCapacity ||
+       stallCapacity * (uint64_t)sizeof(StallEntry) > reader->size - reader->offset)
+    {
+        return AR_ERROR_INVALID_STATE;
+    }
+
+    if(reader->apply)
+    {
+        //A failed allocation drops the stalls, as recordStall does
+        StallEntry* const stalls = stallCapacity ? malloc(stallCapacity * sizeof(StallEntry)) : NULL;
+        if(stalls)
+        {
+            memcpy(stalls, reader->data + reader->offset, stallCapacity * sizeof(StallEntry));
+        }
+
+        free(processor->stalls);
+        processor->stalls = stalls;
+        processor->stallCapacity = stalls ? stallCapacity : 0u;
+        processor->stallCount = stalls ? stallCount : 0u;
+    }
+
+    reader->offset += stallCapacity * sizeof(StallEntry);
+
+#ifdef AR_PEDANTIC
+    if(!loadValue(reader, processor->registerReady, MEMBERS_SIZE(registerReady, pipelineStalled)))
+    {
+        return AR_ERROR_INVALID_STATE;
+    }
+#endif
+
+    if(reader->apply)
+    {
+        processor->operations = NULL;
+        processor->dmaCount = dmaCount;
+        processor->dmaHead = 0;
+        processor->dmaMemory = NULL;
+
+        //The ISRAM changed under the decoded bundles and the superblocks
+        decodeInstructionMemory(processor, 0, ISRAM_SIZE / 4u);
+        for(uint32_t i = 0; i < SUPERBLOCK_CACHE_SIZE; ++i)
+        {
+            processor->superblocks[i].bundleCount = 0;
+        }
+
+#ifdef AR_JIT
+        jitFlush(processor);
+#endif
+    }
+
+    return AR_SUCCESS;
+}
+
+static void writePage(Writer* restrict writer, ArPhysicalMemory memory, uint64_t page)
+{
+    const uint64_t size = pageBytes(memory, page);
+
+    if(writer->data)
+    {
+        readPhysicalMemory(memory, page << MEMORY_PAGE_SHIFT, writer->data + writer->size, size);
+    }
+
+    writer->size += size;
+}
+
+static void saveMemory(Writer* restrict writer, ArPhysicalMemory memory)
+{
+    const uint64_t pageCount = (memory->size + MEMORY_PAGE_SIZE - 1u) >> MEMORY_PAGE_SHIFT;
+
+    uint64_t dirtyCount = 0;
+    for(uint64_t i = 0; i < (pageCount + 63u) / 64u; ++i)
+    {
+        for(uint64_t word = memory->dirtyPages[i]; word; word &= word - 1u)
+        {
+            ++dirtyCount;
+        }
+    }
+
+    writeValue(writer, &memory->address, sizeof(memory->address));
+    writeValue(writer, &memory->size, sizeof(uint64_t));
+    writeValue(writer, &dirtyCount, sizeof(dirtyCount));
+
+    //Pages go by increasing index, whole words of clean pages are skipped
+    for(uint64_t page = 0; page < pageCount; ++page)
+    {
+        if(!(page % 64u) && !memory->dirtyPages[page / 64u])
+        {
+            page += 63u;
+            continue;
+        }
+
+        if(isPageDirty(memory, page))
+        {
+            writeValue(writer, &page, sizeof(page));
+            writePage(writer, memory, page);
+        }
+    }
+}
+
+/// \brief Give the dirty pages of [first, last) back their pristine content
+static ArResult revertPages(ArPhysicalMemory memory, uint64_t first, uint64_t last, int apply)
+{
+    for(uint64_t page = first; page < last; ++page)
+    {
+        if(!(page % 64u) && !memory->dirtyPages[page / 64u])
+        {
+            page += 63u;
+            continue;
+        }
+
+        if(!isPageDirty(memory, page))
+        {
+            continue;
+        }
+
+        const PristinePage* const entry = memory->pristineCapacity ? findPristine(memory->pristinePages, memory->pristineCapacity, page) : NULL;
+        if(!entry || !entry->bytes)
+        {
+            return memory->pristineLost ? AR_ERROR_HOST_OUT_OF_MEMORY : AR_ERROR_INVALID_STATE;
+        }
+
+        if(apply)
+        {
+            memcpy(writablePhysicalMemory(memory, page << MEMORY_PAGE_SHIFT, pageBytes(memory, page)), entry->bytes, pageBytes(memory, page));
+            memory->dirtyPages[page / 64u] &= ~(1ull << (page % 64u));
+        }
+    }
+
+    return AR_SUCCESS;
+}
+
+static ArResult loadMemory(Reader* restrict reader, ArPhysicalMemory memory)
+{
+    const uint64_t pageCount = (memory->size + MEMORY_PAGE_SIZE - 1u) >> MEMORY_PAGE_SHIFT;
+
+    uint64_t address;
+    uint64_t size;
+    uint64_t dirtyCount;
+    if(!readValue(reader, &address, sizeof(address)) ||
+       !readValue(reader, &size, sizeof(size)) ||
+       !readValue(reader, &dirtyCount, sizeof(dirtyCount)) ||
+       address != memory->address || size != memory->size || dirtyCount > pageCount)
+    {
+        return AR_ERROR_INVALID_STATE;
+    }
+
+    uint64_t next = 0; //the first page after the previous page of the state
+    for(uint64_t i = 0; i < dirtyCount; ++i)
+    {
+        uint64_t page;
+        if(!readValue(reader, &page, sizeof(page)) || page < next || page >= pageCount)
+        {
+            return AR_ERROR_INVALID_STATE;
+        }
+
+        const ArResult result = revertPages(memory, next, page, reader->apply);
+        if(result != AR_SUCCESS)
+        {
+            return result;
+        }
+
+        const uint64_t bytes = pageBytes(memory, page);
+        if(bytes > reader->size - reader->offset)
+        {
+            return AR_ERROR_INVALID_STATE;
+        }
+
+        if(reader->apply)
+        {
+            markPhysicalMemoryDirty(memory, page << MEMORY_PAGE_SHIFT, bytes);
+            memcpy(writablePhysicalMemory(memory, page << MEMORY_PAGE_SHIFT, bytes), reader->data + reader->offset, bytes);
+        }
+
+        reader->offset += bytes;
+        next = page + 1u;
+    }
+
+    return revertPages(memory, next, pageCount, reader->apply);
+}
+
+ArResult arSaveState(ArVirtualMachine virtualMachine, uint64_t* pDataSize, void* pData)
+{
+    assert(virtualMachine);
+    assert(pDataSize);
+
+    StateHeader header = {STATE_MAGIC, STATE_VERSION, (uint32_t)sizeof(ArProcessor_T), 0, virtualMachine->memoryCount, 0};
+    for(ArProcessor processor = virtualMachine->processor; processor; processor = processor->next)
+    {
+        ++header.processorCount;
+    }
+
+    //The first pass measures the state
+    Writer writer = {NULL, 0};
+    for(int pass = pData ? 0 : 1; pass < 2; ++pass)
+    {
+        writeValue(&writer, &header, sizeof(header));
+
+        for(ArProcessor processor = virtualMachine->processor; processor; processor = processor->next)
+        {
+            saveProcessor(&writer, virtualMachine, processor);
+        }
+
+        for(uint32_t i = 0; i < virtualMachine->memoryCount; ++i)
+        {
+            saveMemory(&writer, virtualMachine->memories[i]);
+        }
+
+        if(pass == 0)
+        {
+            if(*pDataSize < writer.size)
+            {
+                *pDataSize = writer.size;
+                return AR_ERROR_BUFFER_TOO_SMALL;
+            }
+
+            writer.data = pData;
+            writer.size = 0;
+        }
+    }
+
+    *pDataSize = writer.size;
+
+    //From now on, the first write to a page keeps its content for the states which do not hold it
+    if(pData)
+    {
+        virtualMachine->pristine = 1;
+    }
+
+    return AR_SUCCESS;
+}
+
+ArResult arLoadState(ArVirtualMachine virtualMachine, const void* pData, uint64_t dataSize)
+{
+    assert(virtualMachine);
+    assert(pData);
+
+    //The first pass validates the whole state, so that nothing is loaded when it fails
+    for(int apply = 0; apply < 2; ++apply)
+    {
+        Reader reader = {pData, dataSize, 0, apply};
+
+        StateHeader header;
+        if(!readValue(&reader, &header, sizeof(header)) ||
+           header.magic != STATE_MAGIC ||
+           header.version != STATE_VERSION ||
+           header.processorSize != sizeof(ArProcessor_T) ||
+           header.memoryCount != virtualMachine->memoryCount)
+        {
+            return AR_ERROR_INVALID_STATE;
+        }
+
+        uint32_t processorCount = 0;
+        for(ArProcessor processor = virtualMachine->processor; processor; processor = processor->next)
+        {
+            ++processorCount;
+        }
+
+        if(header.processorCount != processorCount)
+        {
+            return AR_ERROR_INVALID_STATE;
+        }
+
+        //Pages first written from now on keep their content, including those the state overwrites
+        virtualMachine->pristine |= apply;
+
+        for(ArProcessor processor = virtualMachine->processor; processor; processor = processor->next)
+        {
+            const ArResult result = loadProcessor(&reader, virtualMachine, processor);
+            if(result != AR_SUCCESS)
+            {
+                return result;
+            }
+        }
+
+        for(uint32_t i = 0; i < virtualMachine->memoryCount; ++i)
+        {
+            const ArResult result = loadMemory(&reader, virtualMachine->memories[i]);
+            if(result != AR_SUCCESS)
+            {
+                return result;
+            }
+        }
+
+        if(reader.offset != dataSize)
+        {
+            return AR_ERROR_INVALID_STATE;
+        }
+    }
+
+    return AR_SUCCESS;
+}
@@ -1,9 +1,33 @@
 #include "vm.h"
 
+#ifdef AR_JIT
+    #include "jit.h"
+#endif
+
+#ifdef AR_PEDANTIC
+    #include "pipeline.h"
+#endif
+
 #include <stdlib.h>
 #include <assert.h>
 #include <string.h>
 
+#if defined(__unix__) || defined(__APPLE__)
+    #define AR_MAPPINGS //ArPhysicalMemoryMappingCreateInfo backs physical memory with mmap
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+
+    #ifndef MAP_NORESERVE
+        #define MAP_NORESERVE 0
+    #endif
+#endif
+
+#ifndef AR_MAPPINGS
+    #include <stdio.h>
+#endif
+
 ArResult arCreateVirtualMachine(ArVirtualMachine* pVirtualMachine, const ArVirtualMachineCreateInfo* pInfo)
 {
     assert(pVirtualMachine);
@@ -17,6 +41,21 @@ ArResult arCreateVirtualMachine(ArVirtualMachine* pVirtualMachine, const ArVirtu
     }
 
     memset(output, 0, sizeof(ArVirtualMachine_T));
+    output->decodeThreads = 1;
+
+#ifdef AR_THREADS
+    if(pthread_mutex_init(&output->memoryLock, NULL) != 0)
+    {
+        free(output);
+        return AR_ERROR_HOST_OUT_OF_MEMORY;
+    }
+
+    const long hostProcessors = sysconf(_SC_NPROCESSORS_ONLN);
+    if(hostProcessors > 1)
+    {
+        output->decodeThreads = hostProcessors < MAX_DECODE_THREADS ? (uint32_t)hostProcessors : MAX_DECODE_THREADS;
+    }
+#endif
 
     *pVirtualMachine = output;
     (void)pInfo;
@@ -24,6 +63,45 @@ ArResult arCreateVirtualMachine(ArVirtualMachine* pVirtualMachine, const ArVirtu
     return AR_SUCCESS;
 }
 
+//Every info structure starts with sType and pNext
+typedef struct BaseInfo
+{
+    ArStructureType sType;
+    const struct BaseInfo* pNext;
+} BaseInfo;
+
+static const void* findInfo(const void* pNext, ArStructureType sType)
+{
+    for(const BaseInfo* pInfo = pNext; pInfo; pInfo = pInfo->pNext)
+    {
+        if(pInfo->sType == sType)
+        {
+            return pInfo;
+        }
+    }
+
+    return NULL;
+}
+
+//The hot state of a processor starts on a cache line
+static ArProcessor allocateProcessor(void)
+{
+#ifdef _WIN32
+    return _aligned_malloc(sizeof(ArProcessor_T), _Alignof(ArProcessor_T));
+#else
+    return aligned_alloc(_Alignof(ArProcessor_T), sizeof(ArProcessor_T));
+#endif
+}
+
+static void freeProcessor(ArProcessor processor)
+{
+#ifdef _WIN32
+    _aligned_free(processor);
+#else
+    free(processor);
+#endif
+}
+
 static void insertProcessor(ArVirtualMachine virtualMachine, ArProcessor processor)
 {
     ArProcessor previous = virtualMachine->processor;
@@ -51,7 +129,7 @@ ArResult arCreateProcessor(ArVirtualMachine virtualMachine, const ArProcessorCre
     assert(pInfo->bootCodeSize % 2 == 0); //if not true then input is obviously truncated
     assert(pProcessor);
 
-    const ArProcessor output = malloc(sizeof(ArProcessor_T));
+    const ArProcessor output = allocateProcessor();
     if(!output)
     {
         return AR_ERROR_HOST_OUT_OF_MEMORY;
@@ -61,6 +139,74 @@ ArResult arCreateProcessor(ArVirtualMachine virtualMachine, const ArProcessorCre
 
     output->parent = virtualMachine;
     memcpy(output->isram, pInfo->pBootCode, pInfo->bootCodeSize * sizeof(uint32_t));
+    decodeInstructionMemory(output, 0, ISRAM_SIZE / 4u);
+
+#ifdef AR_PEDANTIC
+    output->dmaLatency = LATENCY_DMA;
+#endif
+
+    const ArProcessorDmaCreateInfo* const pDmaInfo = findInfo(pInfo->pNext, AR_STRUCTURE_TYPE_PROCESSOR_DMA_CREATE_INFO);
+    if(pDmaInfo)
+    {
+        output->dmaLatency = pDmaInfo->latency;
+        output->dmaBandwidth = pDmaInfo->bandwidth;
+    }
+
+    const ArProcessorCacheCreateInfo* const pCacheInfo = findInfo(pInfo->pNext, AR_STRUCTURE_TYPE_PROCESSOR_CACHE_CREATE_INFO);
+    if(pCacheInfo)
+    {
+        const uint32_t lineSize = pCacheInfo->lineSize;
+        assert(lineSize >= MIN_CACHE_LINE_SIZE && lineSize <= CACHE_SIZE && !(lineSize & (lineSize - 1u)));
+
+        while((1u << output->cacheLineShift) < lineSize)
+        {
+            ++output->cacheLineShift;
+        }
+
+        output->cacheTags = calloc(CACHE_SIZE / lineSize, sizeof(uint64_t));
+        if(!output->cacheTags)
+        {
+            freeProcessor(output);
+            return AR_ERROR_HOST_OUT_OF_MEMORY;
+        }
+    }
+
+    const ArProcessorTraceCreateInfo* const pTraceInfo = findInfo(pInfo->pNext, AR_STRUCTURE_TYPE_PROCESSOR_TRACE_CREATE_INFO);
+    if(pTraceInfo)
+    {
+        const uint32_t entryCount = pTraceInfo->entryCount;
+        assert(entryCount > 0 && !(entryCount & (entryCount - 1u)));
+
+        //The record being written can not be read, the ring keeps entryCount bundles besides it
+        uint32_t words = 1;
+        while(words < entryCount * TRACE_BUNDLE_WORDS + TRACE_RECORD_WORDS)
+        {
+            words *= 2u;
+        }
+
+        output->trace = calloc(words + TRACE_RECORD_WORDS, sizeof(uint64_t));
+        output->traceMask = words - 1u;
+        output->traceEntryCount = entryCount;
+
+        if(!output->trace)
+        {
+            free(output->cacheTags);
+            freeProcessor(output);
+            return AR_ERROR_HOST_OUT_OF_MEMORY;
+        }
+    }
+
+    if(findInfo(pInfo->pNext, AR_STRUCTURE_TYPE_PROCESSOR_PROFILE_CREATE_INFO))
+    {
+        output->profile = calloc(PROFILE_SIZE, sizeof(ProfileCounters));
+        if(!output->profile)
+        {
+            free(output->trace);
+            free(output->cacheTags);
+            freeProcessor(output);
+            return AR_ERROR_HOST_OUT_OF_MEMORY;
+        }
+    }
 
     insertProcessor(virtualMachine, output);
     *pProcessor = output;
@@ -68,21 +214,279 @@ ArResult arCreateProcessor(ArVirtualMachine virtualMachine, const ArProcessorCre
     return AR_SUCCESS;
 }
 
+uint32_t findPhysicalMemory(ArVirtualMachine virtualMachine, uint64_t address)
+{
+    const ArPhysicalMemory* const memories = virtualMachine->memories;
+
+    uint32_t first = 0;
+    uint32_t count = virtualMachine->memoryCount;
+
+    while(count > 0)
+    {
+        const uint32_t half = count / 2u;
+
+        if(memories[first + half]->address <= address)
+        {
+            first += half + 1u;
+            count -= half + 1u;
+        }
+        else
+        {
+            count = half;
+        }
+    }
+
+    return first;
+}
+
+#ifdef AR_MAPPINGS
+//Maps size bytes, a private mapping is anonymous memory with the beginning of the file mapped over it
+static uint8_t* mapPhysicalMemory(const ArPhysicalMemoryMappingCreateInfo* restrict pMappingInfo, size_t size)
+{
+    if(!pMappingInfo->pPath)
+    {
+        void* const memory = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        return memory == MAP_FAILED ? NULL : memory;
+    }
+
+    const int file = open(pMappingInfo->pPath, pMappingInfo->shared ? O_RDWR : O_RDONLY);
+    if(file < 0)
+    {
+        return NULL;
+    }
+
+    struct stat status;
+    if(fstat(file, &status) != 0)
+    {
+        close(file);
+        return NULL;
+    }
+
+    const uint64_t fileSize = (uint64_t)status.st_size;
+    const uint64_t end = pMappingInfo->offset + size;
+
+    void* memory = MAP_FAILED;
+    if(pMappingInfo->shared)
+    {
+        //The file grows sparse, its new pages take no disk space until written
+        if(fileSize >= end || ftruncate(file, (off_t)end) == 0)
+        {
+            memory = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, file, (off_t)pMappingInfo->offset);
+        }
+    }
+    else
+    {
+        memory = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+
+        if(memory != MAP_FAILED && fileSize > pMappingInfo->offset)
+        {
+            const uint64_t available = fileSize - pMappingInfo->offset;
+            const size_t mapped = available < size ? (size_t)available : size;
+
+            if(mmap(memory, mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, file, (off_t)pMappingInfo->offset) == MAP_FAILED)
+            {
+                munmap(memory, size);
+                memory = MAP_FAILED;
+            }
+        }
+    }
+
+    close(file); //the mapping keeps the file alive
+
+    return memory == MAP_FAILED ? NULL : memory;
+}
+#endif
+
+#ifdef AR_MAPPINGS
+//Maps the whole pages of the file over a private mapping, then reads the bytes left
+static int preloadPhysicalMemory(ArPhysicalMemory memory, const ArPhysicalMemoryFileCreateInfo* restrict pFileInfo, int privateMapping)
+{
+    const int file = open(pFileInfo->pPath, O_RDONLY);
+    if(file < 0)
+    {
+        return 0;
+    }
+
+    struct stat status;
+    if(fstat(file, &status) != 0)
+    {
+        close(file);
+        return 0;
+    }
+
+    const uint64_t fileSize = (uint64_t)status.st_size;
+    const uint64_t available = fileSize > pFileInfo->fileOffset ? fileSize - pFileInfo->fileOffset : 0u;
+    const uint64_t size = available < pFileInfo->size ? available : pFileInfo->size;
+
+    uint8_t* const output = memory->memory + pFileInfo->offset;
+    uint64_t done = 0;
+
+    //A partial last page would hide the bytes of the memory past the range
+    const uint64_t pageSize = (uint64_t)sysconf(_SC_PAGESIZE);
+    if(privateMapping && (uintptr_t)output % pageSize == 0 && pFileInfo->fileOffset % pageSize == 0)
+    {
+        const uint64_t mapped = size / pageSize * pageSize;
+        if(mapped && mmap(output, (size_t)mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, file, (off_t)pFileInfo->fileOffset) == MAP_FAILED)
+        {
+            close(file);
+            return 0;
+        }
+
+        done = mapped;
+    }
+
+    while(done < size)
+    {
+        const ssize_t count = pread(file, output + done, (size_t)(size - done), (off_t)(pFileInfo->fileOffset + done));
+        if(count <= 0)
+        {
+            close(file);
+            return 0;
+        }
+
+        done += (uint64_t)count;
+    }
+
+    close(file);
+
+    return 1;
+}
+#else
+static int preloadPhysicalMemory(ArPhysicalMemory memory, const ArPhysicalMemoryFileCreateInfo* restrict pFileInfo, int privateMapping)
+{
+    (void)privateMapping;
+
+    FILE* const file = fopen(pFileInfo->pPath, "rb");
+    if(!file)
+    {
+        return 0;
+    }
+
+#ifdef _WIN32
+    int result = _fseeki64(file, (__int64)pFileInfo->fileOffset, SEEK_SET) == 0;
+#else
+    int result = fseek(file, (long)pFileInfo->fileOffset, SEEK_SET) == 0;
+#endif
+
+    //fread stops at the end of the file, the bytes past it are left untouched
+    if(result)
+    {
+        fread(memory->memory + pFileInfo->offset, 1, (size_t)pFileInfo->size, file);
+        result = !ferror(file);
+    }
+
+    fclose(file);
+
+    return result;
+}
+#endif
+
+static void freePhysicalMemory(ArPhysicalMemory memory);
+
+//The private memory of a fork, its pages are only committed when they are copied
+static uint8_t* allocatePrivateMemory(size_t size)
+{
+#ifdef AR_MAPPINGS
+    void* const memory = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    return memory == MAP_FAILED ? NULL : memory;
+#else
+    return malloc(size);
+#endif
+}
+
+static int isPageCopied(ArPhysicalMemory memory, uint64_t page)
+{
+    return (memory->copiedPages[page / 64u] >> (page % 64u)) & 1u;
+}
+
+void readPhysicalMemory(ArPhysicalMemory memory, uint64_t offset, void* output, uint64_t size)
+{
+    if(!memory->source)
+    {
+        memcpy(output, memory->memory + offset, size);
+        return;
+    }
+
+    //Page by page, each one from where its latest content is
+    uint8_t* bytes = output;
+    while(size > 0)
+    {
+        const uint64_t page = offset >> MEMORY_PAGE_SHIFT;
+        const uint64_t pageEnd = (page + 1u) << MEMORY_PAGE_SHIFT;
+        const uint64_t chunk = pageEnd - offset < size ? pageEnd - offset : size;
+
+        memcpy(bytes, (isPageCopied(memory, page) ? memory->memory : memory->source) + offset, chunk);
+
+        bytes += chunk;
+        offset += chunk;
+        size -= chunk;
+    }
+}
+
+uint8_t* writablePhysicalMemory(ArPhysicalMemory memory, uint64_t offset, uint64_t size)
+{
+    if(memory->source && size > 0)
+    {
+        const uint64_t last = (offset + size - 1u) >> MEMORY_PAGE_SHIFT;
+        for(uint64_t page = offset >> MEMORY_PAGE_SHIFT; page <= last; ++page)
+        {
+            if(!isPageCopied(memory, page))
+            {
+                const uint64_t pageOffset = page << MEMORY_PAGE_SHIFT;
+                const uint64_t pageSize = memory->size - pageOffset < MEMORY_PAGE_SIZE ? memory->size - pageOffset : MEMORY_PAGE_SIZE;
+
+                memcpy(memory->memory + pageOffset, memory->source + pageOffset, pageSize);
+                memory->copiedPages[page / 64u] |= 1ull << (page % 64u);
+            }
+        }
+    }
+
+    return memory->memory + offset;
+}
+
 ArResult arCreatePhysicalMemory(ArVirtualMachine virtualMachine, const ArPhysicalMemoryCreateInfo* pInfo, ArPhysicalMemory* pMemory)
 {
     assert(virtualMachine);
     assert(pInfo);
     assert(pInfo->sType == AR_STRUCTURE_TYPE_PHYSICAL_MEMORY_CREATE_INFO);
     assert(pInfo->size > 0);
-    assert(pInfo->pMemory);
     assert(pMemory);
 
-    if(virtualMachine->memory)
+    const ArPhysicalMemoryMappingCreateInfo* const pMappingInfo = findInfo(pInfo->pNext, AR_STRUCTURE_TYPE_PHYSICAL_MEMORY_MAPPING_CREATE_INFO);
+    assert(pInfo->pMemory || pMappingInfo);
+
+    //The memory goes before the first one at a higher address, and must end before it
+    const uint32_t index = findPhysicalMemory(virtualMachine, pInfo->address);
+    const uint64_t end = pInfo->address + pInfo->size;
+
+    if(end < pInfo->address) //wraps around the address space
+    {
+        return AR_ERROR_PHYSICAL_MEMORY_OUT_OF_RANGE;
+    }
+
+    if(index > 0)
+    {
+        const ArPhysicalMemory previous = virtualMachine->memories[index - 1u];
+        if(pInfo->address - previous->address < previous->size)
+        {
+            return AR_ERROR_PHYSICAL_MEMORY_OVERLAP;
+        }
+    }
+
+    if(index < virtualMachine->memoryCount && virtualMachine->memories[index]->address < end)
+    {
+        return AR_ERROR_PHYSICAL_MEMORY_OVERLAP;
+    }
+
+    ArPhysicalMemory* const memories = realloc(virtualMachine->memories, (virtualMachine->memoryCount + 1u) * sizeof(ArPhysicalMemory));
+    if(!memories)
     {
-        return AR_ERROR_TOO_MANY_OBJECTS;
+        return AR_ERROR_HOST_OUT_OF_MEMORY;
     }
 
-    const ArPhysicalMemory output = malloc(sizeof(ArPhysicalMemory_T));
+    virtualMachine->memories = memories;
+
+    const ArPhysicalMemory output = calloc(1, sizeof(ArPhysicalMemory_T));
     if(!output)
     {
         return AR_ERROR_HOST_OUT_OF_MEMORY;
@@ -91,18 +495,361 @@ ArResult arCreatePhysicalMemory(ArVirtualMachine virtualMachine, const ArPhysica
     output->parent = virtualMachine;
     output->memory = pInfo->pMemory;
     output->size = pInfo->size;
+    output->address = pInfo->address;
+
+    //One bit per page, the host only commits the words of the pages written
+    const uint64_t pageCount = (pInfo->size + MEMORY_PAGE_SIZE - 1u) >> MEMORY_PAGE_SHIFT;
+    output->dirtyPages = calloc((size_t)((pageCount + 63u) / 64u), sizeof(uint64_t));
+    if(!output->dirtyPages)
+    {
+        free(output);
+        return AR_ERROR_HOST_OUT_OF_MEMORY;
+    }
+
+    if(pMappingInfo)
+    {
+#ifdef AR_MAPPINGS
+        output->memory = mapPhysicalMemory(pMappingInfo, output->size);
+        output->mapped = 1;
+#else
+        output->memory = NULL;
+#endif
+
+        if(!output->memory)
+        {
+            free(output->dirtyPages);
+            free(output);
+            return AR_ERROR_HOST_MAPPING_FAILED;
+        }
+    }
+
+    //In chain order, a file overwrites the ranges preloaded before it
+    const int privateMapping = pMappingInfo && !pMappingInfo->shared;
+    for(const ArPhysicalMemoryFileCreateInfo* pFileInfo = findInfo(pInfo->pNext, AR_STRUCTURE_TYPE_PHYSICAL_MEMORY_FILE_CREATE_INFO); pFileInfo;
+        pFileInfo = findInfo(pFileInfo->pNext, AR_STRUCTURE_TYPE_PHYSICAL_MEMORY_FILE_CREATE_INFO))
+    {
+        assert(pFileInfo->pPath);
+        assert(pFileInfo->offset <= output->size && pFileInfo->size <= output->size - pFileInfo->offset);
+
+        if(!preloadPhysicalMemory(output, pFileInfo, privateMapping))
+        {
+            freePhysicalMemory(output);
+            return AR_ERROR_HOST_MAPPING_FAILED;
+        }
+    }
+
+    memmove(&memories[index + 1u], &memories[index], (virtualMachine->memoryCount - index) * sizeof(ArPhysicalMemory));
+    memories[index] = output;
+    ++virtualMachine->memoryCount;
 
     *pMemory = output;
 
     return AR_SUCCESS;
 }
 
+#ifdef AR_THREADS
+/// \brief The state shared by the host threads of a parallel run, protected by lock
+typedef struct Scheduler
+{
+    pthread_mutex_t lock;
+    pthread_cond_t turnEnded;
+    uint64_t generation; //< incremented at the end of every turn
+    uint32_t running; //< the number of threads taking part in the turns
+    uint32_t arrived; //< the number of threads done with the current turn
+    uint64_t turn; //< the number of bundles of the current turn
+    uint64_t cycles; //< the number of bundles of the previous turns
+    uint64_t maxCycles;
+    uint64_t quantum;
+    int stop;
+    ArResult result; //< the error reported to the caller, AR_SUCCESS if none
+    uint32_t faultingIndex;
+    ArProcessor faultingProcessor;
+} Scheduler;
+
+typedef struct Worker
+{
+    pthread_t thread;
+    Scheduler* scheduler;
+    ArProcessor processor;
+    uint32_t index; //< the creation order of the processor
+} Worker;
+
+//Called with the lock held, by the last thread to end the turn
+static void endSchedulerTurn(Scheduler* scheduler)
+{
+    scheduler->arrived = 0;
+    scheduler->cycles += scheduler->turn;
+
+    const uint64_t remaining = scheduler->maxCycles - scheduler->cycles;
+    scheduler->turn = remaining < scheduler->quantum ? remaining : scheduler->quantum;
+
+    if(scheduler->turn == 0 || scheduler->running == 0)
+    {
+        scheduler->stop = 1;
+    }
+
+    ++scheduler->generation;
+    pthread_cond_broadcast(&scheduler->turnEnded);
+}
+
+//Removes a thread from the turns, it will not wait for the others anymore
+static void leaveScheduler(Scheduler* scheduler)
+{
+    pthread_mutex_lock(&scheduler->lock);
+
+    --scheduler->running;
+    if(scheduler->arrived == scheduler->running)
+    {
+        endSchedulerTurn(scheduler);
+    }
+
+    pthread_mutex_unlock(&scheduler->lock);
+}
+
+static void* runWorker(void* pWorker)
+{
+    Worker* const worker = pWorker;
+    Scheduler* const scheduler = worker->scheduler;
+
+    pthread_mutex_lock(&scheduler->lock);
+    uint64_t turn = scheduler->turn;
+    pthread_mutex_unlock(&scheduler->lock);
+
+    for(;;)
+    {
+        const ArResult result = arRunProcessor(worker->processor, turn, NULL);
+
+        if(result != AR_SUCCESS)
+        {
+            worker->processor->status = result;
+
+            if(result != AR_END_OF_CODE)
+            {
+                pthread_mutex_lock(&scheduler->lock);
+                if(scheduler->result == AR_SUCCESS || worker->index < scheduler->faultingIndex)
+                {
+                    scheduler->result = result;
+                    scheduler->faultingIndex = worker->index;
+                    scheduler->faultingProcessor = worker->processor;
+                }
+                scheduler->stop = 1;
+                pthread_mutex_unlock(&scheduler->lock);
+            }
+
+            leaveScheduler(scheduler);
+            return NULL;
+        }
+
+        //Quantum barrier
+        pthread_mutex_lock(&scheduler->lock);
+
+        if(++scheduler->arrived == scheduler->running)
+        {
+            endSchedulerTurn(scheduler);
+        }
+        else
+        {
+            const uint64_t generation = scheduler->generation;
+            while(generation == scheduler->generation)
+            {
+                pthread_cond_wait(&scheduler->turnEnded, &scheduler->lock);
+            }
+        }
+
+        const int stop = scheduler->stop;
+        turn = scheduler->turn;
+
+        pthread_mutex_unlock(&scheduler->lock);
+
+        if(stop)
+        {
+            return NULL;
+        }
+    }
+}
+
+static ArResult runParallel(ArVirtualMachine virtualMachine, const ArVirtualMachineRunInfo* pInfo, ArProcessor* pFaultingProcessor)
+{
+    if(pInfo->maxCycles == 0)
+    {
+        return AR_SUCCESS;
+    }
+
+    uint32_t count = 0;
+    for(ArProcessor processor = virtualMachine->processor; processor; processor = processor->next)
+    {
+        count += processor->status == AR_SUCCESS;
+    }
+
+    if(count == 0)
+    {
+        return AR_END_OF_CODE;
+    }
+
+    Worker* const workers = malloc(count * sizeof(Worker));
+    if(!workers)
+    {
+        return AR_ERROR_HOST_OUT_OF_MEMORY;
+    }
+
+    Scheduler scheduler;
+    memset(&scheduler, 0, sizeof(Scheduler));
+
+    if(pthread_mutex_init(&scheduler.lock, NULL) != 0)
+    {
+        free(workers);
+        return AR_ERROR_HOST_OUT_OF_MEMORY;
+    }
+
+    if(pthread_cond_init(&scheduler.turnEnded, NULL) != 0)
+    {
+        pthread_mutex_destroy(&scheduler.lock);
+        free(workers);
+        return AR_ERROR_HOST_OUT_OF_MEMORY;
+    }
+
+    scheduler.running = count;
+    scheduler.maxCycles = pInfo->maxCycles;
+    scheduler.quantum = pInfo->quantum;
+    scheduler.turn = pInfo->maxCycles < pInfo->quantum ? pInfo->maxCycles : pInfo->quantum;
+
+    virtualMachine->parallel = 1;
+
+    uint32_t started = 0;
+    uint32_t index = 0;
+    for(ArProcessor processor = virtualMachine->processor; processor; processor = processor->next, ++index)
+    {
+        if(processor->status != AR_SUCCESS)
+        {
+            continue;
+        }
+
+        Worker* const worker = &workers[started];
+        worker->scheduler = &scheduler;
+        worker->processor = processor;
+        worker->index = index;
+
+        if(pthread_create(&worker->thread, NULL, runWorker, worker) != 0)
+        {
+            break;
+        }
+
+        ++started;
+    }
+
+    //The processors without a thread leave the turns, stopping the others after their first quantum
+    if(started < count)
+    {
+        pthread_mutex_lock(&scheduler.lock);
+        scheduler.stop = 1;
+        if(scheduler.result == AR_SUCCESS)
+        {
+            scheduler.result = AR_ERROR_HOST_OUT_OF_MEMORY;
+        }
+        pthread_mutex_unlock(&scheduler.lock);
+
+        for(uint32_t i = started; i < count; ++i)
+        {
+            leaveScheduler(&scheduler);
+        }
+    }
+
+    for(uint32_t i = 0; i < started; ++i)
+    {
+        pthread_join(workers[i].thread, NULL);
+    }
+
+    virtualMachine->parallel = 0;
+
+    ArResult result = scheduler.result;
+    if(result != AR_SUCCESS)
+    {
+        if(pFaultingProcessor)
+        {
+            *pFaultingProcessor = scheduler.faultingProcessor;
+        }
+    }
+    else if(scheduler.running == 0)
+    {
+        result = AR_END_OF_CODE;
+    }
+
+    pthread_cond_destroy(&scheduler.turnEnded);
+    pthread_mutex_destroy(&scheduler.lock);
+    free(workers);
+
+    return result;
+}
+#endif
+
+ArResult arRunVirtualMachine(ArVirtualMachine virtualMachine, const ArVirtualMachineRunInfo* pInfo, ArProcessor* pFaultingProcessor)
+{
+    assert(virtualMachine);
+    assert(pInfo);
+    assert(pInfo->sType == AR_STRUCTURE_TYPE_VIRTUAL_MACHINE_RUN_INFO);
+    assert(pInfo->schedulingMode == AR_SCHEDULING_MODE_LOCKSTEP || pInfo->quantum > 0);
+
+#ifdef AR_THREADS
+    if(pInfo->schedulingMode == AR_SCHEDULING_MODE_PARALLEL)
+    {
+        return runParallel(virtualMachine, pInfo, pFaultingProcessor);
+    }
+#endif
+
+    const uint64_t quantum = pInfo->schedulingMode == AR_SCHEDULING_MODE_LOCKSTEP ? 1u : pInfo->quantum;
+
+    uint64_t cycles = 0;
+    int running = 1;
+
+    while(running && cycles < pInfo->maxCycles)
+    {
+        const uint64_t turn = pInfo->maxCycles - cycles < quantum ? pInfo->maxCycles - cycles : quantum;
+        running = 0;
+
+        for(ArProcessor processor = virtualMachine->processor; processor; processor = processor->next)
+        {
+            if(processor->status != AR_SUCCESS)
+            {
+                continue;
+            }
+
+            const ArResult result = arRunProcessor(processor, turn, NULL);
+            if(result == AR_SUCCESS)
+            {
+                running = 1;
+                continue;
+            }
+
+            processor->status = result;
+
+            if(result != AR_END_OF_CODE)
+            {
+                if(pFaultingProcessor)
+                {
+                    *pFaultingProcessor = processor;
+                }
+
+                return result;
+            }
+        }
+
+        cycles += turn;
+    }
+
+    return running ? AR_SUCCESS : AR_END_OF_CODE;
+}
+
 void arDestroyVirtualMachine(ArVirtualMachine virtualMachine)
 {
     assert(virtualMachine);
-    assert(!virtualMachine->memory);
+    assert(!virtualMachine->memoryCount);
     assert(!virtualMachine->processor);
 
+#ifdef AR_THREADS
+    pthread_mutex_destroy(&virtualMachine->memoryLock);
+#endif
+
+    free(virtualMachine->memories);
     free(virtualMachine);
 }
 
@@ -127,29 +874,324 @@ void arDestroyProcessor(ArVirtualMachine virtualMachine, ArProcessor processor)
         previous->next = processor->next;
     }
 
-    free(processor);
+#ifdef AR_JIT
+    jitDestroyProcessor(processor);
+#endif
+
+    free(processor->profile);
+    free(processor->trace);
+    free(processor->stalls);
+    free(processor->cacheTags);
+    freeProcessor(processor);
+}
+
+static void freePhysicalMemory(ArPhysicalMemory memory)
+{
+#ifdef AR_MAPPINGS
+    if(memory->mapped)
+    {
+        munmap(memory->memory, memory->size);
+    }
+#else
+    if(memory->source)
+    {
+        free(memory->memory);
+    }
+#endif
+
+    freePristinePages(memory);
+    free(memory->copiedPages);
+    free(memory->dirtyPages);
+    free(memory);
 }
 
 void arDestroyPhysicalMemory(ArVirtualMachine virtualMachine, ArPhysicalMemory memory)
 {
     assert(virtualMachine);
-    assert(virtualMachine->memory);
     assert(memory);
 
-    if(virtualMachine->memory == memory)
+    const uint32_t index = findPhysicalMemory(virtualMachine, memory->address) - 1u;
+    assert(index < virtualMachine->memoryCount && virtualMachine->memories[index] == memory);
+
+    ArPhysicalMemory* const memories = virtualMachine->memories;
+    memmove(&memories[index], &memories[index + 1u], (virtualMachine->memoryCount - index - 1u) * sizeof(ArPhysicalMemory));
+    --virtualMachine->memoryCount;
+
+    //The transfers in flight with the memory land before it goes away
+    for(ArProcessor processor = virtualMachine->processor; processor; processor = processor->next)
     {
-        virtualMachine->memory = memory->next;
+        retireMemoryTransfers(processor, memory);
+
+        if(processor->dmaMemory == memory)
+        {
+            processor->dmaMemory = NULL;
+        }
     }
-    else
+
+    freePhysicalMemory(memory);
+}
+
+/// \brief Create in fork a memory sharing the content of source, the pages the source copied are copied again
+static ArPhysicalMemory forkPhysicalMemory(ArVirtualMachine fork, ArPhysicalMemory source)
+{
+    const ArPhysicalMemory output = calloc(1, sizeof(ArPhysicalMemory_T));
+    if(!output)
     {
-        ArPhysicalMemory previous = virtualMachine->memory;
-        while(previous->next && previous->next != memory)
+        return NULL;
+    }
+
+    output->parent = fork;
+    output->size = source->size;
+    output->address = source->address;
+    output->source = source->source ? source->source : source->memory;
+    output->pristineLost = source->pristineLost;
+
+    const uint64_t pageCount = (source->size + MEMORY_PAGE_SIZE - 1u) >> MEMORY_PAGE_SHIFT;
+    const size_t wordCount = (size_t)((pageCount + 63u) / 64u);
+
+    output->dirtyPages = malloc(wordCount * sizeof(uint64_t));
+    output->copiedPages = source->copiedPages ? malloc(wordCount * sizeof(uint64_t)) : calloc(wordCount, sizeof(uint64_t));
+    output->memory = allocatePrivateMemory(output->size);
+#ifdef AR_MAPPINGS
+    output->mapped = output->memory != NULL;
+#endif
+
+    output->pristinePages = source->pristineCapacity ? calloc(source->pristineCapacity, sizeof(PristinePage)) : NULL;
+    output->pristineCapacity = output->pristinePages ? source->pristineCapacity : 0u;
+
+    if(!output->dirtyPages || !output->copiedPages || !output->memory || output->pristineCapacity != source->pristineCapacity)
+    {
+        freePhysicalMemory(output);
+        return NULL;
+    }
+
+    memcpy(output->dirtyPages, source->dirtyPages, wordCount * sizeof(uint64_t));
+
+    //Only the pages a fork wrote differ from the shared memory
+    if(source->copiedPages)
+    {
+        memcpy(output->copiedPages, source->copiedPages, wordCount * sizeof(uint64_t));
+
+        for(uint64_t page = 0; page < pageCount; ++page)
         {
-            previous = previous->next;
+            if(isPageCopied(source, page))
+            {
+                const uint64_t offset = page << MEMORY_PAGE_SHIFT;
+                const uint64_t size = source->size - offset < MEMORY_PAGE_SIZE ? source->size - offset : MEMORY_PAGE_SIZE;
+
+                memcpy(output->memory + offset, source->memory + offset, size);
+            }
+        }
+    }
+
+    for(uint32_t i = 0; i < source->pristineCapacity; ++i)
+    {
+        const PristinePage* const entry = &source->pristinePages[i];
+        if(!entry->bytes)
+        {
+            continue;
         }
 
-        previous->next = memory->next;
+        output->pristinePages[i].bytes = malloc(MEMORY_PAGE_SIZE);
+        if(!output->pristinePages[i].bytes)
+        {
+            freePhysicalMemory(output);
+            return NULL;
+        }
+
+        output->pristinePages[i].page = entry->page;
+        memcpy(output->pristinePages[i].bytes, entry->bytes, MEMORY_PAGE_SIZE);
     }
 
-    free(memory);
+    output->pristineCount = source->pristineCount;
+
+    return output;
+}
+
+/// \brief Create in fork a copy of source, its in-flight transfers go to the memories of fork
+static ArProcessor forkProcessor(ArVirtualMachine fork, ArProcessor source)
+{
+    const ArProcessor output = allocateProcessor();
+    if(!output)
+    {
+        return NULL;
+    }
+
+    memcpy(output, source, sizeof(ArProcessor_T));
+
+    output->next = NULL;
+    output->parent = fork;
+    output->dmaMemory = NULL;
+    output->cacheTags = NULL;
+    output->stalls = NULL;
+    output->trace = NULL;
+    output->profile = NULL;
+
+    //The current bundle is in the decoded bundles
+    if(source->operations)
+    {
+        output->operations = (const Operation*)((const uint8_t*)output + ((const uint8_t*)source->operations - (const uint8_t*)source));
+    }
+
+    for(uint32_t i = 0; i < source->dmaCount; ++i)
+    {
+        DmaTransfer* const transfer = &output->dmaQueue[(source->dmaHead + i) & (DMA_QUEUE_SIZE - 1u)];
+        const uint32_t index = findPhysicalMemory(source->parent, transfer->memory->address) - 1u;
+
+        transfer->memory = fork->memories[index];
+    }
+
+#ifdef AR_JIT
+    //The compiled code belongs to the source, the superblocks compile again
+    output->jitCode = NULL;
+    jitFlush(output);
+#endif
+
+    const size_t tagsSize = (CACHE_SIZE >> source->cacheLineShift) * sizeof(uint64_t);
+    const size_t stallsSize = source->stallCapacity * sizeof(StallEntry);
+    const size_t traceSize = (source->traceMask + 1u + TRACE_RECORD_WORDS) * sizeof(uint64_t);
+    const size_t profileSize = PROFILE_SIZE * sizeof(ProfileCounters);
+
+    output->cacheTags = source->cacheTags ? malloc(tagsSize) : NULL;
+    output->stalls = source->stalls ? malloc(stallsSize) : NULL;
+    output->trace = source->trace ? malloc(traceSize) : NULL;
+    output->profile = source->profile ? malloc(profileSize) : NULL;
+
+    if((source->cacheTags && !output->cacheTags) || (source->stalls && !output->stalls) || (source->trace && !output->trace) ||
+       (source->profile && !output->profile))
+    {
+        free(output->profile);
+        free(output->trace);
+        free(output->stalls);
+        free(output->cacheTags);
+        freeProcessor(output);
+        return NULL;
+    }
+
+    if(source->cacheTags)
+    {
+        memcpy(output->cacheTags, source->cacheTags, tagsSize);
+    }
+
+    if(source->stalls)
+    {
+        memcpy(output->stalls, source->stalls, stallsSize);
+    }
+
+    if(source->trace)
+    {
+        memcpy(output->trace, source->trace, traceSize);
+    }
+
+    if(source->profile)
+    {
+        memcpy(output->profile, source->profile, profileSize);
+    }
+
+    return output;
+}
+
+static void destroyFork(ArVirtualMachine fork)
+{
+    while(fork->processor)
+    {
+        arDestroyProcessor(fork, fork->processor);
+    }
+
+    while(fork->memoryCount)
+    {
+        arDestroyPhysicalMemory(fork, fork->memories[fork->memoryCount - 1u]);
+    }
+
+    arDestroyVirtualMachine(fork);
+}
+
+ArResult arForkVirtualMachine(ArVirtualMachine virtualMachine, ArVirtualMachine* pFork, ArProcessor* pProcessors, ArPhysicalMemory* pMemories)
+{
+    assert(virtualMachine);
+    assert(pFork);
+
+    const ArVirtualMachineCreateInfo info = {AR_STRUCTURE_TYPE_VIRTUAl_MACHINE_CREATE_INFO, NULL};
+
+    ArVirtualMachine output;
+    const ArResult result = arCreateVirtualMachine(&output, &info);
+    if(result != AR_SUCCESS)
+    {
+        return result;
+    }
+
+    output->pristine = virtualMachine->pristine;
+
+    //Memories first, the in-flight transfers of the processors refer to them
+    if(virtualMachine->memoryCount)
+    {
+        output->memories = malloc(virtualMachine->memoryCount * sizeof(ArPhysicalMemory));
+        if(!output->memories)
+        {
+            arDestroyVirtualMachine(output);
+            return AR_ERROR_HOST_OUT_OF_MEMORY;
+        }
+    }
+
+    for(uint32_t i = 0; i < virtualMachine->memoryCount; ++i)
+    {
+        const ArPhysicalMemory memory = forkPhysicalMemory(output, virtualMachine->memories[i]);
+        if(!memory)
+        {
+            destroyFork(output);
+            return AR_ERROR_HOST_OUT_OF_MEMORY;
+        }
+
+        output->memories[i] = memory;
+        ++output->memoryCount;
+    }
+
+    for(ArProcessor processor = virtualMachine->processor; processor; processor = processor->next)
+    {
+        const ArProcessor copy = forkProcessor(output, processor);
+        if(!copy)
+        {
+            destroyFork(output);
+            return AR_ERROR_HOST_OUT_OF_MEMORY;
+        }
+
+        insertProcessor(output, copy);
+    }
+
+    if(pProcessors)
+    {
+        uint32_t i = 0;
+        for(ArProcessor processor = output->processor; processor; processor = processor->next)
+        {
+            pProcessors[i++] = processor;
+        }
+    }
+
+    if(pMemories)
+    {
+        memcpy(pMemories, output->memories, output->memoryCount * sizeof(ArPhysicalMemory));
+    }
+
+    *pFork = output;
+
+    return AR_SUCCESS;
+}
+
+void arReadPhysicalMemory(ArPhysicalMemory memory, uint64_t offset, uint64_t size, void* pData)
+{
+    assert(memory);
+    assert(offset <= memory->size && size <= memory->size - offset);
+    assert(pData);
+
+    readPhysicalMemory(memory, offset, pData, size);
+}
+
+void arWritePhysicalMemory(ArPhysicalMemory memory, uint64_t offset, uint64_t size, const void* pData)
+{
+    assert(memory);
+    assert(offset <= memory->size && size <= memory->size - offset);
+    assert(pData);
+
+    markPhysicalMemoryDirty(memory, offset, size);
+    memcpy(writablePhysicalMemory(memory, offset, size), pData, size);
 }
@@ -3,131 +3,42 @@
 
 #include <base/vm.h>
 
+#include "isa.h"
+
+#include <stddef.h>
+#include <stdatomic.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+    #define AR_THREADS //AR_SCHEDULING_MODE_PARALLEL runs each processor on its own host thread
+    #include <pthread.h>
+#endif
+
 typedef struct ArVirtualMachine_T
 {
     ArProcessor processor;
-    ArPhysicalMemory memory;
+
+    /// \brief The physical memories sorted by address, which do not overlap
+    ArPhysicalMemory* memories;
+    uint32_t memoryCount;
+
+    int pristine; //< 1 once a state was saved or loaded, the first write to a page then keeps its previous content
+    uint32_t decodeThreads; //< the most host threads decoding an ISRAM, the online host processors up to MAX_DECODE_THREADS
+
+#ifdef AR_THREADS
+    int parallel; //< 1 while processors run concurrently, physical memory accesses then take memoryLock
+    pthread_mutex_t memoryLock; //< serializes DMA transfers with the physical memory
+#endif
 } ArVirtualMachine_T;
 
-typedef enum Opcode
+/// \brief The code executing an operation
+///
+/// Every opcode has its own kernel, except the ALU operations which have one per operation size
+typedef enum Kernel
 {
-    OPCODE_UNKNOWN,
-
-    //AGU
-    OPCODE_LDDMA,
-    OPCODE_STDMA,
-    OPCODE_LDDMAR,
-    OPCODE_STDMAR,
-    OPCODE_DMAIR,
-    OPCODE_WAIT,
-
-    //LSU
-    OPCODE_LDM,
-    OPCODE_STM,
-    OPCODE_LDC,
-    OPCODE_STC,
-    OPCODE_LDMX,
-    OPCODE_STMX,
-    OPCODE_IN,
-    OPCODE_OUT,
-    OPCODE_OUTI,
-    OPCODE_LDMV,
-    OPCODE_STMV,
-    OPCODE_LDCV,
-    OPCODE_STCV,
-    OPCODE_LDMF,
-    OPCODE_STMF,
-    OPCODE_LDCF,
-    OPCODE_STCF,
-    OPCODE_LDMD,
-    OPCODE_STMD,
-    OPCODE_LDCD,
-    OPCODE_STCD,
-
-    //ALU
-    OPCODE_NOP,
-    OPCODE_XCHG,
-    //OPCODE_MOVE,
-    OPCODE_MOVEI,
-    OPCODE_ADD,
-    OPCODE_ADDI,
-    OPCODE_ADDQ,
-    OPCODE_SUB,
-    OPCODE_SUBI,
-    OPCODE_SUBQ,
-    OPCODE_MULS,
-    OPCODE_MULSI,
-    OPCODE_MULSQ,
-    OPCODE_MULU,
-    OPCODE_MULUI,
-    OPCODE_MULUQ,
-    OPCODE_DIVS,
-    OPCODE_DIVSI,
-    OPCODE_DIVSQ,
-    OPCODE_DIVU,
-    OPCODE_DIVUI,
-    OPCODE_DIVUQ,
-    OPCODE_AND,
-    OPCODE_ANDI,
-    OPCODE_ANDQ,
-    OPCODE_OR,
-    OPCODE_ORI,
-    OPCODE_ORQ,
-    OPCODE_XOR,
-    OPCODE_XORI,
-    OPCODE_XORQ,
-    OPCODE_ASL,
-    OPCODE_ASLI,
-    OPCODE_ASLQ,
-    OPCODE_LSL,
-    OPCODE_LSLI,
-    OPCODE_LSLQ,
-    OPCODE_ASR,
-    OPCODE_ASRI,
-    OPCODE_ASRQ,
-    OPCODE_LSR,
-    OPCODE_LSRI,
-    OPCODE_LSRQ,
-
-    //BRU
-    //OPCODE_FBNE,
-    //OPCODE_FBEQ,
-    //OPCODE_FBL,
-    //OPCODE_FBLE,
-    //OPCODE_FBG,
-    //OPCODE_FBGE,
-    OPCODE_BNE,
-    OPCODE_BEQ,
-    OPCODE_BL,
-    OPCODE_BLE,
-    OPCODE_BG,
-    OPCODE_BGE,
-    OPCODE_BLS,
-    OPCODE_BLES,
-    OPCODE_BGS,
-    OPCODE_BGES,
-    OPCODE_CMP,
-    OPCODE_CMPI,
-    OPCODE_FCMP,
-    OPCODE_FCMPI,
-    OPCODE_DCMP,
-    OPCODE_DCMPI,
-    OPCODE_JMP,
-    OPCODE_CALL,
-    OPCODE_JMPR,
-    OPCODE_CALLR,
-    OPCODE_RET,
-} Opcode;
-
-#define MAX_OPERANDS 3
-
-typedef struct Operation
-{
-    Opcode op; //< the op code
-    uint32_t operands[MAX_OPERANDS]; //< either register or immediate values
-    uint32_t size; //< 0 = byte, 1 = word, 2 = doubleword, 3 = quadword
-    uint32_t data; //< additionnal data, op dependent
-} Operation;
+#define OPERATION(name, ...) KERNEL_##name,
+#include "operations.inl"
+#undef OPERATION
+} Kernel;
 
 #define DSRAM_SIZE  (128u * 1024u)
 #define ISRAM_SIZE  (128u * 1024u)
@@ -136,6 +47,20 @@ typedef struct Operation
 #define IREG_COUNT  (64u)
 #define FREG_COUNT  (128u)
 #define MAX_OPCODE  (4u)
+#define DECODED_BUNDLES (ISRAM_SIZE / 8u) //a bundle per even program counter
+#define PARALLEL_DECODE_BUNDLES (4096u) //bundles decoded by each host thread, when the ISRAM is decoded by several
+#define MAX_DECODE_THREADS (4u)
+#define SUPERBLOCK_CACHE_SIZE (128u) //must be a power of two
+#define MAX_SUPERBLOCK_BUNDLES (16u)
+#define JIT_THRESHOLD (16u) //executions of a superblock before it is compiled
+#define JIT_CODE_CAPACITY (1024u * 1024u)
+#define JIT_MAX_EXITS (256u) //exits of compiled code waiting for their target to be compiled
+#define DMA_QUEUE_SIZE (16u) //in-flight transfers, must be a power of two
+#define SCOREBOARD_SIZE (IREG_COUNT + FREG_COUNT + 2u) //integer registers, floats, flags and the VFPU accumulator
+#define MIN_CACHE_LINE_SIZE (16u) //so that the low bits of a line address hold its CACHE_LINE flags
+
+#define CACHE_LINE_VALID (0x01u)
+#define CACHE_LINE_DIRTY (0x02u)
 
 #define XCHG_MASK (0x01u)
 #define Z_MASK (0x02u)
@@ -144,49 +69,246 @@ typedef struct Operation
 #define R_MASK (0x03FFF0u)
 #define CMPT_MASK (0xC0000000u)
 
+typedef struct DecodedBundle
+{
+    _Alignas(64) Operation operations[MAX_OPCODE];
+} DecodedBundle;
+
+_Static_assert(sizeof(DecodedBundle) == 64, "a decoded bundle must fit in a cache line");
+
+typedef struct Vector4f
+{
+    float x;
+    float y;
+    float z;
+    float w;
+} Vector4f;
+
+/// \brief A DMA transfer issued and not completed yet
+typedef struct DmaTransfer
+{
+    uint64_t completion; //< the cycle at which the copy happens
+    ArPhysicalMemory memory; //< the physical memory of the transfer
+    uint64_t ram; //< the offset of the transfer in memory
+    uint32_t sram; //< the DSRAM, or ISRAM for DMAIR, address
+    uint32_t size;
+    uint32_t op; //< the Opcode which issued the transfer
+} DmaTransfer;
+
+/// \brief The stall cycles of a bundle for one cause and register, an entry of the stall table
+typedef struct StallEntry
+{
+    uint32_t pc;
+    uint16_t reg; //< the scoreboard slot, or STALL_NO_REGISTER
+    uint8_t cause; //< the ArStallCause
+    uint8_t used;
+    uint64_t count;
+    uint64_t cycles;
+} StallEntry;
+
+#define STALL_NO_REGISTER (0xFFFFu)
+#define STALL_TABLE_MIN_CAPACITY (256u) //must be a power of two
+
+#define PROFILE_SIZE (ISRAM_SIZE / 4u) //one entry per program counter
+
+/// \brief The counters of the bundle at one program counter, an entry of the profile
+typedef struct ProfileCounters
+{
+    uint64_t executions;
+    uint64_t branchesTaken;
+    uint64_t branchesNotTaken;
+    uint64_t dmaBytes;
+    uint32_t size; //< the issue width of the last execution
+} ProfileCounters;
+
+#define TRACE_BUNDLE_WORDS (MAX_OPCODE + 4u) //the most words a bundle recorded alone takes in the trace, its values, op-codes, cycle and header
+#define TRACE_RECORD_BUNDLES (MAX_SUPERBLOCK_BUNDLES + 1u) //the most bundles of a trace record, a superblock and its delay slot
+#define TRACE_RECORD_WORDS (TRACE_RECORD_BUNDLES * (MAX_OPCODE + 2u) + 2u) //the most words of a record
+
+typedef ArResult (*MicroOpHandler)(ArProcessor restrict processor, const Operation* restrict op, uint32_t index);
+
+typedef struct MicroOp
+{
+    MicroOpHandler execute; //< the operation specialized handler
+    uint32_t index; //< the slot of the operation in its bundle
+    Operation operation;
+} MicroOp;
+
+#ifdef AR_JIT
+/// \brief Host code compiled from a superblock
+///
+/// Runs the superblock, its delay slot and branch, possibly several times while it loops on itself
+/// and the cycle budget allows it, then continues into the compiled superblock it branches to or
+/// leaves with the program counter of the next bundle
+typedef ArResult (*JitFunction)(ArProcessor processor, uint64_t* pCycles, uint64_t maxCycles);
+
+/// \brief A jump of compiled code back to the interpreter, patched to continue into the code of its target once compiled
+typedef struct JitExit
+{
+    uint32_t position; //< the offset in jitCode of the displacement of the jump
+    uint32_t pc; //< the program counter of the target
+    uint32_t size; //< the issue width at the target
+} JitExit;
+#endif
+
+/// \brief A sequence of bundles without control flow, ended by the first bundle with a delayed or DMA operation
+typedef struct Superblock
+{
+    uint32_t pc; //< the program counter of the first bundle
+    uint32_t size; //< the issue width of every bundle
+    uint32_t bundleCount; //< the number of bundles, 0 if the entry is empty
+    uint32_t microOpCount;
+    uint8_t bundleEnds[MAX_SUPERBLOCK_BUNDLES]; //< the index of the micro-op following each bundle
+    MicroOp microOps[MAX_SUPERBLOCK_BUNDLES * MAX_OPCODE];
+    uint8_t traceEnds[MAX_SUPERBLOCK_BUNDLES]; //< the index in traceOffsets following each bundle
+    uint16_t traceOffsets[MAX_SUPERBLOCK_BUNDLES * MAX_OPCODE]; //< the offset in ArProcessor_T of each register the bundles write
+    int traceAtEnd; //< no bundle writes a register an earlier one wrote, their values are recorded after the last one
+
+#ifdef AR_JIT
+    JitFunction code; //< the compiled superblock, NULL while it is interpreted
+    uint32_t codeBundles; //< the number of bundles one pass of code executes
+    uint32_t executions; //< the number of interpreted executions, compilation is attempted once
+#endif
+} Superblock;
+
 typedef struct ArProcessor_T
 {
-    ArProcessor next;
-    ArVirtualMachine parent;
+    /// \brief Hot state, touched by every bundle, starting on a cache line
+    struct
+    {
+        _Alignas(64) uint32_t pc; //program-counter
 
-    uint8_t dsram [DSRAM_SIZE];
-    uint8_t isram [ISRAM_SIZE];
-    uint8_t cache [CACHE_SIZE];
-    uint8_t iosram[IOSRAM_SIZE];
+        /// \brief CPU Flags register
+        ///
+        /// Bit 0: XCHG flag, 1 is 4-way decode, 0 is 2-way
+        /// Bit 1: Z flag, 1 if not equal, 0 if equal
+        /// Bit 2: S flag, 1 if lesser, 0 if greater (signed comparison)
+        /// Bit 3: U flag, 1 if lesser, 0 if greater (unsigned comparison)
+        /// Bit 4-17: R value, the PC address of the last call
+        ///
+        /// Non-hardware
+        /// Bit 30-31: CMPT, store the type of the last signed cmp type, 0 = int, 1 = float, 2 = double, 3 = nope
+        uint32_t flags;
 
-    uint64_t ireg[IREG_COUNT];
-    uint64_t freg[FREG_COUNT / 2u];
+        const Operation* operations; //points to the current bundle in decodedBundles
+        uint32_t delayedBits;
+        uint32_t dma; //1 if dmaOperation is to be treated
+        Operation dmaOperation;
+        uint32_t dmaPc; //< the program counter of the bundle which issued dmaOperation, its stalls are attributed to it
 
-    uint32_t pc; //program-counter
-    uint32_t opcodes[MAX_OPCODE];
+        uint64_t cycle; //< the cycles run before the current arRunProcessor call
+        uint64_t stallUntil; //< the cycle a WAIT or a full DMA queue stalls the processor up to
+        uint32_t dmaCount; //< the number of transfers in dmaQueue
 
-    /// \brief CPU Flags register
-    ///
-    /// Bit 0: XCHG flag, 1 is 4-way decode, 0 is 2-way
-    /// Bit 1: Z flag, 1 if not equal, 0 if equal
-    /// Bit 2: S flag, 1 if lesser, 0 if greater (signed comparison)
-    /// Bit 3: U flag, 1 if lesser, 0 if greater (unsigned comparison)
-    /// Bit 4-17: R value, the PC address of the last call
+        _Alignas(64) Operation delayed[MAX_OPCODE];
+
+        uint64_t ireg[IREG_COUNT];
+        uint64_t freg[FREG_COUNT / 2u];
+        Vector4f accumulator; //< written by FMULVA and FMULADDVA, read by FMULADDVA and FMULADDVAO
+    };
+
+    /// \brief Cold state, the memories only touched by loads, stores and DMA
+    struct
+    {
+        _Alignas(64) uint8_t dsram[DSRAM_SIZE];
+        uint8_t isram [ISRAM_SIZE];
+        uint8_t cache [CACHE_SIZE];
+        uint8_t iosram[IOSRAM_SIZE];
+
+        ArProcessor next;
+        ArVirtualMachine parent;
+        ArResult status; //< AR_SUCCESS while arRunVirtualMachine runs the processor, then the result which halted it
+
+        /// \brief In-flight DMA transfers, completed in issue order
+        DmaTransfer dmaQueue[DMA_QUEUE_SIZE];
+        uint32_t dmaHead; //< the index of the oldest transfer
+        uint32_t dmaLatency;
+        uint32_t dmaBandwidth;
+        uint64_t dmaBusyUntil; //< the cycle the engine is done transferring the issued transfers
+        ArPhysicalMemory dmaMemory; //< the physical memory of the last transfer, looked up first
+        uint64_t dmaTransfers;
+        uint64_t dmaBytes;
+        uint64_t dmaStallCycles;
+
+        /// \brief Direct-mapped model of the cache, one tag per line of cache
+        ///
+        /// A tag is the physical address of the line, ORed with CACHE_LINE_VALID and CACHE_LINE_DIRTY
+        uint64_t* cacheTags; //< NULL when the cache is a scratchpad
+        uint32_t cacheLineShift; //< log2 of the line size
+        uint64_t cacheHits;
+        uint64_t cacheMisses;
+        uint64_t cacheEvictions;
+        uint64_t cacheWritebacks;
+
+        /// \brief Open-addressed table of the stall cycles of each bundle, allocated by the first stall
+        StallEntry* stalls;
+        uint32_t stallCapacity;
+        uint32_t stallCount;
+
+        /// \brief Ring buffer of the records of the last bundles executed, NULL unless the processor traces
+        ///
+        /// The processor publishes traceHead after each record, another host thread may read them while it runs.
+        /// A record is written whole from its first word, past the ring into TRACE_RECORD_WORDS spare words,
+        /// whose ones it used are then copied to the beginning of the ring
+        _Atomic uint64_t* trace;
+        uint32_t traceMask; //< the number of words of the ring minus 1
+        uint32_t traceEntryCount; //< the number of bundles kept, ArProcessorTraceCreateInfo::entryCount
+        _Atomic uint64_t traceHead; //< the number of words written, the next one goes to trace[traceHead & traceMask]
+
+        /// \brief The record of the last superblock, left open for the bundle of its delay slot
+        _Atomic uint64_t* traceOut; //< the word past the values of its bundles
+        uint64_t traceCycle; //< the cycle of its first bundle
+        uint32_t tracePc; //< the program counter of its first bundle
+        uint32_t traceSize; //< the issue width of its bundles
+        uint32_t traceCount; //< the number of its bundles, 0 if no record is open
+
+        /// \brief Counters indexed by program counter, NULL unless the processor profiles
+        ProfileCounters* profile;
+        uint32_t profilePc; //< the program counter of the last bundle run, which issued the pending DMA and delayed operations
+    };
+
+    /// \brief The whole ISRAM decoded, the bundle at each even program counter
     ///
-    /// Non-hardware
-    /// Bit 30-31: CMPT, store the type of the last signed cmp type, 0 = int, 1 = float, 2 = double, 3 = nope
-    uint32_t flags;
+    /// Each bundle is decoded with 4 op-codes, a bundle of 2 is its first two operations. An op-code which can not be
+    /// decoded, or is past the end of the ISRAM, is OPCODE_UNKNOWN. The ISRAM is decoded by arCreateProcessor and
+    /// arLoadState, DMAIR decodes again the bundles it overwrote
+    DecodedBundle decodedBundles[DECODED_BUNDLES];
+    uint8_t decodedSizes[DECODED_BUNDLES]; //< 4 if the 4 operations of a bundle are legal, 2 if only the first two, 0 otherwise
+    uint16_t decodedTraceOffsets[DECODED_BUNDLES][MAX_OPCODE]; //< the offset in ArProcessor_T of the register each operation writes, 0 if none
+
+    /// \brief Superblocks translated by arRunProcessor, direct-mapped on their first program counter
+    Superblock superblocks[SUPERBLOCK_CACHE_SIZE];
 
-    Operation operations[MAX_OPCODE];
-    uint32_t delayedBits;
-    Operation delayed[MAX_OPCODE];
-    uint32_t dma; //1 if dmaOperation is to be treated
-    Operation dmaOperation;
+#ifdef AR_PEDANTIC
+    /// \brief Scoreboard of the IF/ID/RR/EX/MEM/WB pipeline
+    uint64_t registerReady[SCOREBOARD_SIZE]; //< the first cycle a bundle can read each register slot
+    uint8_t registerCause[SCOREBOARD_SIZE]; //< the ArStallCause of a bundle waiting for each register slot
+    uint64_t dividerReady; //< the first cycle the divider accepts an operation
+    uint64_t floatDividerReady; //< the first cycle the FDIV unit accepts an operation
+    uint64_t pipelineHazards;
+    uint64_t pipelineStallCycles;
+    uint32_t pipelineStalled; //< 1 while the next bundle waits in RR
+#endif
+
+#ifdef AR_JIT
+    uint8_t* jitCode; //< JIT_CODE_CAPACITY bytes mapped on first compilation, executable or writable but never both
+    size_t jitCodeSize;
+    JitExit jitExits[JIT_MAX_EXITS];
+    uint32_t jitExitCount;
+#endif
 
 } ArProcessor_T;
 
-typedef struct Vector4f
+#define MEMORY_PAGE_SHIFT (12u)
+#define MEMORY_PAGE_SIZE (1u << MEMORY_PAGE_SHIFT)
+#define PRISTINE_TABLE_MIN_CAPACITY (256u) //must be a power of two
+
+/// \brief The content of a page before processors first wrote it, an entry of the pristine table
+typedef struct PristinePage
 {
-    float x;
-    float y;
-    float z;
-    float w;
-} Vector4f;
+    uint64_t page; //< the index of the page in the memory
+    uint8_t* bytes; //< NULL if the entry is empty
+} PristinePage;
 
 typedef struct ArPhysicalMemory_T
 {
@@ -194,7 +316,52 @@ typedef struct ArPhysicalMemory_T
 
     uint8_t* memory;
     size_t size;
+    uint64_t address; //< the physical address of memory[0]
+    int mapped; //< 1 if memory was mapped by arCreatePhysicalMemory or arForkVirtualMachine, and has to be unmapped
+
+    /// \brief The memory a fork shares with the memory it was forked from, NULL if the memory is not a fork
+    ///
+    /// Never written, a page is read from source until its first write copies it to memory
+    const uint8_t* source;
+    uint64_t* copiedPages; //< bitmap of the pages of memory copied from source
+
+    /// \brief Bitmap of the pages which may differ from their content at the creation of the memory
+    ///
+    /// Set by the writes of processors and arLoadState, the host writes to memory are not tracked
+    uint64_t* dirtyPages;
+
+    /// \brief Open-addressed table of the pages first written after the virtual machine started to use states
+    ///
+    /// arLoadState restores them when the state does not hold them
+    PristinePage* pristinePages;
+    uint32_t pristineCapacity;
+    uint32_t pristineCount;
+    int pristineLost; //< 1 if a pristine page could not be allocated, states can not be loaded anymore
 
 } ArPhysicalMemory_T;
 
+/// \brief Get the index in memories of the first physical memory at an address higher than address
+uint32_t findPhysicalMemory(ArVirtualMachine virtualMachine, uint64_t address);
+
+/// \brief Copy size bytes at offset in memory to output, from the source of a fork for the pages it did not write
+void readPhysicalMemory(ArPhysicalMemory memory, uint64_t offset, void* output, uint64_t size);
+
+/// \brief Get the size bytes at offset in memory for writing, a fork first copies their pages from its source
+uint8_t* writablePhysicalMemory(ArPhysicalMemory memory, uint64_t offset, uint64_t size);
+
+/// \brief Mark the pages of size bytes at offset in memory as dirty, before processors write them
+void markPhysicalMemoryDirty(ArPhysicalMemory memory, uint64_t offset, uint64_t size);
+
+/// \brief Free the pristine pages of a memory
+void freePristinePages(ArPhysicalMemory memory);
+
+/// \brief Decode again the bundles which read the words [first, last) of the ISRAM, on several host threads for large ranges
+void decodeInstructionMemory(ArProcessor processor, uint32_t first, uint32_t last);
+
+/// \brief Complete at once, in issue order, the transfers of a processor up to the last one with memory
+void retireMemoryTransfers(ArProcessor processor, ArPhysicalMemory memory);
+
+/// \brief Attribute stall cycles to the bundle at pc, for a cause and a scoreboard slot or STALL_NO_REGISTER
+void recordStall(ArProcessor processor, uint32_t pc, ArStallCause cause, uint32_t reg, uint64_t cycles);
+
 #endif
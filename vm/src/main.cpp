@@ -5,9 +5,18 @@
 #include <utility>
 #include <memory>
 #include <filesystem>
+#include <limits>
 #include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <charconv>
+#include <algorithm>
+#include <cstdio>
 
 #include "shared_library.hpp"
+#include "trace_file.hpp"
+#include "mapped_file.hpp"
 
 namespace ar
 {
@@ -21,6 +30,16 @@ static PFN_arCreatePhysicalMemory      arCreatePhysicalMemory{};
 static PFN_arDecodeInstruction         arDecodeInstruction{};
 static PFN_arExecuteInstruction        arExecuteInstruction{};
 static PFN_arExecuteDirectMemoryAccess arExecuteDirectMemoryAccess{};
+static PFN_arRunProcessor              arRunProcessor{};
+static PFN_arRunVirtualMachine         arRunVirtualMachine{};
+static PFN_arGetProcessorStatistics    arGetProcessorStatistics{};
+static PFN_arGetProcessorStallReport   arGetProcessorStallReport{};
+static PFN_arGetProcessorTrace         arGetProcessorTrace{};
+static PFN_arGetProcessorProfile       arGetProcessorProfile{};
+static PFN_arDisassembleBundle         arDisassembleBundle{};
+static PFN_arFlushProcessorCache       arFlushProcessorCache{};
+static PFN_arSaveState                 arSaveState{};
+static PFN_arLoadState                 arLoadState{};
 static PFN_arDestroyVirtualMachine     arDestroyVirtualMachine{};
 static PFN_arDestroyProcessor          arDestroyProcessor{};
 static PFN_arDestroyPhysicalMemory     arDestroyPhysicalMemory{};
@@ -33,6 +52,16 @@ static void load_functions(nes::shared_library& library)
     arDecodeInstruction         = library.load<PFN_arDecodeInstruction>("arDecodeInstruction");
     arExecuteInstruction        = library.load<PFN_arExecuteInstruction>("arExecuteInstruction");
     arExecuteDirectMemoryAccess = library.load<PFN_arExecuteDirectMemoryAccess>("arExecuteDirectMemoryAccess");
+    arRunProcessor              = library.load<PFN_arRunProcessor>("arRunProcessor");
+    arRunVirtualMachine         = library.load<PFN_arRunVirtualMachine>("arRunVirtualMachine");
+    arGetProcessorStatistics    = library.load<PFN_arGetProcessorStatistics>("arGetProcessorStatistics");
+    arGetProcessorStallReport   = library.load<PFN_arGetProcessorStallReport>("arGetProcessorStallReport");
+    arGetProcessorTrace         = library.load<PFN_arGetProcessorTrace>("arGetProcessorTrace");
+    arGetProcessorProfile       = library.load<PFN_arGetProcessorProfile>("arGetProcessorProfile");
+    arDisassembleBundle         = library.load<PFN_arDisassembleBundle>("arDisassembleBundle");
+    arFlushProcessorCache       = library.load<PFN_arFlushProcessorCache>("arFlushProcessorCache");
+    arSaveState                 = library.load<PFN_arSaveState>("arSaveState");
+    arLoadState                 = library.load<PFN_arLoadState>("arLoadState");
     arDestroyVirtualMachine     = library.load<PFN_arDestroyVirtualMachine>("arDestroyVirtualMachine");
     arDestroyProcessor          = library.load<PFN_arDestroyProcessor>("arDestroyProcessor");
     arDestroyPhysicalMemory     = library.load<PFN_arDestroyPhysicalMemory>("arDestroyPhysicalMemory");
@@ -40,6 +69,43 @@ static void load_functions(nes::shared_library& library)
 
 }
 
+static std::vector<ArTraceEntry> get_trace(ArProcessor processor)
+{
+    std::uint32_t count{};
+    arGetProcessorTrace(processor, &count, nullptr);
+
+    std::vector<ArTraceEntry> output{};
+    output.resize(count);
+
+    arGetProcessorTrace(processor, &count, std::data(output));
+
+    return output;
+}
+
+//The last bundle a tracing processor executed, for the error messages
+static std::string describe_last_bundle(ArProcessor processor)
+{
+    const auto trace{get_trace(processor)};
+    if(std::empty(trace))
+    {
+        return {};
+    }
+
+    const auto& entry{trace.back()};
+
+    char text[96];
+    std::snprintf(text, sizeof(text), " Last bundle: pc %u, cycle %llu, op-codes", static_cast<unsigned>(entry.pc), static_cast<unsigned long long>(entry.cycle));
+
+    std::string output{text};
+    for(std::uint32_t i{}; i < entry.size; ++i)
+    {
+        std::snprintf(text, sizeof(text), " %08x", static_cast<unsigned>(entry.opcodes[i]));
+        output += text;
+    }
+
+    return output + ".";
+}
+
 class virtual_machine
 {
 public:
@@ -80,6 +146,59 @@ public:
         return *this;
     }
 
+    bool run(ArSchedulingMode mode, std::uint64_t quantum, std::uint64_t max_cycles = std::numeric_limits<std::uint64_t>::max())
+    {
+        ArVirtualMachineRunInfo info;
+        info.sType = AR_STRUCTURE_TYPE_VIRTUAL_MACHINE_RUN_INFO;
+        info.pNext = nullptr;
+        info.schedulingMode = mode;
+        info.quantum = quantum;
+        info.maxCycles = max_cycles;
+
+        ArProcessor faulting_processor{};
+        const auto result{arRunVirtualMachine(m_virtual_machine, &info, &faulting_processor)};
+
+        if(result == AR_END_OF_CODE)
+        {
+            return false;
+        }
+        else if(result != AR_SUCCESS)
+        {
+            throw std::runtime_error{"Can not run virtual machine." + (faulting_processor ? describe_last_bundle(faulting_processor) : std::string{})};
+        }
+
+        return true;
+    }
+
+    std::vector<std::uint8_t> save_state() const
+    {
+        std::uint64_t size{};
+        arSaveState(m_virtual_machine, &size, nullptr);
+
+        std::vector<std::uint8_t> output{};
+        output.resize(static_cast<std::size_t>(size));
+
+        if(arSaveState(m_virtual_machine, &size, std::data(output)) != AR_SUCCESS)
+        {
+            throw std::runtime_error{"Can not save state."};
+        }
+
+        return output;
+    }
+
+    void load_state(const std::vector<std::uint8_t>& state)
+    {
+        const auto result{arLoadState(m_virtual_machine, std::data(state), std::size(state))};
+        if(result == AR_ERROR_INVALID_STATE)
+        {
+            throw std::runtime_error{"Can not load state, it does not match the virtual machine."};
+        }
+        else if(result != AR_SUCCESS)
+        {
+            throw std::runtime_error{"Can not load state."};
+        }
+    }
+
     ArVirtualMachine handle() const noexcept
     {
         return m_virtual_machine;
@@ -92,12 +211,13 @@ private:
 class processor
 {
 public:
-    explicit processor(virtual_machine& machine, const std::uint32_t* code, std::size_t code_size)
+    //next is a chain of ArProcessorDmaCreateInfo, ArProcessorCacheCreateInfo, ArProcessorTraceCreateInfo and ArProcessorProfileCreateInfo
+    explicit processor(virtual_machine& machine, const std::uint32_t* code, std::size_t code_size, void* next = nullptr)
     :m_virtual_machine{machine.handle()}
     {
         ArProcessorCreateInfo info;
         info.sType = AR_STRUCTURE_TYPE_PROCESSOR_CREATE_INFO;
-        info.pNext = nullptr;
+        info.pNext = next;
         info.pBootCode = code;
         info.bootCodeSize = code_size;
 
@@ -139,8 +259,7 @@ public:
         const auto result{arDecodeInstruction(m_processor)};
         if(result != AR_SUCCESS)
         {
-            //TODO: put a backtrace and opcode that generated the error
-            throw std::runtime_error{"Can not decode instruction."};
+            throw std::runtime_error{"Can not decode instruction." + describe_last_bundle(m_processor)};
         }
     }
 
@@ -154,8 +273,7 @@ public:
         }
         else if(result != AR_SUCCESS)
         {
-            //TODO: put a backtrace and opcode that generated the error
-            throw std::runtime_error{"Can not execute instruction."};
+            throw std::runtime_error{"Can not execute instruction." + describe_last_bundle(m_processor)};
         }
 
         return true;
@@ -167,8 +285,87 @@ public:
 
         if(result != AR_SUCCESS)
         {
-            //TODO: put a backtrace
-            throw std::runtime_error{"Can not execute direct memory access."};
+            throw std::runtime_error{"Can not execute direct memory access." + describe_last_bundle(m_processor)};
+        }
+    }
+
+    bool run(std::uint64_t max_cycles = std::numeric_limits<std::uint64_t>::max())
+    {
+        const auto result{arRunProcessor(m_processor, max_cycles, nullptr)};
+
+        if(result == AR_END_OF_CODE)
+        {
+            return false;
+        }
+        else if(result != AR_SUCCESS)
+        {
+            throw std::runtime_error{"Can not run processor." + describe_last_bundle(m_processor)};
+        }
+
+        return true;
+    }
+
+    ArProcessorStatistics statistics() const noexcept
+    {
+        ArProcessorStatistics output{};
+        output.sType = AR_STRUCTURE_TYPE_PROCESSOR_STATISTICS;
+
+        arGetProcessorStatistics(m_processor, &output);
+
+        return output;
+    }
+
+    std::vector<ArStallRecord> stall_report() const
+    {
+        std::uint32_t count{};
+        arGetProcessorStallReport(m_processor, &count, nullptr);
+
+        std::vector<ArStallRecord> output{};
+        output.resize(count);
+
+        if(arGetProcessorStallReport(m_processor, &count, std::data(output)) != AR_SUCCESS)
+        {
+            throw std::runtime_error{"Can not get stall report."};
+        }
+
+        output.resize(count);
+
+        return output;
+    }
+
+    std::vector<ArTraceEntry> trace() const
+    {
+        return get_trace(m_processor);
+    }
+
+    std::vector<ArProfileRecord> profile() const
+    {
+        std::uint32_t count{};
+        arGetProcessorProfile(m_processor, &count, nullptr);
+
+        std::vector<ArProfileRecord> output{};
+        output.resize(count);
+
+        arGetProcessorProfile(m_processor, &count, std::data(output));
+        output.resize(count);
+
+        return output;
+    }
+
+    //An illegal op-code is written as .word, the text is still meaningful
+    std::string disassemble(std::uint32_t pc, std::uint32_t size) const
+    {
+        char text[256];
+        arDisassembleBundle(m_processor, pc, size, sizeof(text), text);
+
+        return text;
+    }
+
+    void flush_cache()
+    {
+        if(arFlushProcessorCache(m_processor) != AR_SUCCESS)
+        {
+            throw std::runtime_error{"Can not flush cache, its physical memory is gone."};
         }
     }
 
@@ -188,18 +385,36 @@ public:
     static constexpr std::size_t default_size{8 * 1024 * 1024};
 
 public:
-    explicit physical_memory(virtual_machine& machine, std::size_t size = default_size)
+    //With a mapping, the implementation maps the memory itself and only the touched pages cost host memory
+    //next is a chain of ArPhysicalMemoryFileCreateInfo, mapped over a private mapping rather than read
+    explicit physical_memory(virtual_machine& machine, std::size_t size = default_size, const ArPhysicalMemoryMappingCreateInfo* mapping = nullptr, std::uint64_t address = 0, void* next = nullptr)
     :m_virtual_machine{machine.handle()}
-    ,m_memory{std::make_unique<std::uint8_t[]>(size)}
+    ,m_memory{mapping ? nullptr : std::make_unique<std::uint8_t[]>(size)}
     {
+        ArPhysicalMemoryMappingCreateInfo mapping_info{};
+        if(mapping)
+        {
+            mapping_info = *mapping;
+            mapping_info.pNext = next;
+        }
+
         ArPhysicalMemoryCreateInfo info;
         info.sType = AR_STRUCTURE_TYPE_PHYSICAL_MEMORY_CREATE_INFO;
-        info.pNext = nullptr;
+        info.pNext = mapping ? &mapping_info : next;
         info.pMemory = m_memory.get();
         info.size = size;
+        info.address = address;
 
         const auto result{arCreatePhysicalMemory(m_virtual_machine, &info, &m_physical_memory)};
-        if(result != AR_SUCCESS)
+        if(result == AR_ERROR_HOST_MAPPING_FAILED)
+        {
+            throw std::runtime_error{"Can not map physical_memory."};
+        }
+        else if(result == AR_ERROR_PHYSICAL_MEMORY_OVERLAP)
+        {
+            throw std::runtime_error{"Can not create physical_memory, it overlaps another one."};
+        }
+        else if(result != AR_SUCCESS)
         {
             throw std::runtime_error{"Can not create physical_memory."};
         }
@@ -246,22 +461,80 @@ private:
 
 }
 
+struct memory_region
+{
+    std::uint64_t address{};
+    std::uint64_t size{};
+    std::string path{}; //file mapped privately at the beginning of the region, if not empty
+};
+
+struct memory_preload
+{
+    std::uint64_t address{};
+    std::string path{}; //file preloaded at address, up to its end or the end of the physical memory holding address
+};
+
 struct machine_options
 {
     enum : std::uint32_t
     {
-        pedantic = 0x01
+        pedantic = 0x01,
+        jit = 0x02,
+        statistics = 0x04,
+        stall_report = 0x08,
+        stall_report_json = 0x10,
+        dma_timing = 0x20,
+        memory_sparse = 0x40,
+        memory_shared = 0x80,
+        cache_model = 0x100,
+        trace_dump = 0x200,
+        profile = 0x400
     };
 
     std::string boot_path{};
+    std::vector<std::string> core_paths{}; //boot code of the other cores, run after the main core
     std::uint32_t flags{};
+    ArSchedulingMode scheduling_mode{AR_SCHEDULING_MODE_QUANTUM};
+    std::uint64_t quantum{1024};
+    std::uint32_t dma_latency{};
+    std::uint32_t dma_bandwidth{};
+    std::uint32_t cache_line_size{};
+    std::uint32_t trace_size{}; //bundles traced by each core, 0 if the cores do not trace
+    std::string trace_path{"altair_vm.trace"};
+    std::uint64_t memory_size{ar::physical_memory::default_size};
+    std::string memory_path{}; //file mapped at the beginning of the physical memory, if not empty
+    std::vector<memory_region> regions{}; //physical memories besides the one at address 0
+    std::vector<memory_preload> preloads{}; //files preloaded in the physical memories, mapped when the memory is a private mapping
+    std::string load_state_path{}; //state loaded before the run, if not empty
+    std::string save_state_path{}; //state saved after the run, if not empty
 };
 
+//Parses a number of bytes, hexadecimal with a 0x prefix, with an optional K, M or G suffix
+static std::uint64_t parse_size(std::string_view value)
+{
+    const auto hexadecimal{value.substr(0, 2) == "0x"};
+    if(hexadecimal)
+    {
+        value.remove_prefix(2);
+    }
+
+    std::uint64_t output{};
+    const auto end{std::from_chars(std::data(value), std::data(value) + std::size(value), output, hexadecimal ? 16 : 10).ptr};
+
+    switch(end != std::data(value) + std::size(value) ? *end : '\0')
+    {
+        case 'K': return output << 10u;
+        case 'M': return output << 20u;
+        case 'G': return output << 30u;
+        default:  return output;
+    }
+}
+
 static machine_options parse_arguments(const std::vector<std::string_view>& args)
 {
     if(std::size(args) < 2)
     {
-        throw std::runtime_error{"Usage: altair_vm [path_to_binary] [flags]"};
+        throw std::runtime_error{"Usage: altair_vm [path_to_binary] [flags] [-core=path_to_binary...] [-lockstep|-parallel] [-quantum=N] [-dma-latency=N] [-dma-bandwidth=N] [-cache-line=N] [-trace=N [-trace-file=path] [-trace-dump]] [-statistics] [-stall-report[=json]] [-profile] [-memory-size=N[K|M|G]] [-memory-sparse] [-memory-file=path [-memory-shared]] [-region=address:size[:path]...] [-preload=address:path...] [-load-state=path] [-save-state=path]"};
     }
 
     machine_options output{};
@@ -273,6 +546,144 @@ static machine_options parse_arguments(const std::vector<std::string_view>& args
         {
             output.flags |= machine_options::pedantic;
         }
+        else if(*it == "-jit")
+        {
+            output.flags |= machine_options::jit;
+        }
+        else if(*it == "-lockstep")
+        {
+            output.scheduling_mode = AR_SCHEDULING_MODE_LOCKSTEP;
+        }
+        else if(*it == "-parallel")
+        {
+            output.scheduling_mode = AR_SCHEDULING_MODE_PARALLEL;
+        }
+        else if(it->substr(0, 9) == "-quantum=")
+        {
+            const auto value{it->substr(9)};
+            std::from_chars(std::data(value), std::data(value) + std::size(value), output.quantum);
+            output.quantum = std::max(output.quantum, std::uint64_t{1});
+        }
+        else if(*it == "-stall-report")
+        {
+            output.flags |= machine_options::stall_report;
+        }
+        else if(*it == "-stall-report=json")
+        {
+            output.flags |= machine_options::stall_report | machine_options::stall_report_json;
+        }
+        else if(*it == "-profile")
+        {
+            output.flags |= machine_options::profile;
+        }
+        else if(*it == "-statistics")
+        {
+            output.flags |= machine_options::statistics;
+        }
+        else if(it->substr(0, 13) == "-dma-latency=")
+        {
+            const auto value{it->substr(13)};
+            std::from_chars(std::data(value), std::data(value) + std::size(value), output.dma_latency);
+            output.flags |= machine_options::dma_timing;
+        }
+        else if(it->substr(0, 12) == "-cache-line=")
+        {
+            const auto value{it->substr(12)};
+            std::from_chars(std::data(value), std::data(value) + std::size(value), output.cache_line_size);
+
+            if(output.cache_line_size < 16 || output.cache_line_size > 32768 || (output.cache_line_size & (output.cache_line_size - 1)))
+            {
+                throw std::runtime_error{"Invalid cache line size [" + std::string{value} + "], expected a power of two between 16 and 32768."};
+            }
+
+            output.flags |= machine_options::cache_model;
+        }
+        else if(it->substr(0, 7) == "-trace=")
+        {
+            const auto value{it->substr(7)};
+            std::from_chars(std::data(value), std::data(value) + std::size(value), output.trace_size);
+
+            if(output.trace_size == 0 || (output.trace_size & (output.trace_size - 1)))
+            {
+                throw std::runtime_error{"Invalid trace size [" + std::string{value} + "], expected a power of two."};
+            }
+        }
+        else if(it->substr(0, 12) == "-trace-file=")
+        {
+            output.trace_path = it->substr(12);
+        }
+        else if(*it == "-trace-dump")
+        {
+            output.flags |= machine_options::trace_dump;
+        }
+        else if(it->substr(0, 15) == "-dma-bandwidth=")
+        {
+            const auto value{it->substr(15)};
+            std::from_chars(std::data(value), std::data(value) + std::size(value), output.dma_bandwidth);
+            output.flags |= machine_options::dma_timing;
+        }
+        else if(it->substr(0, 6) == "-core=")
+        {
+            output.core_paths.emplace_back(it->substr(6));
+        }
+        else if(it->substr(0, 13) == "-memory-size=")
+        {
+            output.memory_size = std::max(parse_size(it->substr(13)), std::uint64_t{1});
+        }
+        else if(*it == "-memory-sparse")
+        {
+            output.flags |= machine_options::memory_sparse;
+        }
+        else if(it->substr(0, 13) == "-memory-file=")
+        {
+            output.memory_path = it->substr(13);
+        }
+        else if(*it == "-memory-shared")
+        {
+            output.flags |= machine_options::memory_shared;
+        }
+        else if(it->substr(0, 12) == "-load-state=")
+        {
+            output.load_state_path = it->substr(12);
+        }
+        else if(it->substr(0, 12) == "-save-state=")
+        {
+            output.save_state_path = it->substr(12);
+        }
+        else if(it->substr(0, 8) == "-region=") //-region=address:size[:path]
+        {
+            const auto value{it->substr(8)};
+            const auto size_begin{value.find(':')};
+            const auto path_begin{value.find(':', size_begin + 1)};
+
+            if(size_begin == std::string_view::npos)
+            {
+                throw std::runtime_error{"Invalid region [" + std::string{*it} + "], expected -region=address:size[:path]."};
+            }
+
+            memory_region region{};
+            region.address = parse_size(value.substr(0, size_begin));
+            region.size = std::max(parse_size(value.substr(size_begin + 1, path_begin - size_begin - 1)), std::uint64_t{1});
+            region.path = path_begin == std::string_view::npos ? std::string{} : std::string{value.substr(path_begin + 1)};
+
+            output.regions.emplace_back(std::move(region));
+        }
+        else if(it->substr(0, 9) == "-preload=") //-preload=address:path
+        {
+            const auto value{it->substr(9)};
+            const auto path_begin{value.find(':')};
+
+            if(path_begin == std::string_view::npos || path_begin + 1 == std::size(value))
+            {
+                throw std::runtime_error{"Invalid preload [" + std::string{*it} + "], expected -preload=address:path."};
+            }
+
+            memory_preload preload{};
+            preload.address = parse_size(value.substr(0, path_begin));
+            preload.path = std::string{value.substr(path_begin + 1)};
+
+            output.preloads.emplace_back(std::move(preload));
+        }
         else
         {
             std::cout << "Unrecognised argument [" << *it << "]" << std::endl;
@@ -285,9 +696,11 @@ static machine_options parse_arguments(const std::vector<std::string_view>& args
 #ifdef NES_WIN32_SHARED_LIBRARY
 static constexpr const char* relaxed_default_path{"altair_vm_relaxed.dll"};
 static constexpr const char* pedantic_default_path{"altair_vm_pedantic.dll"};
+static constexpr const char* jit_default_path{"altair_vm_jit.dll"};
 #else
 static constexpr const char* relaxed_default_path{"altair_vm_relaxed.so"};
 static constexpr const char* pedantic_default_path{"altair_vm_pedantic.so"};
+static constexpr const char* jit_default_path{"altair_vm_jit.so"};
 #endif
 
 static nes::shared_library open_implementation(std::uint32_t flags)
@@ -296,13 +709,17 @@ static nes::shared_library open_implementation(std::uint32_t flags)
     {
         return nes::shared_library{pedantic_default_path};
     }
+    else if(static_cast<bool>(flags & machine_options::jit))
+    {
+        return nes::shared_library{jit_default_path};
+    }
     else
     {
         return nes::shared_library{relaxed_default_path};
     }
 }
 
-static std::vector<std::uint32_t> read_binary(const std::filesystem::path& path)
+static std::vector<std::uint8_t> read_state(const std::filesystem::path& path)
 {
     std::ifstream ifs{path, std::ios_base::binary};
     if(!ifs)
@@ -310,10 +727,10 @@ static std::vector<std::uint32_t> read_binary(const std::filesystem::path& path)
         throw std::runtime_error{"Can not find file \"" + path.string() + "\"."};
     }
 
-    std::vector<std::uint32_t> output{};
-    output.resize(std::filesystem::file_size(path) / 4u);
+    std::vector<std::uint8_t> output{};
+    output.resize(static_cast<std::size_t>(std::filesystem::file_size(path)));
 
-    const auto bytes_size{static_cast<std::streamsize>(std::size(output) * 4)};
+    const auto bytes_size{static_cast<std::streamsize>(std::size(output))};
     if(ifs.read(reinterpret_cast<char*>(std::data(output)), bytes_size).gcount() != bytes_size)
     {
         throw std::runtime_error{"Can not read file \"" + path.string() + "\"."};
@@ -322,27 +739,387 @@ static std::vector<std::uint32_t> read_binary(const std::filesystem::path& path)
     return output;
 }
 
+static void write_state(const std::filesystem::path& path, const std::vector<std::uint8_t>& state)
+{
+    std::ofstream ofs{path, std::ios_base::binary};
+    if(!ofs.write(reinterpret_cast<const char*>(std::data(state)), static_cast<std::streamsize>(std::size(state))))
+    {
+        throw std::runtime_error{"Can not write file \"" + path.string() + "\"."};
+    }
+}
+
+static void write_trace(const std::filesystem::path& path, const std::vector<const ar::processor*>& processors, bool failed)
+{
+    std::ofstream ofs{path, std::ios_base::binary};
+
+    ar::trace_file_header header{};
+    header.core_count = static_cast<std::uint32_t>(std::size(processors));
+    header.failed = failed ? 1u : 0u;
+    ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    for(std::size_t i{}; i < std::size(processors); ++i)
+    {
+        const auto trace{processors[i]->trace()};
+
+        ar::trace_core_header core{};
+        core.core = static_cast<std::uint32_t>(i);
+        core.entry_count = static_cast<std::uint32_t>(std::size(trace));
+        ofs.write(reinterpret_cast<const char*>(&core), sizeof(core));
+        ofs.write(reinterpret_cast<const char*>(std::data(trace)), static_cast<std::streamsize>(std::size(trace) * sizeof(ArTraceEntry)));
+    }
+
+    if(!ofs)
+    {
+        throw std::runtime_error{"Can not write file \"" + path.string() + "\"."};
+    }
+}
+
+static const char* stall_cause_name(ArStallCause cause)
+{
+    switch(cause)
+    {
+        case AR_STALL_CAUSE_LOAD_USE:   return "load-use";
+        case AR_STALL_CAUSE_DEPENDENCY: return "dependency";
+        case AR_STALL_CAUSE_DIVIDER:    return "divider";
+        case AR_STALL_CAUSE_DMA_WAIT:   return "dma-wait";
+    }
+
+    return "unknown";
+}
+
+static std::string stall_register_name(std::uint32_t reg)
+{
+    if(reg == AR_STALL_REGISTER_NONE)
+    {
+        return "-";
+    }
+    else if(reg == AR_STALL_REGISTER_FLAGS)
+    {
+        return "flags";
+    }
+    else if(reg == AR_STALL_REGISTER_ACCUMULATOR)
+    {
+        return "acc";
+    }
+    else if(reg >= 64)
+    {
+        return "f" + std::to_string(reg - 64);
+    }
+
+    return "r" + std::to_string(reg);
+}
+
+//One table per core, the records are already sorted by decreasing stall cycles
+static void print_stall_reports(const std::vector<const ar::processor*>& processors, bool json)
+{
+    if(json)
+    {
+        std::cout << "{\"cores\":[";
+    }
+
+    for(std::size_t i{}; i < std::size(processors); ++i)
+    {
+        const auto cycles{processors[i]->statistics().cycles};
+        const auto records{processors[i]->stall_report()};
+
+        if(json)
+        {
+            std::cout << (i ? "," : "") << "{\"core\":" << i << ",\"cycles\":" << cycles << ",\"stalls\":[";
+
+            for(std::size_t j{}; j < std::size(records); ++j)
+            {
+                const auto& record{records[j]};
+                std::cout << (j ? "," : "") << "{\"pc\":" << record.pc
+                          << ",\"cause\":\"" << stall_cause_name(record.cause)
+                          << "\",\"register\":\"" << stall_register_name(record.reg)
+                          << "\",\"count\":" << record.count
+                          << ",\"cycles\":" << record.cycles << "}";
+            }
+
+            std::cout << "]}";
+        }
+        else
+        {
+            std::cout << "core " << i << ": " << cycles << " cycles\n";
+            std::cout << "         pc  cause       register       count      cycles   share\n";
+
+            for(auto&& record : records)
+            {
+                const auto share{cycles ? 100.0 * static_cast<double>(record.cycles) / static_cast<double>(cycles) : 0.0};
+
+                char line[128];
+                std::snprintf(line, sizeof(line), "    %7u  %-10s  %-8s  %10llu  %10llu  %5.1f%%\n",
+                              record.pc, stall_cause_name(record.cause), stall_register_name(record.reg).c_str(),
+                              static_cast<unsigned long long>(record.count), static_cast<unsigned long long>(record.cycles), share);
+                std::cout << line;
+            }
+        }
+    }
+
+    std::cout << (json ? "]}\n" : "") << std::flush;
+}
+
+//One annotated listing per core, of the bundles which ran in program order, a gap in the program counters starts a new block
+static void print_profiles(const std::vector<const ar::processor*>& processors)
+{
+    for(std::size_t i{}; i < std::size(processors); ++i)
+    {
+        const auto records{processors[i]->profile()};
+
+        std::uint64_t bundles{};
+        for(auto&& record : records)
+        {
+            bundles += record.executions;
+        }
+
+        std::cout << "core " << i << ": " << bundles << " bundles\n";
+        std::cout << "         pc  executions   share       taken   not taken   DMA bytes  bundle\n";
+
+        std::uint32_t next{};
+        for(auto&& record : records)
+        {
+            if(record.pc != next)
+            {
+                std::cout << "        ...\n";
+            }
+
+            const auto share{bundles ? 100.0 * static_cast<double>(record.executions) / static_cast<double>(bundles) : 0.0};
+
+            char line[128];
+            std::snprintf(line, sizeof(line), "    %7u  %10llu  %5.1f%%  %10llu  %10llu  %10llu  ",
+                          record.pc, static_cast<unsigned long long>(record.executions), share,
+                          static_cast<unsigned long long>(record.branchesTaken), static_cast<unsigned long long>(record.branchesNotTaken),
+                          static_cast<unsigned long long>(record.dmaBytes));
+            std::cout << line << processors[i]->disassemble(record.pc, record.size) << '\n';
+
+            next = record.pc + record.size;
+        }
+    }
+
+    std::cout << std::flush;
+}
+
 static void run(const machine_options& options)
 {
     auto implementation {open_implementation(options.flags)};
-    const auto boot_code{read_binary(options.boot_path)};
+
+    //Binaries are mapped, arCreateProcessor copies them to the ISRAM without another copy on the host
+    const ar::mapped_file boot_code{options.boot_path};
 
     ar::functions::load_functions(implementation);
 
+    //Without -dma-latency nor -dma-bandwidth, each implementation keeps its own DMA timing
+    ArProcessorDmaCreateInfo dma_info{};
+    dma_info.sType = AR_STRUCTURE_TYPE_PROCESSOR_DMA_CREATE_INFO;
+    dma_info.latency = options.dma_latency;
+    dma_info.bandwidth = options.dma_bandwidth;
+
+    const auto dma_timing{static_cast<bool>(options.flags & machine_options::dma_timing) ? &dma_info : nullptr};
+
+    //-cache-line models the cache of every core over the physical memory
+    ArProcessorCacheCreateInfo cache_info{};
+    cache_info.sType = AR_STRUCTURE_TYPE_PROCESSOR_CACHE_CREATE_INFO;
+    cache_info.pNext = dma_timing;
+    cache_info.lineSize = options.cache_line_size;
+
+    const auto cache_model{static_cast<bool>(options.flags & machine_options::cache_model)};
+
+    //-trace keeps the last bundles of every core, dumped when the run fails or with -trace-dump
+    ArProcessorTraceCreateInfo trace_info{};
+    trace_info.sType = AR_STRUCTURE_TYPE_PROCESSOR_TRACE_CREATE_INFO;
+    trace_info.pNext = cache_model ? static_cast<void*>(&cache_info) : static_cast<void*>(dma_timing);
+    trace_info.entryCount = options.trace_size;
+
+    const auto tracing{options.trace_size != 0};
+
+    //-profile counts the executions, branches and DMA bytes of every bundle
+    ArProcessorProfileCreateInfo profile_info{};
+    profile_info.sType = AR_STRUCTURE_TYPE_PROCESSOR_PROFILE_CREATE_INFO;
+    profile_info.pNext = tracing ? &trace_info : trace_info.pNext;
+
+    const auto profiling{static_cast<bool>(options.flags & machine_options::profile)};
+    void* const processor_next{profiling ? &profile_info : profile_info.pNext};
+
     ar::virtual_machine machine{};
-    ar::processor processor{machine, std::data(boot_code), std::size(boot_code)};
-    ar::physical_memory memory{machine};
+    ar::processor processor{machine, boot_code.words(), boot_code.word_count(), processor_next};
+    //-memory-file and -memory-sparse let the implementation map the memory, a file is mapped at its beginning
+    ArPhysicalMemoryMappingCreateInfo mapping_info{};
+    mapping_info.sType = AR_STRUCTURE_TYPE_PHYSICAL_MEMORY_MAPPING_CREATE_INFO;
+    mapping_info.pPath = std::empty(options.memory_path) ? nullptr : options.memory_path.c_str();
+    mapping_info.shared = static_cast<bool>(options.flags & machine_options::memory_shared) ? 1u : 0u;
+
+    const auto mapped{!std::empty(options.memory_path) || static_cast<bool>(options.flags & machine_options::memory_sparse)};
+
+    //-preload files go to the physical memory holding their address, each memory gets a chain of them
+    const auto holds{[](std::uint64_t address, std::uint64_t size, const memory_preload& preload)
+    {
+        return preload.address >= address && preload.address - address < size;
+    }};
+
+    for(auto&& preload : options.preloads)
+    {
+        const auto region_holds{[&](const memory_region& region) { return holds(region.address, region.size, preload); }};
+        if(!holds(0, options.memory_size, preload) && std::none_of(std::begin(options.regions), std::end(options.regions), region_holds))
+        {
+            throw std::runtime_error{"Can not preload \"" + preload.path + "\", no physical memory holds its address."};
+        }
+    }
 
-    while(true)
+    const auto preloads_of{[&options, &holds](std::uint64_t address, std::uint64_t size)
     {
-        processor.decode();
+        std::vector<ArPhysicalMemoryFileCreateInfo> output{};
+        for(auto&& preload : options.preloads)
+        {
+            if(holds(address, size, preload))
+            {
+                ArPhysicalMemoryFileCreateInfo info{};
+                info.sType = AR_STRUCTURE_TYPE_PHYSICAL_MEMORY_FILE_CREATE_INFO;
+                info.pPath = preload.path.c_str();
+                info.offset = preload.address - address;
+                info.size = size - info.offset;
+
+                output.emplace_back(info);
+            }
+        }
 
-        if(!processor.execute())
+        for(std::size_t i{1}; i < std::size(output); ++i)
         {
-            break;
+            output[i - 1].pNext = &output[i];
         }
 
-        processor.direct_memory_access();
+        return output;
+    }};
+
+    auto memory_preloads{preloads_of(0, options.memory_size)};
+    ar::physical_memory memory{machine, static_cast<std::size_t>(options.memory_size), mapped ? &mapping_info : nullptr, 0, std::empty(memory_preloads) ? nullptr : std::data(memory_preloads)};
+
+    //Regions are sparse mappings, so that VRAM, SSD RAM or RAM of the memory map only cost their touched pages
+    std::vector<ar::physical_memory> regions{};
+    regions.reserve(std::size(options.regions));
+    for(auto&& region : options.regions)
+    {
+        ArPhysicalMemoryMappingCreateInfo region_info{};
+        region_info.sType = AR_STRUCTURE_TYPE_PHYSICAL_MEMORY_MAPPING_CREATE_INFO;
+        region_info.pPath = std::empty(region.path) ? nullptr : region.path.c_str();
+
+        auto region_preloads{preloads_of(region.address, region.size)};
+        regions.emplace_back(machine, static_cast<std::size_t>(region.size), &region_info, region.address, std::empty(region_preloads) ? nullptr : std::data(region_preloads));
+    }
+
+    std::vector<ar::processor> cores{};
+    cores.reserve(std::size(options.core_paths));
+    for(auto&& path : options.core_paths)
+    {
+        const ar::mapped_file code{path};
+        cores.emplace_back(machine, code.words(), code.word_count(), processor_next);
+    }
+
+    //The state replaces the boot code and the memory pages it holds, the cores and memories must match the saved ones
+    if(!std::empty(options.load_state_path))
+    {
+        machine.load_state(read_state(options.load_state_path));
+    }
+
+    std::vector<const ar::processor*> processors{&processor};
+    for(auto&& core : cores)
+    {
+        processors.emplace_back(&core);
+    }
+
+    //The instruction memory is decoded when it is loaded, op-codes no bundle can run are likely a corrupted binary
+    for(std::size_t i{}; i < std::size(processors); ++i)
+    {
+        const auto illegal_opcodes{processors[i]->statistics().illegalOpcodes};
+        if(illegal_opcodes > 0)
+        {
+            std::cerr << "Warning: core " << i << " has " << illegal_opcodes << " op-codes which can not be decoded." << std::endl;
+        }
+    }
+
+    try
+    {
+        if(std::empty(cores))
+        {
+            while(processor.run())
+            {
+
+            }
+        }
+        else
+        {
+            while(machine.run(options.scheduling_mode, options.quantum))
+            {
+
+            }
+        }
+    }
+    catch(const std::exception& e)
+    {
+        if(!tracing)
+        {
+            throw;
+        }
+
+        write_trace(options.trace_path, processors, true);
+        throw std::runtime_error{std::string{e.what()} + " The trace is in \"" + options.trace_path + "\"."};
+    }
+
+    if(tracing && static_cast<bool>(options.flags & machine_options::trace_dump))
+    {
+        write_trace(options.trace_path, processors, false);
+    }
+
+    if(!std::empty(options.save_state_path))
+    {
+        write_state(options.save_state_path, machine.save_state());
+    }
+
+    //The physical memory sees the stores still in the caches
+    if(cache_model)
+    {
+        processor.flush_cache();
+        for(auto&& core : cores)
+        {
+            core.flush_cache();
+        }
+    }
+
+    if(static_cast<bool>(options.flags & machine_options::statistics))
+    {
+        const auto print_statistics{[cache_model](std::size_t index, const ArProcessorStatistics& statistics)
+        {
+            std::cout << "core " << index << ": " << statistics.cycles << " cycles, "
+                      << statistics.dmaTransfers << " DMA transfers (" << statistics.dmaBytes << " bytes), "
+                      << statistics.dmaStallCycles << " DMA stall cycles, "
+                      << statistics.pipelineHazards << " pipeline hazards ("
+                      << statistics.pipelineStallCycles << " stall cycles)";
+
+            if(cache_model)
+            {
+                std::cout << ", " << statistics.cacheHits << " cache hits, "
+                          << statistics.cacheMisses << " misses, "
+                          << statistics.cacheEvictions << " evictions ("
+                          << statistics.cacheWritebacks << " writebacks)";
+            }
+
+            std::cout << std::endl;
+        }};
+
+        print_statistics(0, processor.statistics());
+        for(std::size_t i{}; i < std::size(cores); ++i)
+        {
+            print_statistics(i + 1, cores[i].statistics());
+        }
+    }
+
+    if(static_cast<bool>(options.flags & machine_options::stall_report))
+    {
+        print_stall_reports(processors, static_cast<bool>(options.flags & machine_options::stall_report_json));
+    }
+
+    if(profiling)
+    {
+        print_profiles(processors);
     }
 }
 
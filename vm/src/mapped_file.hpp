@@ -0,0 +1,145 @@
+#ifndef ALTAIR_VM_MAPPED_FILE_HPP_INCLUDED
+#define ALTAIR_VM_MAPPED_FILE_HPP_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+    #define ALTAIR_VM_MAPPED_FILE_MMAP
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+namespace ar
+{
+
+//A read-only view of a whole file, mapped when the host can map files, read otherwise
+class mapped_file
+{
+public:
+    explicit mapped_file(const std::filesystem::path& path)
+    {
+#ifdef ALTAIR_VM_MAPPED_FILE_MMAP
+        const int file{::open(path.c_str(), O_RDONLY)};
+        if(file < 0)
+        {
+            throw std::runtime_error{"Can not find file \"" + path.string() + "\"."};
+        }
+
+        struct stat status{};
+        if(::fstat(file, &status) != 0)
+        {
+            ::close(file);
+            throw std::runtime_error{"Can not read file \"" + path.string() + "\"."};
+        }
+
+        m_size = static_cast<std::size_t>(status.st_size);
+
+        //The pages are only read when the implementation copies them, an empty file can not be mapped
+        if(m_size > 0)
+        {
+            void* const data{::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, file, 0)};
+            if(data == MAP_FAILED)
+            {
+                ::close(file);
+                throw std::runtime_error{"Can not map file \"" + path.string() + "\"."};
+            }
+
+            m_data = static_cast<const std::uint8_t*>(data);
+        }
+
+        ::close(file); //the mapping keeps the file alive
+#else
+        std::ifstream ifs{path, std::ios_base::binary};
+        if(!ifs)
+        {
+            throw std::runtime_error{"Can not find file \"" + path.string() + "\"."};
+        }
+
+        m_size = static_cast<std::size_t>(std::filesystem::file_size(path));
+        m_buffer.resize((m_size + 3u) / 4u);
+
+        const auto bytes_size{static_cast<std::streamsize>(m_size)};
+        if(ifs.read(reinterpret_cast<char*>(std::data(m_buffer)), bytes_size).gcount() != bytes_size)
+        {
+            throw std::runtime_error{"Can not read file \"" + path.string() + "\"."};
+        }
+
+        m_data = reinterpret_cast<const std::uint8_t*>(std::data(m_buffer));
+#endif
+    }
+
+    ~mapped_file()
+    {
+#ifdef ALTAIR_VM_MAPPED_FILE_MMAP
+        if(m_data)
+        {
+            ::munmap(const_cast<std::uint8_t*>(m_data), m_size);
+        }
+#endif
+    }
+
+    mapped_file(const mapped_file&) = delete;
+    mapped_file& operator=(const mapped_file&) = delete;
+
+    mapped_file(mapped_file&& other) noexcept
+    :m_data{std::exchange(other.m_data, nullptr)}
+    ,m_size{std::exchange(other.m_size, 0)}
+#ifndef ALTAIR_VM_MAPPED_FILE_MMAP
+    ,m_buffer{std::move(other.m_buffer)}
+#endif
+    {
+
+    }
+
+    mapped_file& operator=(mapped_file&& other) noexcept
+    {
+        m_data = std::exchange(other.m_data, m_data);
+        m_size = std::exchange(other.m_size, m_size);
+#ifndef ALTAIR_VM_MAPPED_FILE_MMAP
+        m_buffer.swap(other.m_buffer);
+#endif
+
+        return *this;
+    }
+
+    //The op-codes of a binary, a mapping starts on a page and the buffer is an array of words
+    const std::uint32_t* words() const noexcept
+    {
+        return reinterpret_cast<const std::uint32_t*>(m_data);
+    }
+
+    std::size_t word_count() const noexcept
+    {
+        return m_size / 4u;
+    }
+
+    const std::uint8_t* data() const noexcept
+    {
+        return m_data;
+    }
+
+    std::size_t size() const noexcept
+    {
+        return m_size;
+    }
+
+private:
+    const std::uint8_t* m_data{};
+    std::size_t m_size{};
+#ifndef ALTAIR_VM_MAPPED_FILE_MMAP
+    std::vector<std::uint32_t> m_buffer{};
+#endif
+};
+
+}
+
+#endif
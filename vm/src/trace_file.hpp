@@ -0,0 +1,33 @@
+#ifndef ALTAIR_VM_TRACE_FILE_HPP_INCLUDED
+#define ALTAIR_VM_TRACE_FILE_HPP_INCLUDED
+
+#include <base/vm.h>
+
+#include <cstdint>
+
+namespace ar
+{
+
+//A trace file is a trace_file_header, then for each core a trace_core_header followed by its ArTraceEntry, oldest first
+inline constexpr std::uint32_t trace_file_magic{0x52545241}; //"ARTR"
+inline constexpr std::uint32_t trace_file_version{1};
+
+struct trace_file_header
+{
+    std::uint32_t magic{trace_file_magic};
+    std::uint32_t version{trace_file_version};
+    std::uint32_t core_count{};
+    std::uint32_t failed{}; //1 if the trace was dumped because the run failed, 0 if it was dumped on request
+};
+
+struct trace_core_header
+{
+    std::uint32_t core{};
+    std::uint32_t entry_count{};
+};
+
+static_assert(sizeof(ArTraceEntry) == 64, "trace entries are written as is");
+
+}
+
+#endif
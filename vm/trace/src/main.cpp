@@ -0,0 +1,143 @@
+#include <base/vm.h>
+#include <isa.h>
+
+#include <iostream>
+#include <stdexcept>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdio>
+
+#include <trace_file.hpp>
+
+namespace
+{
+
+std::string register_name(std::uint32_t reg)
+{
+    if(reg == AR_STALL_REGISTER_FLAGS)
+    {
+        return "flags";
+    }
+    else if(reg == AR_STALL_REGISTER_ACCUMULATOR)
+    {
+        return "acc";
+    }
+    else if(reg >= 64)
+    {
+        return "f" + std::to_string(reg - 64);
+    }
+
+    return "r" + std::to_string(reg);
+}
+
+template<typename T>
+void read_value(std::ifstream& ifs, T* value, std::size_t count, const std::filesystem::path& path)
+{
+    const auto bytes_size{static_cast<std::streamsize>(sizeof(T) * count)};
+    if(ifs.read(reinterpret_cast<char*>(value), bytes_size).gcount() != bytes_size)
+    {
+        throw std::runtime_error{"File \"" + path.string() + "\" is truncated."};
+    }
+}
+
+void print_entry(const ArTraceEntry& entry)
+{
+    char line[256];
+    int length{std::snprintf(line, sizeof(line), "    %12llu  %5u ", static_cast<unsigned long long>(entry.cycle), static_cast<unsigned>(entry.pc))};
+
+    for(std::uint32_t i{}; i < 4; ++i)
+    {
+        if(i < entry.size)
+        {
+            length += std::snprintf(line + length, sizeof(line) - static_cast<std::size_t>(length), " %08x", static_cast<unsigned>(entry.opcodes[i]));
+        }
+        else
+        {
+            length += std::snprintf(line + length, sizeof(line) - static_cast<std::size_t>(length), " --------");
+        }
+    }
+
+    std::cout << line << (entry.faulted ? "  fault " : "        ");
+
+    bool first{true};
+    for(std::uint32_t i{}; i < entry.size && i < 4; ++i)
+    {
+        if(entry.registers[i] == AR_TRACE_REGISTER_NONE)
+        {
+            continue;
+        }
+
+        std::snprintf(line, sizeof(line), "%s%s=0x%llx", first ? "" : ", ", register_name(entry.registers[i]).c_str(), static_cast<unsigned long long>(entry.values[i]));
+        std::cout << line;
+        first = false;
+    }
+
+    isaDisassembleBundle(entry.pc, entry.opcodes, entry.size < 4 ? entry.size : 4, line, sizeof(line));
+    std::cout << (first ? "" : "  ") << "; " << line << '\n';
+}
+
+void print_trace(const std::filesystem::path& path)
+{
+    std::ifstream ifs{path, std::ios_base::binary};
+    if(!ifs)
+    {
+        throw std::runtime_error{"Can not find file \"" + path.string() + "\"."};
+    }
+
+    ar::trace_file_header header{};
+    read_value(ifs, &header, 1, path);
+
+    if(header.magic != ar::trace_file_magic || header.version != ar::trace_file_version)
+    {
+        throw std::runtime_error{"File \"" + path.string() + "\" is not a trace of altair_vm."};
+    }
+
+    std::cout << "trace of " << header.core_count << (header.core_count == 1 ? " core" : " cores")
+              << (header.failed ? ", dumped when the run failed\n" : ", dumped on request\n");
+
+    for(std::uint32_t i{}; i < header.core_count; ++i)
+    {
+        ar::trace_core_header core{};
+        read_value(ifs, &core, 1, path);
+
+        std::vector<ArTraceEntry> entries{};
+        entries.resize(core.entry_count);
+        read_value(ifs, std::data(entries), std::size(entries), path);
+
+        std::cout << "core " << core.core << ": " << core.entry_count << " bundles, oldest first\n";
+        std::cout << "           cycle     pc  op-codes                              writes ; assembly\n";
+
+        for(auto&& entry : entries)
+        {
+            print_entry(entry);
+        }
+    }
+
+    std::cout << std::flush;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        std::cout.sync_with_stdio(false);
+
+        if(argc < 2)
+        {
+            throw std::runtime_error{"Usage: altair_vm_trace [path_to_trace]"};
+        }
+
+        print_trace(argv[1]);
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+
+        return 1;
+    }
+}